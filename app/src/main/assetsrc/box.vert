@@ -6,19 +6,19 @@ out float new_color;
 
 // Uniform buffer object
 uniform ubo {
-  mat4 trans_matrix;
+  mat4 trans_matrix[2];
   vec2 target;
-  vec2 offset[128];
+  vec2 selected_offset;
   int selected_index;
 };
 
 void main(void) {
 
   // Rotate the incoming vertex
-  vec4 new_coords = vec4(in_coords + offset[selected_index], -5.0, 1.0);
+  vec4 new_coords = vec4(in_coords + selected_offset, -5.0, 1.0);
 
   // Apply the offset and the transformation
-  new_coords = trans_matrix * new_coords;
+  new_coords = trans_matrix[VIEW_ID] * new_coords;
 
   // Set the output coordinates
   gl_Position = new_coords;
@@ -0,0 +1,20 @@
+#version 300 es
+
+uniform sampler2D texSampler;
+
+in vec2 new_texcoords;
+out vec4 out_color;
+
+void main() {
+
+  // The texture holds a distance field with the glyph edge at 0.5, so
+  // antialias across the distance covered by one screen pixel
+  float dist = texture(texSampler, new_texcoords).r;
+  float width = max(0.5f*fwidth(dist), 0.001f);
+  float coverage = smoothstep(0.5f - width, 0.5f + width, dist);
+  if(coverage < 0.1f)
+    out_color = vec4(1.0f, 1.0f, 1.0f, 0.0f);
+  else {
+    out_color = vec4(coverage, coverage, coverage, 1.0f);
+  }
+}
\ No newline at end of file
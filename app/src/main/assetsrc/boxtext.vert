@@ -0,0 +1,35 @@
+#version 300 es
+
+// Bottom-left and top-right corners of the glyph as (x, y, s, t)
+in vec4 in_lower;
+in vec4 in_upper;
+out vec2 new_texcoords;
+
+// Uniform buffer object
+uniform ubo {
+  mat4 trans_matrix[2];
+  vec2 target;
+  vec2 selected_offset;
+  int selected_index;
+};
+
+void main(void) {
+
+  // Pick the corner for this strip vertex: right, left, right, left
+  // along the bottom edge and then the top edge
+  bool right = (gl_VertexID & 1) == 0;
+  bool top = gl_VertexID >= 2;
+  vec4 vertex = mix(in_lower, in_upper, bvec4(right, top, right, top));
+
+  // Rotate the incoming vertex
+  vec4 new_coords = vec4(vertex.xy + selected_offset, -5.0, 1.0);
+
+  // Apply the offset and the transformation
+  new_coords = trans_matrix[VIEW_ID] * new_coords;
+
+  // Set the output coordinates
+  gl_Position = new_coords;
+
+  // Set texture coordinates
+  new_texcoords = vertex.zw;
+}
@@ -2,22 +2,23 @@
 
 in vec2 in_coords;
 in vec2 in_texcoords;
+in vec2 in_offset;
 out vec2 new_texcoords;
 out float selected;
 
 // Uniform buffer object
 uniform ubo {
-  mat4 trans_matrix;
+  mat4 trans_matrix[2];
   vec2 target;
-  vec2 offset[128];
+  vec2 selected_offset;
   int selected_index;
 };
 
 void main(void) {
 
   // Transform the incoming vertex
-  vec4 new_coords = vec4(in_coords + offset[gl_InstanceID], -5.0, 1.0);
-  new_coords = trans_matrix * new_coords;
+  vec4 new_coords = vec4(in_coords + in_offset, -5.0, 1.0);
+  new_coords = trans_matrix[VIEW_ID] * new_coords;
 
   // Set the output coordinates
   gl_Position = new_coords;
@@ -0,0 +1,39 @@
+#version 300 es
+
+// Pen position and code of one glyph
+in vec2 in_pen;
+in uint in_glyph;
+out vec2 new_texcoords;
+
+// Uniform buffer object
+uniform ubo {
+  mat4 trans_matrix[2];
+  vec2 target;
+  vec2 selected_offset;
+  int selected_index;
+};
+
+// Bottom-left and top-right corners of each glyph relative to the pen
+uniform glyphs {
+  vec4 glyph_corners[512];
+};
+
+void main(void) {
+
+  // Pick the corner for this strip vertex: right, left, right, left
+  // along the bottom edge and then the top edge
+  bool right = (gl_VertexID & 1) == 0;
+  bool top = gl_VertexID >= 2;
+  vec4 vertex = mix(glyph_corners[2u*in_glyph], glyph_corners[2u*in_glyph + 1u],
+    bvec4(right, top, right, top));
+
+  // Place the glyph at the pen and apply the transformation
+  vec4 new_coords = vec4(in_pen + vertex.xy, -5.0, 1.0);
+  new_coords = trans_matrix[VIEW_ID] * new_coords;
+
+  // Set the output coordinates
+  gl_Position = new_coords;
+
+  // Set texture coordinates
+  new_texcoords = vertex.zw;
+}
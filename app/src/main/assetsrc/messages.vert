@@ -6,9 +6,9 @@ out vec2 new_texcoords;
 
 // Uniform buffer object
 uniform ubo {
-  mat4 trans_matrix;
+  mat4 trans_matrix[2];
   vec2 target;
-  vec2 offset[128];
+  vec2 selected_offset;
   int selected_index;
 };
 
@@ -18,7 +18,7 @@ void main(void) {
   vec4 new_coords = vec4(in_coords, -5.0, 1.0);
 
   // Apply the offset and the transformation
-  new_coords = trans_matrix * new_coords;
+  new_coords = trans_matrix[VIEW_ID] * new_coords;
 
   // Set the output coordinates
   gl_Position = new_coords;
@@ -3,23 +3,20 @@ package com.quiller.wifidiscovery;
 import android.app.Activity;
 import android.content.Context;
 import android.content.res.AssetManager;
+import android.net.DhcpInfo;
 import android.net.wifi.WifiInfo;
 import android.net.wifi.WifiManager;
 import android.opengl.GLSurfaceView;
-import android.os.AsyncTask;
 import android.os.Bundle;
+import android.util.Log;
 import android.view.View;
 
 import com.google.vr.ndk.base.AndroidCompat;
 import com.google.vr.ndk.base.GvrLayout;
 
-import java.io.IOException;
-import java.net.Inet4Address;
-import java.net.InetAddress;
 import java.net.InterfaceAddress;
 import java.net.NetworkInterface;
 import java.net.SocketException;
-import java.net.UnknownHostException;
 import java.util.Enumeration;
 import java.util.Locale;
 
@@ -28,10 +25,11 @@ import javax.microedition.khronos.opengles.GL10;
 
 public class WiFiDiscoveryActivity extends Activity {
 
+  private static final String TAG = "WiFiDiscovery";
+
   private GvrLayout gvrLayout;
   private long nativeInst;
   private GLSurfaceView glSurfaceView;
-  private static float MAX_HOSTS = 128;
 
   public enum WIFI_STATE {
     NOT_CONNECTED(0), SCANNING(1);
@@ -82,7 +80,8 @@ public class WiFiDiscoveryActivity extends Activity {
     gvrLayout = new GvrLayout(this);
     nativeInst = createRenderer(
         gvrLayout.getGvrApi().getNativeGvrContext(), getAssets(),
-        getClass().getClassLoader(), this.getApplicationContext());  
+        getClass().getClassLoader(), this.getApplicationContext(),
+        getCodeCacheDir().getAbsolutePath(), getCacheDir().getAbsolutePath());
     
     // Configure the layout's view
     glSurfaceView = new GLSurfaceView(this);
@@ -133,91 +132,44 @@ public class WiFiDiscoveryActivity extends Activity {
       nativeSetState(nativeInst, WIFI_STATE.SCANNING.getVal());
 
       // Determine the IP address string
-      String address = String.format(Locale.US, "%d.%d.%d.%d", (ip & 0xff),
-        (ip >> 8 & 0xff), (ip >> 16 & 0xff), (ip >> 24 & 0xff));
+      String address = formatAddress(ip);
 
-      NetworkScanner scanner = new NetworkScanner();
-      scanner.execute(address);
-    }
-  }
+      // Host names are looked up on the DNS server handed out by DHCP,
+      // falling back to the gateway
+      DhcpInfo dhcp = mgr.getDhcpInfo();
+      int dns = (dhcp == null) ? 0 : (dhcp.dns1 != 0) ? dhcp.dns1 : dhcp.gateway;
+      String dnsServer = (dns == 0) ? null : formatAddress(dns);
 
-  class NetworkScanner extends AsyncTask<String, Void, Void> {
-
-    StringBuilder sb;
-    protected void onPreExecute() {
-      sb = new StringBuilder(200);
+      startScan(address, info.getSSID(), info.getBSSID(), dnsServer);
     }
+  }
 
-    protected Void doInBackground(String... params) {
-
-      try {
-        int numHosts = 0;
-        for (Enumeration<NetworkInterface> en = NetworkInterface.getNetworkInterfaces(); en.hasMoreElements(); ) {
-          NetworkInterface intf = en.nextElement();
-          for (InterfaceAddress address : intf.getInterfaceAddresses()) {
-            String ipAddr = address.getAddress().toString().substring(1);
-
-            // Find the WiFi address
-            if(ipAddr.equals(params[0])) {
-
-              // Convert the second, third, fourth octets into a number
-              int addrNum = 0;
-              String octets[] = ipAddr.split("\\.");
-              for(int i=1; i<4; i++) {
-                addrNum += Integer.parseInt(octets[i]) << (8*(3-i));
-              }
-
-              // Find the network prefix and mask the IP address
-              int netPrefix = address.getNetworkPrefixLength();
-              int mask = 1 << (32 - netPrefix);
-              int base = addrNum & (Integer.MAX_VALUE ^ (mask-1));
-              int progressInterval = mask/64;
-              int progressCounter = progressInterval;
-
-              // Iterate through IP addresses
-              try {
-                for (int i=0; i<mask; i++) {
-
-                  // Create IP address from number
-                  String addrString = String.format(Locale.US, "%s.%d.%d.%d", octets[0],
-                    ((base + i) >> 16 & 0xff), ((base + i) >> 8 & 0xff), ((base + i) & 0xff));
-                  InetAddress addr = Inet4Address.getByName(addrString);
-
-                  // Progress update
-                  if(i == progressCounter) {
-                    publishProgress();
-                    progressCounter += progressInterval;
-                  }
+  // Format an address as WifiManager reports it, lowest byte first
+  private static String formatAddress(int ip) {
+    return String.format(Locale.US, "%d.%d.%d.%d", (ip & 0xff),
+      (ip >> 8 & 0xff), (ip >> 16 & 0xff), (ip >> 24 & 0xff));
+  }
 
-                  if(addr.isReachable(50) && (numHosts < MAX_HOSTS)) {
-                    sb.append(addr.getHostName()).append(":").append(addr.getHostAddress());
-                    nativeAddHost(nativeInst, sb.toString());
-                    sb.setLength(0);
-                    numHosts++;
-                  }
-                }
-              } catch(UnknownHostException uhe) {
-              } catch(IOException ie) {}
-            }
+  // Find the prefix length of the WiFi interface and start the native sweep.
+  // Without it there's no subnet to sweep, so report no connection.
+  private void startScan(String address, String ssid, String bssid, String dnsServer) {
+    try {
+      for (Enumeration<NetworkInterface> en = NetworkInterface.getNetworkInterfaces(); en.hasMoreElements(); ) {
+        NetworkInterface intf = en.nextElement();
+        for (InterfaceAddress intfAddress : intf.getInterfaceAddresses()) {
+          if(intfAddress.getAddress().getHostAddress().equals(address)) {
+            nativeStartScan(nativeInst, address, intfAddress.getNetworkPrefixLength(),
+              ssid, bssid, dnsServer);
+            return;
           }
         }
       }
-      catch(SocketException se) {
-        sb.append(se.getMessage());
-      }
-      return null;
-    }
-
-    @Override
-    protected void onProgressUpdate(Void... progress) {
-      nativeProgressUpdate(nativeInst);
     }
-
-    protected void onPostExecute(Void result) {
-
-      // Alert native code that scan has finished
-      nativeSetScanComplete(nativeInst);
+    catch(SocketException se) {
+      Log.e(TAG, "Can't list network interfaces", se);
     }
+    Log.w(TAG, "No interface has address " + address);
+    nativeSetState(nativeInst, WIFI_STATE.NOT_CONNECTED.getVal());
   }
 
   @Override
@@ -266,14 +218,14 @@ public class WiFiDiscoveryActivity extends Activity {
   
   // Native methods
   private native long createRenderer(long gvrContext, AssetManager manager,
-    ClassLoader loader, Context context);
+    ClassLoader loader, Context context, String cacheDir, String hostCacheDir);
   private native void nativeOnSurfaceCreated(long nativeInst);
-  private native void nativeProgressUpdate(long nativeInst);
-  private native void nativeAddHost(long nativeInst, String result);
-  private native void nativeSetScanComplete(long nativeInst);  
+  private native void nativeStartScan(long nativeInst, String address, int prefixLength,
+    String ssid, String bssid, String dnsServer);
   private native void nativeSetState(long nativeInst, int state);
   private native void nativeOnDrawFrame(long nativeInst);
   private native void nativeOnPause(long nativeInst);
   private native void nativeOnResume(long nativeInst);
   private native void nativeOnDestroy(long nativeInst);
+  private native String nativeGetFrameStats(long nativeInst);
 }
@@ -0,0 +1,72 @@
+#include "assetbuffer.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+AssetBuffer::AssetBuffer():
+#ifdef __ANDROID__
+  asset(NULL),
+#endif
+  mapping(NULL),
+  data(NULL),
+  size(0) {}
+
+AssetBuffer::~AssetBuffer() {
+  Close();
+}
+
+#ifdef __ANDROID__
+bool AssetBuffer::Open(AAssetManager* mgr, const char* fileName) {
+  Close();
+  asset = AAssetManager_open(mgr, fileName, AASSET_MODE_BUFFER);
+  if(!asset) {
+    return false;
+  }
+  data = (const char*)AAsset_getBuffer(asset);
+  if(!data) {
+    Close();
+    return false;
+  }
+  size = (size_t)AAsset_getLength64(asset);
+  return true;
+}
+#endif
+
+bool AssetBuffer::Open(const char* path) {
+  Close();
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if(fd < 0) {
+    return false;
+  }
+
+  // The mapping outlives the descriptor
+  struct stat st;
+  if(fstat(fd, &st) == 0 && st.st_size > 0) {
+    mapping = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if(mapping == MAP_FAILED) {
+      mapping = NULL;
+    } else {
+      data = (const char*)mapping;
+      size = st.st_size;
+    }
+  }
+  close(fd);
+  return mapping != NULL;
+}
+
+void AssetBuffer::Close() {
+#ifdef __ANDROID__
+  if(asset) {
+    AAsset_close(asset);
+    asset = NULL;
+  }
+#endif
+  if(mapping) {
+    munmap(mapping, size);
+    mapping = NULL;
+  }
+  data = NULL;
+  size = 0;
+}
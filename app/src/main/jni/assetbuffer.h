@@ -0,0 +1,45 @@
+#ifndef ASSET_BUFFER_H_
+#define ASSET_BUFFER_H_
+
+#include <cstddef>
+
+#ifdef __ANDROID__
+#include <android/asset_manager.h>
+#endif
+
+// Read-only view of an asset's contents, valid until Close or destruction.
+// On device the bytes come from AAsset_getBuffer, which maps uncompressed
+// assets straight from the APK. Files on disk, such as the asset directory
+// in a host build, are mapped with mmap.
+class AssetBuffer {
+
+  public:
+    AssetBuffer();
+    ~AssetBuffer();
+
+#ifdef __ANDROID__
+    // Open an asset from the APK
+    bool Open(AAssetManager* mgr, const char* fileName);
+#endif
+
+    // Map a file from the filesystem
+    bool Open(const char* path);
+
+    void Close();
+
+    const char* Data() const { return data; }
+    size_t Size() const { return size; }
+
+  private:
+    AssetBuffer(const AssetBuffer&);
+    AssetBuffer& operator=(const AssetBuffer&);
+
+#ifdef __ANDROID__
+    AAsset* asset;
+#endif
+    void* mapping;
+    const char* data;
+    size_t size;
+};
+
+#endif  // ASSET_BUFFER_H_
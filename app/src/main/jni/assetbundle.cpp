@@ -0,0 +1,61 @@
+#include "assetbundle.h"
+
+#include <cstring>
+
+AssetBundle::AssetBundle(): entries(NULL), numEntries(0) {}
+
+#ifdef __ANDROID__
+bool AssetBundle::Open(AAssetManager* mgr, const char* fileName) {
+  Close();
+  return buffer.Open(mgr, fileName) && ReadContents();
+}
+#endif
+
+bool AssetBundle::Open(const char* path) {
+  Close();
+  return buffer.Open(path) && ReadContents();
+}
+
+void AssetBundle::Close() {
+  buffer.Close();
+  entries = NULL;
+  numEntries = 0;
+}
+
+bool AssetBundle::ReadContents() {
+
+  // Check the header and that the table fits
+  const BundleHeader* header = (const BundleHeader*)buffer.Data();
+  size_t size = buffer.Size();
+  if(size < sizeof(BundleHeader) || header->magic != BUNDLE_MAGIC ||
+     header->version != BUNDLE_VERSION ||
+     header->numEntries > (size - sizeof(BundleHeader))/sizeof(BundleEntry)) {
+    Close();
+    return false;
+  }
+
+  // Check every entry so lookups can trust the table
+  const BundleEntry* table = (const BundleEntry*)(header + 1);
+  for(uint32_t i=0; i<header->numEntries; ++i) {
+    if(table[i].offset > size || table[i].size > size - table[i].offset ||
+       !memchr(table[i].name, '\0', BUNDLE_NAME_LENGTH)) {
+      Close();
+      return false;
+    }
+  }
+  entries = table;
+  numEntries = header->numEntries;
+  return true;
+}
+
+AssetSlice AssetBundle::Find(const char* name) const {
+  AssetSlice slice = {NULL, 0};
+  for(uint32_t i=0; i<numEntries; ++i) {
+    if(strcmp(entries[i].name, name) == 0) {
+      slice.data = buffer.Data() + entries[i].offset;
+      slice.size = entries[i].size;
+      break;
+    }
+  }
+  return slice;
+}
@@ -0,0 +1,58 @@
+#ifndef ASSET_BUNDLE_H_
+#define ASSET_BUNDLE_H_
+
+#include <cstdint>
+
+#include "assetbuffer.h"
+
+// Bundle layout, shared with tools/assetpack. A header is followed by the
+// table of contents, then each file's data at an aligned offset from the
+// start of the bundle.
+#define BUNDLE_MAGIC 0x42415744
+#define BUNDLE_VERSION 1
+#define BUNDLE_ALIGNMENT 16
+#define BUNDLE_NAME_LENGTH 56
+
+typedef struct {
+  uint32_t magic, version, numEntries, reserved;
+} BundleHeader;
+
+typedef struct {
+  char name[BUNDLE_NAME_LENGTH];
+  uint32_t offset, size;
+} BundleEntry;
+
+// Slice of the bundle holding one file. Data is NULL if it wasn't found.
+typedef struct {
+  const char* data;
+  size_t size;
+} AssetSlice;
+
+// Maps a packed bundle once and hands out slices of it. Slices are valid
+// until the bundle is closed.
+class AssetBundle {
+
+  public:
+    AssetBundle();
+
+#ifdef __ANDROID__
+    // Open a bundle stored uncompressed in the APK
+    bool Open(AAssetManager* mgr, const char* fileName);
+#endif
+
+    // Open a bundle from the filesystem
+    bool Open(const char* path);
+
+    void Close();
+
+    AssetSlice Find(const char* name) const;
+
+  private:
+    bool ReadContents();
+
+    AssetBuffer buffer;
+    const BundleEntry* entries;
+    uint32_t numEntries;
+};
+
+#endif  // ASSET_BUNDLE_H_
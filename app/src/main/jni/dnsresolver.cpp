@@ -0,0 +1,355 @@
+#include "dnsresolver.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Each attempt waits twice as long as the one before: 1 s, 2 s, then 4 s
+// before giving up
+static const unsigned int RETRY_TIMEOUT_MS = 1000;
+static const uint8_t MAX_ATTEMPTS = 3;
+
+// Cache lifetimes in seconds. Hosts without a name are asked about again
+// after NEGATIVE_TTL, and after FAILED_TTL if the server gave no answer.
+static const uint32_t MIN_TTL = 60;
+static const uint32_t MAX_TTL = 24*60*60;
+static const uint32_t NEGATIVE_TTL = 5*60;
+static const uint32_t FAILED_TTL = 60;
+
+static const size_t HEADER_SIZE = 12;
+static const uint16_t TYPE_PTR = 12;
+static const uint16_t CLASS_IN = 1;
+static const unsigned int MAX_NAME_LENGTH = 255;
+static const unsigned int MAX_POINTERS = 32;
+
+static uint16_t Read16(const unsigned char* p) {
+  return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static uint32_t Read32(const unsigned char* p) {
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+// Read a possibly compressed name at offset, leaving offset after it.
+// The name is only stored if one is given.
+static bool ReadName(const unsigned char* packet, size_t size, size_t* offset,
+  std::string* name) {
+
+  size_t pos = *offset;
+  bool jumped = false;
+  unsigned int pointers = 0;
+  if(name) {
+    name->clear();
+  }
+  while(true) {
+    if(pos >= size) {
+      return false;
+    }
+    unsigned int len = packet[pos];
+
+    // Follow a pointer to the rest of the name
+    if((len & 0xC0) == 0xC0) {
+      if(pos + 1 >= size || ++pointers > MAX_POINTERS) {
+        return false;
+      }
+      if(!jumped) {
+        *offset = pos + 2;
+        jumped = true;
+      }
+      pos = ((len & 0x3F) << 8) | packet[pos + 1];
+      continue;
+    }
+    if(len & 0xC0) {
+      return false;
+    }
+    if(len == 0) {
+      if(!jumped) {
+        *offset = pos + 1;
+      }
+      return true;
+    }
+    if(pos + 1 + len > size) {
+      return false;
+    }
+    if(name) {
+      if(name->length() + len + 1 > MAX_NAME_LENGTH) {
+        return false;
+      }
+      if(!name->empty()) {
+        name->push_back('.');
+      }
+      name->append((const char*)packet + pos + 1, len);
+    }
+    pos += 1 + len;
+  }
+}
+
+DnsResolver::DnsResolver():
+  fd(-1),
+  random(std::random_device()()) {
+
+  for(unsigned int i=MAX_DNS_QUERIES; i>0; --i) {
+    queries[i-1].active = false;
+    freeQueries.push_back(i-1);
+  }
+}
+
+DnsResolver::~DnsResolver() {
+  Close();
+}
+
+bool DnsResolver::Open(uint32_t server, unsigned short port) {
+  Close();
+  fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if(fd < 0) {
+    return false;
+  }
+
+  // Connecting filters out datagrams from anywhere but the server
+  struct sockaddr_in sa = {};
+  sa.sin_family = AF_INET;
+  sa.sin_port = htons(port);
+  sa.sin_addr.s_addr = htonl(server);
+  if(connect(fd, (struct sockaddr*)&sa, sizeof(sa)) != 0) {
+    Close();
+    return false;
+  }
+  return true;
+}
+
+void DnsResolver::Close() {
+  if(fd >= 0) {
+    close(fd);
+    fd = -1;
+  }
+}
+
+bool DnsResolver::Cached(uint32_t address, uint64_t now, std::string* name) const {
+  std::unordered_map<uint32_t, CacheEntry>::const_iterator it = cache.find(address);
+  if(it == cache.end() || it->second.expiry <= now) {
+    return false;
+  }
+  *name = it->second.name;
+  return true;
+}
+
+void DnsResolver::Lookup(uint32_t address) {
+  if(fd >= 0 && pending.insert(address).second) {
+    waiting.push_back(address);
+  }
+}
+
+int DnsResolver::Timeout(uint64_t now) const {
+  uint64_t deadline = ~0ULL;
+  for(unsigned int i=0; i<MAX_DNS_QUERIES; ++i) {
+    if(queries[i].active) {
+      deadline = std::min(deadline, queries[i].deadline);
+    }
+  }
+  if(deadline == ~0ULL) {
+    return -1;
+  }
+  return (deadline > now) ? (int)(deadline - now) : 0;
+}
+
+void DnsResolver::Process(uint64_t now, const NameFunc& nameFunc) {
+
+  if(fd < 0) {
+    return;
+  }
+
+  // Read every answer that has arrived, a batch at a time
+  struct mmsghdr msgs[MAX_DNS_QUERIES];
+  struct iovec iovs[MAX_DNS_QUERIES];
+  int received;
+  do {
+    for(unsigned int i=0; i<MAX_DNS_QUERIES; ++i) {
+      iovs[i].iov_base = answerPackets[i];
+      iovs[i].iov_len = DNS_PACKET_SIZE;
+      memset(&msgs[i], 0, sizeof(msgs[i]));
+      msgs[i].msg_hdr.msg_iov = &iovs[i];
+      msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    received = recvmmsg(fd, msgs, MAX_DNS_QUERIES, MSG_DONTWAIT, NULL);
+    for(int i=0; i<received; ++i) {
+
+      // The low bits of the ID pick the query slot
+      if(msgs[i].msg_len < HEADER_SIZE) {
+        continue;
+      }
+      unsigned int slot = Read16(answerPackets[i]) & (MAX_DNS_QUERIES - 1);
+      std::string name;
+      uint32_t ttl;
+      if(queries[slot].active &&
+         ParseAnswer(answerPackets[i], msgs[i].msg_len, slot, &name, &ttl)) {
+        Finish(slot, name, ttl, now, nameFunc);
+      }
+    }
+  } while(received == MAX_DNS_QUERIES);
+
+  // Resend queries that timed out, waiting longer each time, and give up
+  // on those out of attempts
+  sendQueries.clear();
+  for(unsigned int slot=0; slot<MAX_DNS_QUERIES; ++slot) {
+    Query& query = queries[slot];
+    if(!query.active || query.deadline > now) {
+      continue;
+    }
+    if(query.attempts == MAX_ATTEMPTS) {
+      Finish(slot, std::string(), FAILED_TTL, now, nameFunc);
+      continue;
+    }
+    query.deadline = now + (RETRY_TIMEOUT_MS << query.attempts);
+    ++query.attempts;
+    sendQueries.push_back(slot);
+  }
+
+  // Start queued queries in the free slots. The name is the address's
+  // octets in reverse under in-addr.arpa.
+  while(!waiting.empty() && !freeQueries.empty()) {
+    unsigned int slot = freeQueries.back();
+    freeQueries.pop_back();
+    Query& query = queries[slot];
+    query.address = waiting.front();
+    waiting.pop_front();
+    query.id = (uint16_t)((random() & ~(MAX_DNS_QUERIES - 1)) | slot);
+    query.attempts = 1;
+    query.deadline = now + RETRY_TIMEOUT_MS;
+    query.active = true;
+
+    unsigned char* p = queryPackets[slot];
+    memset(p, 0, HEADER_SIZE);
+    p[0] = query.id >> 8;
+    p[1] = query.id & 0xFF;
+    p[2] = 0x01;                      // Recursion desired
+    p[5] = 1;                         // One question
+    char label[4];
+    size_t pos = HEADER_SIZE;
+    for(int i=0; i<4; ++i) {
+      int len = snprintf(label, sizeof(label), "%u", (query.address >> (8*i)) & 0xFF);
+      p[pos++] = (unsigned char)len;
+      memcpy(p + pos, label, len);
+      pos += len;
+    }
+    static const unsigned char ARPA[] = {7, 'i','n','-','a','d','d','r', 4, 'a','r','p','a', 0};
+    memcpy(p + pos, ARPA, sizeof(ARPA));
+    pos += sizeof(ARPA);
+    p[pos++] = 0;
+    p[pos++] = TYPE_PTR;
+    p[pos++] = 0;
+    p[pos++] = CLASS_IN;
+    query.length = (uint8_t)pos;
+    sendQueries.push_back(slot);
+  }
+
+  // Send the batch in one call
+  if(sendQueries.empty()) {
+    return;
+  }
+  for(unsigned int i=0; i<sendQueries.size(); ++i) {
+    unsigned int slot = sendQueries[i];
+    iovs[i].iov_base = queryPackets[slot];
+    iovs[i].iov_len = queries[slot].length;
+    memset(&msgs[i], 0, sizeof(msgs[i]));
+    msgs[i].msg_hdr.msg_iov = &iovs[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+  int sent = 0;
+  while(sent < (int)sendQueries.size()) {
+    int n = sendmmsg(fd, msgs + sent, sendQueries.size() - sent, 0);
+    if(n <= 0) {
+
+      // Lost packets are sent again when their queries time out
+      if(n < 0 && errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+    sent += n;
+  }
+}
+
+bool DnsResolver::ParseAnswer(const unsigned char* packet, size_t size, unsigned int slot,
+  std::string* name, uint32_t* ttl) const {
+
+  // Only accept a response with this query's ID and question
+  const Query& query = queries[slot];
+  if(size < query.length || Read16(packet) != query.id || !(packet[2] & 0x80) ||
+     Read16(packet + 4) != 1 ||
+     memcmp(packet + HEADER_SIZE, queryPackets[slot] + HEADER_SIZE,
+       query.length - HEADER_SIZE) != 0) {
+    return false;
+  }
+  name->clear();
+
+  // Truncated answers and server errors are treated as no answer
+  unsigned int rcode = packet[3] & 0x0F;
+  if((packet[2] & 0x02) || (rcode != 0 && rcode != 3)) {
+    *ttl = FAILED_TTL;
+    return true;
+  }
+  *ttl = NEGATIVE_TTL;
+  if(rcode == 3) {
+    return true;
+  }
+
+  // Take the first PTR record among the answers
+  unsigned int numAnswers = Read16(packet + 6);
+  size_t offset = query.length;
+  for(unsigned int i=0; i<numAnswers; ++i) {
+    if(!ReadName(packet, size, &offset, NULL) || offset + 10 > size) {
+      return true;
+    }
+    uint16_t type = Read16(packet + offset);
+    uint16_t rclass = Read16(packet + offset + 2);
+    uint32_t recordTtl = Read32(packet + offset + 4);
+    size_t dataLength = Read16(packet + offset + 8);
+    offset += 10;
+    if(offset + dataLength > size) {
+      return true;
+    }
+    if(type == TYPE_PTR && rclass == CLASS_IN) {
+      size_t dataOffset = offset;
+      if(ReadName(packet, size, &dataOffset, name) && !name->empty()) {
+        *ttl = std::min(std::max(recordTtl, MIN_TTL), MAX_TTL);
+      } else {
+        name->clear();
+      }
+      return true;
+    }
+    offset += dataLength;
+  }
+  return true;
+}
+
+void DnsResolver::Finish(unsigned int slot, const std::string& name, uint32_t ttl,
+  uint64_t now, const NameFunc& nameFunc) {
+
+  Query& query = queries[slot];
+  query.active = false;
+  freeQueries.push_back(slot);
+  pending.erase(query.address);
+
+  // Make room by dropping expired answers. If too few have expired, drop
+  // others as well, so the next sweep is an eighth of the cache away.
+  if(cache.size() >= MAX_CACHED_NAMES && cache.find(query.address) == cache.end()) {
+    for(std::unordered_map<uint32_t, CacheEntry>::iterator it = cache.begin();
+        it != cache.end();) {
+      it = (it->second.expiry <= now) ? cache.erase(it) : std::next(it);
+    }
+    while(cache.size() > MAX_CACHED_NAMES - MAX_CACHED_NAMES/8) {
+      cache.erase(cache.begin());
+    }
+  }
+  CacheEntry& entry = cache[query.address];
+  entry.name = name;
+  entry.expiry = now + 1000ULL*ttl;
+  nameFunc(query.address, name);
+}
@@ -0,0 +1,91 @@
+#ifndef DNS_RESOLVER_H_
+#define DNS_RESOLVER_H_
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#define MAX_DNS_QUERIES 32
+#define DNS_QUERY_SIZE 64
+#define DNS_PACKET_SIZE 512
+#define MAX_CACHED_NAMES 16384
+
+// Non-blocking reverse lookups against one DNS server. PTR queries go out
+// in batches over a single UDP socket, at most MAX_DNS_QUERIES at a time.
+// An unanswered query is sent again after 1 s and then after 2 s more, and
+// given up on 4 s after the last send. Answers, including the lack of a
+// name, are cached for their TTL, up to MAX_CACHED_NAMES addresses.
+// Addresses are in host byte order.
+class DnsResolver {
+
+  public:
+    // Called with the host's name, or an empty string if it has none
+    typedef std::function<void(uint32_t, const std::string&)> NameFunc;
+
+    DnsResolver();
+    ~DnsResolver();
+
+    bool Open(uint32_t server, unsigned short port = 53);
+    void Close();
+
+    // Descriptor to poll for answers
+    int Fd() const { return fd; }
+
+    // Name cached for the address, false if there's none or it has expired
+    bool Cached(uint32_t address, uint64_t now, std::string* name) const;
+
+    // Queue a query unless one for the address is already queued or in flight
+    void Lookup(uint32_t address);
+
+    // Read answers, retry or give up on queries that timed out and send
+    // queued ones, reporting each finished lookup
+    void Process(uint64_t now, const NameFunc& nameFunc);
+
+    // Milliseconds until the next query times out, or -1 if none is in flight
+    int Timeout(uint64_t now) const;
+
+    // True once every queued lookup has finished
+    bool Idle() const { return pending.empty(); }
+
+  private:
+    DnsResolver(const DnsResolver&);
+    DnsResolver& operator=(const DnsResolver&);
+
+    typedef struct {
+      uint32_t address;
+      uint64_t deadline;
+      uint16_t id;
+      uint8_t attempts, length;
+      bool active;
+    } Query;
+
+    typedef struct {
+      std::string name;
+      uint64_t expiry;
+    } CacheEntry;
+
+    // Parse an answer to a query, returning false if it should be ignored
+    bool ParseAnswer(const unsigned char* packet, size_t size, unsigned int slot,
+      std::string* name, uint32_t* ttl) const;
+    void Finish(unsigned int slot, const std::string& name, uint32_t ttl, uint64_t now,
+      const NameFunc& nameFunc);
+
+    int fd;
+    std::mt19937 random;
+    Query queries[MAX_DNS_QUERIES];
+    std::vector<unsigned int> freeQueries, sendQueries;
+    std::deque<uint32_t> waiting;
+    std::unordered_set<uint32_t> pending;
+    std::unordered_map<uint32_t, CacheEntry> cache;
+
+    // Each query slot keeps its packet for retries and answer checks
+    unsigned char queryPackets[MAX_DNS_QUERIES][DNS_QUERY_SIZE];
+    unsigned char answerPackets[MAX_DNS_QUERIES][DNS_PACKET_SIZE];
+};
+
+#endif  // DNS_RESOLVER_H_
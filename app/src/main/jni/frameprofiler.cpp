@@ -0,0 +1,117 @@
+#include "frameprofiler.h"
+
+#include <algorithm>
+#include <cstdio>
+
+static const char* PHASE_NAMES[NUM_PROFILE_PHASES] = {
+  "frame", "setup", "controller", "selection", "uniforms", "upload",
+  "multiview", "acquire", "blit", "left eye", "right eye", "submit"};
+static const char* COUNTER_NAMES[NUM_PROFILE_COUNTERS] = {
+  "stream bytes", "hosts uploaded"};
+
+// Durations below this many microseconds get a bucket each
+static const uint32_t EXACT_LIMIT = 8;
+
+PhaseHistogram::PhaseHistogram() {
+  Reset();
+}
+
+unsigned int PhaseHistogram::Bucket(uint32_t micros) {
+  if(micros < EXACT_LIMIT) {
+    return micros;
+  }
+
+  // Power of two above EXACT_LIMIT, then the quarter within it
+  unsigned int exponent = 31 - __builtin_clz(micros);
+  unsigned int quarter = (micros >> (exponent - 2)) & 3;
+  unsigned int bucket = EXACT_LIMIT + 4*(exponent - 3) + quarter;
+  return bucket < NUM_PROFILE_BUCKETS ? bucket : NUM_PROFILE_BUCKETS - 1;
+}
+
+uint32_t PhaseHistogram::BucketLimit(unsigned int bucket) {
+  if(bucket < EXACT_LIMIT) {
+    return bucket;
+  }
+  unsigned int exponent = 3 + (bucket - EXACT_LIMIT)/4;
+  unsigned int quarter = (bucket - EXACT_LIMIT) % 4;
+  return ((5 + quarter) << (exponent - 2)) - 1;
+}
+
+void PhaseHistogram::Record(uint32_t micros) {
+  counts[Bucket(micros)].fetch_add(1, std::memory_order_relaxed);
+  uint32_t max = maxMicros.load(std::memory_order_relaxed);
+  while(micros > max &&
+        !maxMicros.compare_exchange_weak(max, micros, std::memory_order_relaxed)) {}
+}
+
+void PhaseHistogram::Reset() {
+  for(unsigned int i=0; i<NUM_PROFILE_BUCKETS; ++i) {
+    counts[i].store(0, std::memory_order_relaxed);
+  }
+  maxMicros.store(0, std::memory_order_relaxed);
+}
+
+uint32_t PhaseHistogram::Count() const {
+  uint32_t count = 0;
+  for(unsigned int i=0; i<NUM_PROFILE_BUCKETS; ++i) {
+    count += counts[i].load(std::memory_order_relaxed);
+  }
+  return count;
+}
+
+uint32_t PhaseHistogram::Percentile(float fraction) const {
+
+  // Read the buckets once so the rank and the walk agree
+  uint32_t snapshot[NUM_PROFILE_BUCKETS], count = 0;
+  for(unsigned int i=0; i<NUM_PROFILE_BUCKETS; ++i) {
+    snapshot[i] = counts[i].load(std::memory_order_relaxed);
+    count += snapshot[i];
+  }
+  if(count == 0) {
+    return 0;
+  }
+
+  // Report the top of the bucket holding the sample at this rank. The
+  // last bucket is open-ended.
+  uint32_t rank = (uint32_t)(fraction * (count - 1)) + 1, seen = 0;
+  for(unsigned int i=0; i<NUM_PROFILE_BUCKETS - 1; ++i) {
+    seen += snapshot[i];
+    if(seen >= rank) {
+      return std::min(BucketLimit(i), Max());
+    }
+  }
+  return Max();
+}
+
+void FrameProfiler::Reset() {
+  for(unsigned int i=0; i<NUM_PROFILE_PHASES; ++i) {
+    phases[i].Reset();
+  }
+  for(unsigned int i=0; i<NUM_PROFILE_COUNTERS; ++i) {
+    counters[i].Reset();
+  }
+}
+
+// Append a histogram's summary, skipping empty ones
+static void ReportLine(std::string& report, const char* name,
+  const PhaseHistogram& histogram, const char* unit) {
+  if(histogram.Count() == 0) {
+    return;
+  }
+  char line[160];
+  snprintf(line, sizeof(line), "%-14s n=%u p50=%u%s p95=%u%s p99=%u%s max=%u%s\n",
+    name, histogram.Count(), histogram.Percentile(0.5f), unit, histogram.Percentile(0.95f),
+    unit, histogram.Percentile(0.99f), unit, histogram.Max(), unit);
+  report += line;
+}
+
+std::string FrameProfiler::Report() const {
+  std::string report;
+  for(unsigned int i=0; i<NUM_PROFILE_PHASES; ++i) {
+    ReportLine(report, PHASE_NAMES[i], phases[i], "us");
+  }
+  for(unsigned int i=0; i<NUM_PROFILE_COUNTERS; ++i) {
+    ReportLine(report, COUNTER_NAMES[i], counters[i], "");
+  }
+  return report;
+}
@@ -0,0 +1,123 @@
+#ifndef FRAME_PROFILER_H_
+#define FRAME_PROFILER_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Phases of OnDrawFrame. PHASE_FRAME covers the whole call and the rest
+// are measured one after another inside it.
+enum ProfilePhase {
+  PHASE_FRAME = 0,
+  PHASE_SETUP,
+  PHASE_CONTROLLER,
+  PHASE_SELECTION,
+  PHASE_UNIFORMS,
+  PHASE_UPLOAD,
+  PHASE_MULTIVIEW,
+  PHASE_ACQUIRE,
+  PHASE_BLIT,
+  PHASE_LEFT_EYE,
+  PHASE_RIGHT_EYE,
+  PHASE_SUBMIT,
+  NUM_PROFILE_PHASES
+};
+
+// Amounts recorded per frame. Uploaded hosts are only counted on frames
+// that upload some.
+enum ProfileCounter {
+  COUNTER_STREAM_BYTES = 0,
+  COUNTER_HOSTS_UPLOADED,
+  NUM_PROFILE_COUNTERS
+};
+
+// Eight exact buckets for the smallest values, then four per power of two
+// up to about two million
+#define NUM_PROFILE_BUCKETS 80
+
+// Histogram of per-frame values, such as phase durations in microseconds.
+// The render thread records while any thread reads, using only relaxed
+// atomics, so neither side blocks. Percentiles are accurate to within a
+// quarter of their value.
+class PhaseHistogram {
+
+  public:
+    PhaseHistogram();
+
+    void Record(uint32_t micros);
+    void Reset();
+
+    // Samples recorded, and the duration below which the given fraction
+    // of them fall
+    uint32_t Count() const;
+    uint32_t Percentile(float fraction) const;
+    uint32_t Max() const { return maxMicros.load(std::memory_order_relaxed); }
+
+  private:
+    static unsigned int Bucket(uint32_t micros);
+    static uint32_t BucketLimit(unsigned int bucket);
+
+    std::atomic<uint32_t> counts[NUM_PROFILE_BUCKETS];
+    std::atomic<uint32_t> maxMicros;
+};
+
+class FrameProfiler {
+
+  public:
+    void Record(ProfilePhase phase, uint32_t micros) { phases[phase].Record(micros); }
+    void Count(ProfileCounter counter, uint32_t value) { counters[counter].Record(value); }
+    void Reset();
+
+    // One line per phase and counter with its count, p50, p95, p99 and max
+    std::string Report() const;
+
+  private:
+    PhaseHistogram phases[NUM_PROFILE_PHASES];
+    PhaseHistogram counters[NUM_PROFILE_COUNTERS];
+};
+
+// Times from construction to destruction. Next ends the current phase and
+// starts another, so consecutive phases share one scope.
+class ScopedPhaseTimer {
+
+  public:
+    ScopedPhaseTimer(FrameProfiler& frameProfiler, ProfilePhase firstPhase):
+      profiler(frameProfiler),
+      phase(firstPhase),
+      start(std::chrono::steady_clock::now()) {}
+
+    ~ScopedPhaseTimer() {
+      Next(phase);
+    }
+
+    void Next(ProfilePhase nextPhase) {
+      std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+      profiler.Record(phase, (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        now - start).count());
+      phase = nextPhase;
+      start = now;
+    }
+
+  private:
+    ScopedPhaseTimer(const ScopedPhaseTimer&);
+    ScopedPhaseTimer& operator=(const ScopedPhaseTimer&);
+
+    FrameProfiler& profiler;
+    ProfilePhase phase;
+    std::chrono::steady_clock::time_point start;
+};
+
+// Timers compile to nothing unless FRAME_PROFILING is defined, which the
+// build does for debug builds
+#ifdef FRAME_PROFILING
+#define PROFILE_SCOPE(timer, profiler, phase) ScopedPhaseTimer timer(profiler, phase)
+#define PROFILE_NEXT(timer, phase) timer.Next(phase)
+#define PROFILE_COUNT(profiler, counter, value) profiler.Count(counter, value)
+#else
+#define PROFILE_SCOPE(timer, profiler, phase)
+#define PROFILE_NEXT(timer, phase)
+#define PROFILE_COUNT(profiler, counter, value)
+#endif
+
+#endif  // FRAME_PROFILER_H_
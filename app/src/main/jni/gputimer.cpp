@@ -0,0 +1,140 @@
+#include "gputimer.h"
+
+#include <EGL/egl.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+static const char* PASS_NAMES[NUM_GPU_PASSES] = {
+  "messages", "spinner", "hosts", "labels", "box", "pointer"};
+static const char* VIEW_NAMES[NUM_GPU_VIEWS] = {"left", "right", "both"};
+
+GpuTimer::GpuTimer():
+  supported(false),
+  glGetQueryObjectui64vEXT(NULL),
+  frameSlot(0),
+  currentView(VIEW_LEFT),
+  currentPass(-1) {
+
+  memset(issued, 0, sizeof(issued));
+  memset(numSamples, 0, sizeof(numSamples));
+  memset(windowSum, 0, sizeof(windowSum));
+  for(unsigned int v=0; v<NUM_GPU_VIEWS; ++v) {
+    for(unsigned int p=0; p<NUM_GPU_PASSES; ++p) {
+      averageNanos[v][p].store(0, std::memory_order_relaxed);
+      maxNanos[v][p].store(0, std::memory_order_relaxed);
+      sampleCount[v][p].store(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+bool GpuTimer::Init(const char* extensions) {
+
+  Destroy();
+  glGetQueryObjectui64vEXT = (PFNGLGETQUERYOBJECTUI64VEXTPROC)
+    eglGetProcAddress("glGetQueryObjectui64vEXT");
+  supported = extensions && strstr(extensions, "GL_EXT_disjoint_timer_query") &&
+    glGetQueryObjectui64vEXT;
+  if(supported) {
+    glGenQueries(sizeof(queries)/sizeof(GLuint), &queries[0][0][0]);
+
+    // Clear the disjoint flag so the first results aren't thrown away
+    GLint disjoint;
+    glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+  }
+  return supported;
+}
+
+void GpuTimer::Destroy() {
+  if(supported) {
+    glDeleteQueries(sizeof(queries)/sizeof(GLuint), &queries[0][0][0]);
+    memset(issued, 0, sizeof(issued));
+    supported = false;
+  }
+}
+
+void GpuTimer::BeginFrame() {
+
+  if(!supported) {
+    return;
+  }
+  frameSlot = (frameSlot + 1) % GPU_TIMER_LATENCY;
+
+  // Results that span a disjoint event, such as a frequency change, are
+  // meaningless, so drop the whole set
+  GLint disjoint = 0;
+  glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+
+  // Read back the set issued GPU_TIMER_LATENCY frames ago. A result that
+  // still isn't available is dropped rather than waited for.
+  for(unsigned int v=0; v<NUM_GPU_VIEWS; ++v) {
+    for(unsigned int p=0; p<NUM_GPU_PASSES; ++p) {
+      if(!issued[frameSlot][v][p]) {
+        continue;
+      }
+      issued[frameSlot][v][p] = false;
+      GLuint available = GL_FALSE;
+      glGetQueryObjectuiv(queries[frameSlot][v][p], GL_QUERY_RESULT_AVAILABLE_EXT, &available);
+      if(available && !disjoint) {
+        GLuint64 nanos = 0;
+        glGetQueryObjectui64vEXT(queries[frameSlot][v][p], GL_QUERY_RESULT_EXT, &nanos);
+        AddSample(v, p, (uint32_t)std::min(nanos, (GLuint64)UINT32_MAX));
+      }
+    }
+  }
+}
+
+void GpuTimer::Begin(GpuPass pass) {
+  if(supported) {
+    glBeginQuery(GL_TIME_ELAPSED_EXT, queries[frameSlot][currentView][pass]);
+    issued[frameSlot][currentView][pass] = true;
+    currentPass = pass;
+  }
+}
+
+void GpuTimer::End() {
+  if(supported && currentPass != -1) {
+    glEndQuery(GL_TIME_ELAPSED_EXT);
+    currentPass = -1;
+  }
+}
+
+void GpuTimer::AddSample(unsigned int view, unsigned int pass, uint32_t nanos) {
+
+  // Replace the oldest sample once the window is full
+  uint32_t* window = samples[view][pass];
+  unsigned int count = numSamples[view][pass]++;
+  unsigned int filled = std::min(count + 1, (unsigned int)GPU_TIMER_WINDOW);
+  if(count >= GPU_TIMER_WINDOW) {
+    windowSum[view][pass] -= window[count % GPU_TIMER_WINDOW];
+  }
+  window[count % GPU_TIMER_WINDOW] = nanos;
+  windowSum[view][pass] += nanos;
+
+  // Publish the window's summary
+  uint32_t max = *std::max_element(window, window + filled);
+  averageNanos[view][pass].store((uint32_t)(windowSum[view][pass]/filled),
+    std::memory_order_relaxed);
+  maxNanos[view][pass].store(max, std::memory_order_relaxed);
+  sampleCount[view][pass].store(filled, std::memory_order_relaxed);
+}
+
+std::string GpuTimer::Report() const {
+  std::string report;
+  char line[128];
+  for(unsigned int v=0; v<NUM_GPU_VIEWS; ++v) {
+    for(unsigned int p=0; p<NUM_GPU_PASSES; ++p) {
+      uint32_t count = sampleCount[v][p].load(std::memory_order_relaxed);
+      if(count == 0) {
+        continue;
+      }
+      snprintf(line, sizeof(line), "gpu %-5s %-8s n=%u avg=%.1fus max=%.1fus\n",
+        VIEW_NAMES[v], PASS_NAMES[p], count,
+        averageNanos[v][p].load(std::memory_order_relaxed)/1000.0f,
+        maxNanos[v][p].load(std::memory_order_relaxed)/1000.0f);
+      report += line;
+    }
+  }
+  return report;
+}
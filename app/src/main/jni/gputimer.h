@@ -0,0 +1,92 @@
+#ifndef GPU_TIMER_H_
+#define GPU_TIMER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include <GLES3/gl3.h>
+#include <GLES2/gl2ext.h>
+
+// Draw groups timed on the GPU
+enum GpuPass {
+  PASS_MESSAGES = 0,
+  PASS_SPINNER,
+  PASS_HOSTS,
+  PASS_LABELS,
+  PASS_BOX,
+  PASS_POINTER,
+  NUM_GPU_PASSES
+};
+
+// Passes are timed separately for each eye, or once for both with multiview
+enum GpuView {
+  VIEW_LEFT = 0,
+  VIEW_RIGHT,
+  VIEW_BOTH,
+  NUM_GPU_VIEWS
+};
+
+// Frames between issuing a query and reading it back, so reading never
+// waits on the GPU
+#define GPU_TIMER_LATENCY 4
+
+// Samples in each pass's rolling window
+#define GPU_TIMER_WINDOW 120
+
+// Times draw groups with GL_EXT_disjoint_timer_query. Each frame uses its
+// own set of queries, and BeginFrame collects the set issued
+// GPU_TIMER_LATENCY frames earlier. Summaries are published through
+// atomics so Report can run on any thread.
+class GpuTimer {
+
+  public:
+    GpuTimer();
+
+    // Create the queries if the driver supports timing. Returns whether
+    // it does; the other calls do nothing if not.
+    bool Init(const char* extensions);
+    void Destroy();
+
+    // Collect finished results and start this frame's queries
+    void BeginFrame();
+
+    void SetView(GpuView view) { currentView = view; }
+    void Begin(GpuPass pass);
+    void End();
+
+    // One line per timed pass with its average and maximum
+    std::string Report() const;
+
+  private:
+    void AddSample(unsigned int view, unsigned int pass, uint32_t nanos);
+
+    bool supported;
+    PFNGLGETQUERYOBJECTUI64VEXTPROC glGetQueryObjectui64vEXT;
+    GLuint queries[GPU_TIMER_LATENCY][NUM_GPU_VIEWS][NUM_GPU_PASSES];
+    bool issued[GPU_TIMER_LATENCY][NUM_GPU_VIEWS][NUM_GPU_PASSES];
+    unsigned int frameSlot;
+    GpuView currentView;
+    int currentPass;
+
+    // Rolling window, owned by the render thread
+    uint32_t samples[NUM_GPU_VIEWS][NUM_GPU_PASSES][GPU_TIMER_WINDOW];
+    unsigned int numSamples[NUM_GPU_VIEWS][NUM_GPU_PASSES];
+    uint64_t windowSum[NUM_GPU_VIEWS][NUM_GPU_PASSES];
+
+    // Published summaries in nanoseconds
+    std::atomic<uint32_t> averageNanos[NUM_GPU_VIEWS][NUM_GPU_PASSES];
+    std::atomic<uint32_t> maxNanos[NUM_GPU_VIEWS][NUM_GPU_PASSES];
+    std::atomic<uint32_t> sampleCount[NUM_GPU_VIEWS][NUM_GPU_PASSES];
+};
+
+// Pass timers compile to nothing unless FRAME_PROFILING is defined
+#ifdef FRAME_PROFILING
+#define GPU_PASS_BEGIN(timer, pass) timer.Begin(pass)
+#define GPU_PASS_END(timer) timer.End()
+#else
+#define GPU_PASS_BEGIN(timer, pass)
+#define GPU_PASS_END(timer)
+#endif
+
+#endif  // GPU_TIMER_H_
@@ -0,0 +1,81 @@
+#include "hostcache.h"
+
+#include <algorithm>
+#include <cstdio>
+
+HostCache::HostCache(): entries(NULL), names(NULL), numHosts(0) {}
+
+bool HostCache::Open(const std::string& path, uint64_t networkHash) {
+
+  Close();
+  if(!file.Open(path.c_str())) {
+    return false;
+  }
+
+  // Check the header, then that the entries and names fit
+  const HostCacheHeader* header = (const HostCacheHeader*)file.Data();
+  size_t size = file.Size();
+  if(size < sizeof(HostCacheHeader) || header->magic != HOST_CACHE_MAGIC ||
+     header->version != HOST_CACHE_VERSION || header->networkHash != networkHash ||
+     header->numHosts > (size - sizeof(HostCacheHeader))/sizeof(HostCacheEntry) ||
+     header->nameBytes > size - sizeof(HostCacheHeader) -
+       header->numHosts*sizeof(HostCacheEntry)) {
+    Close();
+    return false;
+  }
+  const HostCacheEntry* table = (const HostCacheEntry*)(header + 1);
+  for(uint32_t i=0; i<header->numHosts; ++i) {
+    if(table[i].nameOffset > header->nameBytes ||
+       table[i].nameLength > header->nameBytes - table[i].nameOffset) {
+      Close();
+      return false;
+    }
+  }
+  entries = table;
+  names = (const char*)(table + header->numHosts);
+  numHosts = header->numHosts;
+  return true;
+}
+
+void HostCache::Close() {
+  file.Close();
+  entries = NULL;
+  names = NULL;
+  numHosts = 0;
+}
+
+bool HostCache::Save(const std::string& path, uint64_t networkHash,
+  std::vector<CachedHost>& hosts) {
+
+  // Sort by address and lay out the names
+  std::sort(hosts.begin(), hosts.end(),
+    [](const CachedHost& a, const CachedHost& b) { return a.address < b.address; });
+  HostCacheHeader header = {HOST_CACHE_MAGIC, HOST_CACHE_VERSION,
+    (uint32_t)hosts.size(), 0, networkHash};
+  std::vector<HostCacheEntry> table(hosts.size());
+  for(size_t i=0; i<hosts.size(); ++i) {
+    table[i].address = hosts[i].address;
+    table[i].nameOffset = header.nameBytes;
+    table[i].nameLength = hosts[i].name.length();
+    header.nameBytes += hosts[i].name.length();
+  }
+
+  // Write to a temporary file so a partial write is never loaded
+  std::string tempPath = path + ".tmp";
+  FILE* out = fopen(tempPath.c_str(), "wb");
+  if(!out) {
+    return false;
+  }
+  bool written = fwrite(&header, sizeof(header), 1, out) == 1 &&
+    fwrite(table.data(), sizeof(HostCacheEntry), table.size(), out) == table.size();
+  for(size_t i=0; i<hosts.size() && written; ++i) {
+    written = fwrite(hosts[i].name.data(), 1, hosts[i].name.length(), out) ==
+      hosts[i].name.length();
+  }
+  written = (fclose(out) == 0) && written;
+  if(!written || rename(tempPath.c_str(), path.c_str()) != 0) {
+    remove(tempPath.c_str());
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,58 @@
+#ifndef HOST_CACHE_H_
+#define HOST_CACHE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "assetbuffer.h"
+
+// File layout: a header, one entry per host sorted by address, then the
+// host names packed back to back. Everything is read in place from the
+// mapped file.
+#define HOST_CACHE_MAGIC 0x43485744
+#define HOST_CACHE_VERSION 1
+
+typedef struct {
+  uint32_t magic, version, numHosts, nameBytes;
+  uint64_t networkHash;
+} HostCacheHeader;
+
+typedef struct {
+  uint32_t address, nameOffset, nameLength;
+} HostCacheEntry;
+
+typedef struct {
+  uint32_t address;
+  std::string name;
+} CachedHost;
+
+// Hosts found by the last scan of a network, so the next launch can show
+// them before the new scan finds anything
+class HostCache {
+
+  public:
+    HostCache();
+
+    // Map a cache written for the network with this hash
+    bool Open(const std::string& path, uint64_t networkHash);
+    void Close();
+
+    unsigned int Size() const { return numHosts; }
+    uint32_t Address(unsigned int index) const { return entries[index].address; }
+    std::string Name(unsigned int index) const {
+      return std::string(names + entries[index].nameOffset, entries[index].nameLength);
+    }
+
+    // Replace the cache file with these hosts
+    static bool Save(const std::string& path, uint64_t networkHash,
+      std::vector<CachedHost>& hosts);
+
+  private:
+    AssetBuffer file;
+    const HostCacheEntry* entries;
+    const char* names;
+    unsigned int numHosts;
+};
+
+#endif  // HOST_CACHE_H_
@@ -0,0 +1,207 @@
+#include "hostpicker.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+static const float INF = std::numeric_limits<float>::infinity();
+static const int KEY_BITS = 21;
+static const int KEY_BIAS = 1 << (KEY_BITS - 1);
+
+HostPicker::HostPicker(float size):
+  cellSize(size),
+  invCellSize(1.0f/size) {
+  Clear();
+}
+
+void HostPicker::Clear() {
+  boxes.clear();
+  cells.clear();
+  for(int i=0; i<3; ++i) {
+    sceneMin[i] = INF;
+    sceneMax[i] = -INF;
+    cellMin[i] = 0;
+    cellMax[i] = -1;
+  }
+}
+
+uint64_t HostPicker::CellKey(const int* cell) {
+  uint64_t key = 0;
+  for(int i=0; i<3; ++i) {
+    key = (key << KEY_BITS) | (uint64_t)((cell[i] + KEY_BIAS) & ((1 << KEY_BITS) - 1));
+  }
+  return key;
+}
+
+void HostPicker::CellOf(const float* point, int* cell) const {
+  for(int i=0; i<3; ++i) {
+    cell[i] = (int)std::floor(point[i] * invCellSize);
+  }
+}
+
+void HostPicker::Set(unsigned int index, const float* boxMin, const float* boxMax) {
+
+  if(index < boxes.size()) {
+    Remove(index);
+  } else {
+    Box empty = {{INF, INF, INF}, {-INF, -INF, -INF}};
+    boxes.resize(index + 1, empty);
+  }
+  Box& box = boxes[index];
+  std::copy(boxMin, boxMin + 3, box.min);
+  std::copy(boxMax, boxMax + 3, box.max);
+
+  // Grow the scene bounds
+  for(int i=0; i<3; ++i) {
+    sceneMin[i] = std::min(sceneMin[i], boxMin[i]);
+    sceneMax[i] = std::max(sceneMax[i], boxMax[i]);
+  }
+  CellOf(sceneMin, cellMin);
+  CellOf(sceneMax, cellMax);
+  Bucket(index, true);
+}
+
+void HostPicker::Remove(unsigned int index) {
+
+  // An inverted box is never hit. The scene bounds don't shrink.
+  if(index >= boxes.size() || boxes[index].min[0] > boxes[index].max[0]) {
+    return;
+  }
+  Bucket(index, false);
+  Box& box = boxes[index];
+  std::fill(box.min, box.min + 3, INF);
+  std::fill(box.max, box.max + 3, -INF);
+}
+
+void HostPicker::Bucket(unsigned int index, bool insert) {
+
+  // Add the box to or drop it from every cell it overlaps
+  int lo[3], hi[3], cell[3];
+  CellOf(boxes[index].min, lo);
+  CellOf(boxes[index].max, hi);
+  for(cell[0]=lo[0]; cell[0]<=hi[0]; ++cell[0]) {
+    for(cell[1]=lo[1]; cell[1]<=hi[1]; ++cell[1]) {
+      for(cell[2]=lo[2]; cell[2]<=hi[2]; ++cell[2]) {
+        uint64_t key = CellKey(cell);
+        if(insert) {
+          cells[key].push_back(index);
+          continue;
+        }
+        std::unordered_map<uint64_t, std::vector<unsigned int>>::iterator it = cells.find(key);
+        if(it == cells.end()) {
+          continue;
+        }
+        it->second.erase(std::remove(it->second.begin(), it->second.end(), index),
+          it->second.end());
+        if(it->second.empty()) {
+          cells.erase(it);
+        }
+      }
+    }
+  }
+}
+
+// Slab test, clipped to [tMin, tMax]. Zero-thickness boxes still count.
+bool HostPicker::HitBox(const Box& box, const float* origin, const float* invDir,
+  float tMin, float tMax, float* t) const {
+
+  for(int i=0; i<3; ++i) {
+    if(invDir[i] == INF || invDir[i] == -INF) {
+      if(origin[i] < box.min[i] || origin[i] > box.max[i]) {
+        return false;
+      }
+      continue;
+    }
+    float t0 = (box.min[i] - origin[i]) * invDir[i];
+    float t1 = (box.max[i] - origin[i]) * invDir[i];
+    if(t0 > t1) {
+      std::swap(t0, t1);
+    }
+    tMin = std::max(tMin, t0);
+    tMax = std::min(tMax, t1);
+    if(tMin > tMax) {
+      return false;
+    }
+  }
+  *t = tMin;
+  return true;
+}
+
+int HostPicker::Pick(const float* origin, const float* direction) const {
+
+  if(boxes.empty()) {
+    return -1;
+  }
+
+  // Clip the ray to the scene bounds
+  float invDir[3];
+  for(int i=0; i<3; ++i) {
+    invDir[i] = 1.0f/direction[i];
+  }
+  Box scene;
+  std::copy(sceneMin, sceneMin + 3, scene.min);
+  std::copy(sceneMax, sceneMax + 3, scene.max);
+  float tEnter, tExit = INF;
+  if(!HitBox(scene, origin, invDir, 0.0f, INF, &tEnter)) {
+    return -1;
+  }
+  for(int i=0; i<3; ++i) {
+    if(invDir[i] != INF && invDir[i] != -INF) {
+      tExit = std::min(tExit, std::max((scene.min[i] - origin[i]) * invDir[i],
+                                       (scene.max[i] - origin[i]) * invDir[i]));
+    }
+  }
+
+  // Start in the entry cell. Clamping keeps rounding at the entry point
+  // from landing just outside a flat scene.
+  int cell[3], step[3];
+  float tNext[3], tDelta[3];
+  for(int i=0; i<3; ++i) {
+    float entry = origin[i] + direction[i]*tEnter;
+    cell[i] = std::min(std::max((int)std::floor(entry * invCellSize), cellMin[i]), cellMax[i]);
+    if(direction[i] > 0.0f) {
+      step[i] = 1;
+      tNext[i] = ((cell[i] + 1)*cellSize - origin[i]) * invDir[i];
+      tDelta[i] = cellSize * invDir[i];
+    } else if(direction[i] < 0.0f) {
+      step[i] = -1;
+      tNext[i] = (cell[i]*cellSize - origin[i]) * invDir[i];
+      tDelta[i] = -cellSize * invDir[i];
+    } else {
+      step[i] = 0;
+      tNext[i] = INF;
+      tDelta[i] = INF;
+    }
+  }
+
+  // Walk the cells along the ray. A hit is final once it's no further
+  // than the point where the ray leaves the current cell.
+  int best = -1;
+  float bestT = INF, t;
+  while(true) {
+    std::unordered_map<uint64_t, std::vector<unsigned int>>::const_iterator it =
+      cells.find(CellKey(cell));
+    if(it != cells.end()) {
+      for(unsigned int index : it->second) {
+        if(HitBox(boxes[index], origin, invDir, 0.0f, bestT, &t) &&
+           (t < bestT || (t == bestT && (int)index < best))) {
+          best = index;
+          bestT = t;
+        }
+      }
+    }
+
+    // Advance along the axis whose cell boundary comes first
+    int axis = (tNext[0] < tNext[1]) ? (tNext[0] < tNext[2] ? 0 : 2)
+                                     : (tNext[1] < tNext[2] ? 1 : 2);
+    if(bestT <= tNext[axis] || tNext[axis] > tExit) {
+      break;
+    }
+    cell[axis] += step[axis];
+    if(cell[axis] < cellMin[axis] || cell[axis] > cellMax[axis]) {
+      break;
+    }
+    tNext[axis] += tDelta[axis];
+  }
+  return best;
+}
@@ -0,0 +1,53 @@
+#ifndef HOST_PICKER_H_
+#define HOST_PICKER_H_
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Finds the host box hit first by a ray. Boxes are bucketed into a sparse
+// uniform grid as they're set, and a pick only tests the boxes in the
+// cells the ray crosses inside the scene bounds. The boxes are axis-aligned
+// but can sit anywhere in space, so the picker doesn't depend on the hosts
+// forming a flat wall.
+class HostPicker {
+
+  public:
+    // Cells should be about the size of the spacing between hosts
+    explicit HostPicker(float cellSize);
+
+    void Clear();
+
+    // Set the box for a host index, replacing any box it had
+    void Set(unsigned int index, const float* boxMin, const float* boxMax);
+
+    // Take out a host's box so picks pass through its place
+    void Remove(unsigned int index);
+
+    // Index of the nearest box hit by the ray, or -1 if there is none
+    int Pick(const float* origin, const float* direction) const;
+
+    unsigned int Size() const { return boxes.size(); }
+
+  private:
+    typedef struct {
+      float min[3], max[3];
+    } Box;
+
+    // Grid coordinates are packed into one key, 21 bits per axis
+    static uint64_t CellKey(const int* cell);
+    void CellOf(const float* point, int* cell) const;
+    void Bucket(unsigned int index, bool insert);
+    bool HitBox(const Box& box, const float* origin, const float* invDir,
+      float tMin, float tMax, float* t) const;
+
+    float cellSize, invCellSize;
+    std::vector<Box> boxes;
+    std::unordered_map<uint64_t, std::vector<unsigned int>> cells;
+
+    // Bounds of every box, in world and grid coordinates
+    float sceneMin[3], sceneMax[3];
+    int cellMin[3], cellMax[3];
+};
+
+#endif  // HOST_PICKER_H_
@@ -1,5 +1,44 @@
 #include "matrixutils.h"
 
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Row i of a product is the rows of the right-hand matrix weighted by row
+// i of the left. The products are summed in the same order as the scalar
+// loop, without fused multiply-adds, so every path gives the same result.
+#if defined(__ARM_NEON)
+static inline void MultiplyRows(const gvr::Mat4f& matA, const gvr::Mat4f& matB,
+  float32x4_t* rows) {
+  float32x4_t b0 = vld1q_f32(matB.m[0]);
+  float32x4_t b1 = vld1q_f32(matB.m[1]);
+  float32x4_t b2 = vld1q_f32(matB.m[2]);
+  float32x4_t b3 = vld1q_f32(matB.m[3]);
+  for(int i = 0; i < 4; ++i) {
+    float32x4_t row = vmulq_n_f32(b0, matA.m[i][0]);
+    row = vaddq_f32(row, vmulq_n_f32(b1, matA.m[i][1]));
+    row = vaddq_f32(row, vmulq_n_f32(b2, matA.m[i][2]));
+    rows[i] = vaddq_f32(row, vmulq_n_f32(b3, matA.m[i][3]));
+  }
+}
+#elif defined(__SSE2__)
+static inline void MultiplyRows(const gvr::Mat4f& matA, const gvr::Mat4f& matB,
+  __m128* rows) {
+  __m128 b0 = _mm_loadu_ps(matB.m[0]);
+  __m128 b1 = _mm_loadu_ps(matB.m[1]);
+  __m128 b2 = _mm_loadu_ps(matB.m[2]);
+  __m128 b3 = _mm_loadu_ps(matB.m[3]);
+  for(int i = 0; i < 4; ++i) {
+    __m128 row = _mm_mul_ps(b0, _mm_set1_ps(matA.m[i][0]));
+    row = _mm_add_ps(row, _mm_mul_ps(b1, _mm_set1_ps(matA.m[i][1])));
+    row = _mm_add_ps(row, _mm_mul_ps(b2, _mm_set1_ps(matA.m[i][2])));
+    rows[i] = _mm_add_ps(row, _mm_mul_ps(b3, _mm_set1_ps(matA.m[i][3])));
+  }
+}
+#endif
+
 gvr::Mat4f MatrixUtils::RotateM(float angle, float u, float v, float w) {
   
   gvr::Mat4f rotMatrix;
@@ -46,14 +85,57 @@ gvr::Mat4f MatrixUtils::MultiplyMM(const gvr::Mat4f& matA, const gvr::Mat4f& mat
   gvr::Mat4f product;
   
   // Compute matrix product
+#if defined(__ARM_NEON)
+  float32x4_t rows[4];
+  MultiplyRows(matA, matB, rows);
+  for(int i = 0; i < 4; ++i) {
+    vst1q_f32(product.m[i], rows[i]);
+  }
+#elif defined(__SSE2__)
+  __m128 rows[4];
+  MultiplyRows(matA, matB, rows);
+  for(int i = 0; i < 4; ++i) {
+    _mm_storeu_ps(product.m[i], rows[i]);
+  }
+#else
   for(int i = 0; i < 4; ++i) {
     for(int j = 0; j < 4; ++j) {
-      product.m[i][j] = 0.0f;
-      for(int k = 0; k < 4; ++k) {
+      product.m[i][j] = matA.m[i][0] * matB.m[0][j];
+      for(int k = 1; k < 4; ++k) {
         product.m[i][j] += matA.m[i][k] * matB.m[k][j];
       }
     }
   }
+#endif
+  return product;
+}
+
+gvr::Mat4f MatrixUtils::MultiplyMMTranspose(const gvr::Mat4f& matA, const gvr::Mat4f& matB) {
+
+  gvr::Mat4f product;
+
+  // Transpose the product rows while they're still in registers
+#if defined(__ARM_NEON)
+  float32x4x4_t rows;
+  MultiplyRows(matA, matB, rows.val);
+  vst4q_f32(&product.m[0][0], rows);
+#elif defined(__SSE2__)
+  __m128 rows[4];
+  MultiplyRows(matA, matB, rows);
+  _MM_TRANSPOSE4_PS(rows[0], rows[1], rows[2], rows[3]);
+  for(int i = 0; i < 4; ++i) {
+    _mm_storeu_ps(product.m[i], rows[i]);
+  }
+#else
+  for(int i = 0; i < 4; ++i) {
+    for(int j = 0; j < 4; ++j) {
+      product.m[j][i] = matA.m[i][0] * matB.m[0][j];
+      for(int k = 1; k < 4; ++k) {
+        product.m[j][i] += matA.m[i][k] * matB.m[k][j];
+      }
+    }
+  }
+#endif
   return product;
 }
 
@@ -87,17 +169,5 @@ gvr::Mat4f MatrixUtils::Perspective(const gvr::Rectf& fov,
   matrix.m[3][2] = -1.0f;
   matrix.m[3][3] = 0.0f;
 
-  return matrix;
-}
-
-gvr::Mat4f MatrixUtils::Transpose(const gvr::Mat4f& mat) {
-
-  gvr::Mat4f matrix;
-
-  for (int i = 0; i < 4; ++i) {
-    for (int j = 0; j < 4; ++j) {
-      matrix.m[j][i] = mat.m[i][j];
-    }
-  }
   return matrix;
 }
\ No newline at end of file
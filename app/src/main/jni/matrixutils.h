@@ -13,12 +13,13 @@ class MatrixUtils {
   
     // Multiply two matrices
     static gvr::Mat4f MultiplyMM(const gvr::Mat4f& matA, const gvr::Mat4f& matB);
+
+    // Multiply two matrices and transpose the product into GL's
+    // column-major order in one pass
+    static gvr::Mat4f MultiplyMMTranspose(const gvr::Mat4f& matA, const gvr::Mat4f& matB);
     
     // Obtain perspective matrix
     static gvr::Mat4f Perspective(const gvr::Rectf& fov, float near, float far);
-    
-    // Perform matrix transpose
-    static gvr::Mat4f Transpose(const gvr::Mat4f& matrix);
 };
 
 #endif  // MATRIX_UTILS_H_
\ No newline at end of file
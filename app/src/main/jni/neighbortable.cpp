@@ -0,0 +1,217 @@
+#include "neighbortable.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <linux/neighbour.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <net/if_arp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static const char* ARP_PATH = "/proc/net/arp";
+static const size_t READ_SIZE = 64*1024;
+static const size_t NETLINK_BUFFER_SIZE = 32*1024;
+
+// Entries in these states have a link-layer address the kernel got from
+// the host itself, but only the reachable ones prove the host is still up
+static const uint16_t REACHABLE_STATES = NUD_REACHABLE | NUD_PERMANENT;
+static const uint16_t USABLE_STATES = REACHABLE_STATES | NUD_STALE | NUD_DELAY | NUD_PROBE;
+
+NeighborTable::NeighborTable(): fd(-1) {}
+
+NeighborTable::~NeighborTable() {
+  Close();
+}
+
+bool NeighborTable::Open() {
+  Close();
+  fd = socket(AF_NETLINK, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_ROUTE);
+  if(fd < 0) {
+    return false;
+  }
+
+  // Join the neighbor group before dumping so nothing learned in between
+  // is missed
+  struct sockaddr_nl local = {};
+  local.nl_family = AF_NETLINK;
+  local.nl_groups = RTMGRP_NEIGH;
+  if(bind(fd, (struct sockaddr*)&local, sizeof(local)) != 0) {
+    Close();
+    return false;
+  }
+
+  // Ask for both families; IPv6 entries are dropped by the parser
+  struct {
+    struct nlmsghdr header;
+    struct ndmsg msg;
+  } req = {};
+  req.header.nlmsg_len = NLMSG_LENGTH(sizeof(req.msg));
+  req.header.nlmsg_type = RTM_GETNEIGH;
+  req.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+  req.header.nlmsg_seq = 1;
+  req.msg.ndm_family = AF_UNSPEC;
+  struct sockaddr_nl kernel = {};
+  kernel.nl_family = AF_NETLINK;
+  if(sendto(fd, &req, req.header.nlmsg_len, 0, (struct sockaddr*)&kernel, sizeof(kernel)) < 0) {
+    Close();
+    return false;
+  }
+  buffer.resize(NETLINK_BUFFER_SIZE);
+  return true;
+}
+
+void NeighborTable::Close() {
+  if(fd >= 0) {
+    close(fd);
+    fd = -1;
+  }
+}
+
+void NeighborTable::Read(std::vector<Neighbor>& entries) {
+  if(fd < 0) {
+    return;
+  }
+
+  // An overrun only loses notifications, so keep reading after one
+  while(true) {
+    ssize_t n = recv(fd, buffer.data(), buffer.size(), 0);
+    if(n > 0) {
+      ParseMessages(buffer.data(), n, entries);
+    } else if(n < 0 && (errno == ENOBUFS || errno == EINTR)) {
+      continue;
+    } else {
+      break;
+    }
+  }
+}
+
+void NeighborTable::ParseMessages(const char* data, size_t size,
+  std::vector<Neighbor>& entries) {
+
+  int len = (int)size;
+  for(const struct nlmsghdr* header = (const struct nlmsghdr*)data;
+      NLMSG_OK(header, len); header = NLMSG_NEXT(header, len)) {
+    if(header->nlmsg_type != RTM_NEWNEIGH ||
+       header->nlmsg_len < NLMSG_LENGTH(sizeof(struct ndmsg))) {
+      continue;
+    }
+    const struct ndmsg* msg = (const struct ndmsg*)NLMSG_DATA(header);
+    if(msg->ndm_family != AF_INET || !(msg->ndm_state & USABLE_STATES)) {
+      continue;
+    }
+
+    // Find the destination address among the attributes
+    int attrLen = header->nlmsg_len - NLMSG_LENGTH(sizeof(struct ndmsg));
+    for(const struct rtattr* attr = (const struct rtattr*)((const char*)msg +
+          NLMSG_ALIGN(sizeof(struct ndmsg)));
+        RTA_OK(attr, attrLen); attr = RTA_NEXT(attr, attrLen)) {
+      if(attr->rta_type == NDA_DST && RTA_PAYLOAD(attr) == sizeof(uint32_t)) {
+        uint32_t address;
+        memcpy(&address, RTA_DATA(attr), sizeof(address));
+        entries.push_back(Neighbor{ntohl(address), (msg->ndm_state & REACHABLE_STATES) != 0});
+        break;
+      }
+    }
+  }
+}
+
+bool NeighborTable::ReadArp(std::vector<Neighbor>& entries) {
+
+  // Proc files report no size, so read until the end
+  int arpFd = open(ARP_PATH, O_RDONLY | O_CLOEXEC);
+  if(arpFd < 0) {
+    return false;
+  }
+  std::vector<char> text;
+  size_t used = 0;
+  ssize_t n;
+  do {
+    text.resize(used + READ_SIZE);
+    n = read(arpFd, &text[used], READ_SIZE);
+    if(n > 0) {
+      used += n;
+    }
+  } while(n > 0 || (n < 0 && errno == EINTR));
+  close(arpFd);
+  ParseArp(text.data(), used, entries);
+  return true;
+}
+
+// Parse a dotted quad, returning the end of it or NULL
+static const char* ParseQuad(const char* p, const char* end, uint32_t* address) {
+  uint32_t result = 0;
+  for(int i=0; i<4; ++i) {
+    if(i > 0) {
+      if(p == end || *p != '.') {
+        return NULL;
+      }
+      ++p;
+    }
+    unsigned int octet = 0, digits = 0;
+    while(p != end && *p >= '0' && *p <= '9' && digits < 3) {
+      octet = octet*10 + (*p++ - '0');
+      ++digits;
+    }
+    if(digits == 0 || octet > 255) {
+      return NULL;
+    }
+    result = (result << 8) | octet;
+  }
+  *address = result;
+  return p;
+}
+
+// Skip the spaces before a field, returning the start of the field
+static const char* SkipSpaces(const char* p, const char* end) {
+  while(p != end && (*p == ' ' || *p == '\t')) {
+    ++p;
+  }
+  return p;
+}
+
+void NeighborTable::ParseArp(const char* text, size_t size,
+  std::vector<Neighbor>& entries) {
+
+  // Lines after the header hold the address, hardware type, flags,
+  // hardware address, mask and device
+  const char* end = text + size;
+  const char* p = (const char*)memchr(text, '\n', size);
+  while(p != NULL && ++p < end) {
+    const char* eol = (const char*)memchr(p, '\n', end - p);
+    if(eol == NULL) {
+      eol = end;
+    }
+
+    // Skip the hardware type and read the hex flags
+    uint32_t address;
+    const char* field = ParseQuad(SkipSpaces(p, eol), eol, &address);
+    if(field != NULL) {
+      field = SkipSpaces(field, eol);
+      while(field != eol && *field != ' ' && *field != '\t') {
+        ++field;
+      }
+      field = SkipSpaces(field, eol);
+      unsigned int flags = 0;
+      if(eol - field > 2 && field[0] == '0' && (field[1] == 'x' || field[1] == 'X')) {
+        for(field += 2; field != eol; ++field) {
+          char c = *field;
+          unsigned int digit = (c >= '0' && c <= '9') ? c - '0' :
+                               (c >= 'a' && c <= 'f') ? c - 'a' + 10 :
+                               (c >= 'A' && c <= 'F') ? c - 'A' + 10 : 16;
+          if(digit == 16) {
+            break;
+          }
+          flags = (flags << 4) | digit;
+        }
+      }
+      if(flags & ATF_COM) {
+        entries.push_back(Neighbor{address, (flags & ATF_PERM) != 0});
+      }
+    }
+    p = (eol == end) ? NULL : eol;
+  }
+}
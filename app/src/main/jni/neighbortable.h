@@ -0,0 +1,54 @@
+#ifndef NEIGHBOR_TABLE_H_
+#define NEIGHBOR_TABLE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// A neighbor entry. Only reachable entries were confirmed by the host
+// recently; the rest are worth probing first, but may have gone away.
+typedef struct {
+  uint32_t address;
+  bool reachable;
+} Neighbor;
+
+// The kernel's IPv4 neighbor table, which already lists the hosts this
+// device has talked to recently. It's read from /proc/net/arp and from a
+// netlink dump, and the netlink socket then reports neighbors as the kernel
+// learns them. Addresses are in host byte order. Newer Android releases
+// deny apps one or both sources, which then just yield nothing.
+class NeighborTable {
+
+  public:
+    NeighborTable();
+    ~NeighborTable();
+
+    // Subscribe to neighbor changes and request a dump of the table
+    bool Open();
+    void Close();
+
+    // Descriptor to poll for dump replies and change notifications
+    int Fd() const { return fd; }
+
+    // Append the neighbors in pending netlink messages without blocking
+    void Read(std::vector<Neighbor>& entries);
+
+    // Append the neighbors listed in /proc/net/arp
+    static bool ReadArp(std::vector<Neighbor>& entries);
+
+    // Parsers for the two sources. Incomplete and failed entries are
+    // skipped, as are IPv6 neighbors, since hosts are keyed by IPv4 address.
+    // The ARP file doesn't tell reachable entries from stale ones, so only
+    // its permanent entries count as reachable.
+    static void ParseArp(const char* text, size_t size, std::vector<Neighbor>& entries);
+    static void ParseMessages(const char* data, size_t size, std::vector<Neighbor>& entries);
+
+  private:
+    NeighborTable(const NeighborTable&);
+    NeighborTable& operator=(const NeighborTable&);
+
+    int fd;
+    std::vector<char> buffer;
+};
+
+#endif  // NEIGHBOR_TABLE_H_
@@ -0,0 +1,566 @@
+#include "networkscanner.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/ip_icmp.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Ports used for TCP probes. A refused connection proves the host is up.
+static const unsigned short PROBE_PORTS[] = {80, 443, 22, 445, 139, 62078};
+static const unsigned int NUM_PORTS = sizeof(PROBE_PORTS)/sizeof(PROBE_PORTS[0]);
+
+static const unsigned int MAX_IN_FLIGHT = 2048;
+static const unsigned int RESERVED_FDS = 64;
+static const unsigned int PROBE_TIMEOUT_MS = 300;
+static const unsigned int MAX_EVENTS = 256;
+static const int MIN_PREFIX = 16;
+static const uint64_t ICMP_TAG = ~0ULL;
+static const uint64_t NEIGHBOR_TAG = ~0ULL - 1;
+static const uint64_t WAKE_TAG = ~0ULL - 2;
+
+// Monitor schedule. Known hosts are rechecked every round and dropped after
+// MISS_LIMIT silent rounds in a row; the rest of the subnet is swept a slice
+// per round, over a period that doubles while nothing changes.
+static const unsigned int RECHECK_INTERVAL_MS = 5000;
+static const uint64_t MIN_SWEEP_PERIOD_MS = 60000;
+static const uint64_t MAX_SWEEP_PERIOD_MS = 16*MIN_SWEEP_PERIOD_MS;
+static const uint8_t MISS_LIMIT = 3;
+
+static uint64_t NowMillis() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+NetworkScanner::NetworkScanner(HostFunc hostFn, AddressFunc lostFn,
+  EventFunc progressFn, EventFunc completeFn):
+  hostFunc(hostFn),
+  lostFunc(lostFn),
+  progressFunc(progressFn),
+  completeFunc(completeFn),
+  stopped(false),
+  paused(false),
+  base(0),
+  epollFd(-1),
+  icmpFd(-1),
+  churn(false),
+  queueFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+  wakeFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {}
+
+NetworkScanner::~NetworkScanner() {
+  Stop();
+  if(queueFd >= 0) {
+    close(queueFd);
+  }
+  if(wakeFd >= 0) {
+    close(wakeFd);
+  }
+}
+
+void NetworkScanner::Start(uint32_t address, int prefixLength, uint32_t dnsServer,
+  bool monitor) {
+  Stop();
+  stopped = false;
+  resolveQueue.clear();
+  eventfd_t count;
+  eventfd_read(queueFd, &count);
+  eventfd_read(wakeFd, &count);
+  resolveThread = std::thread(&NetworkScanner::Resolve, this, dnsServer, monitor);
+  sweepThread = std::thread(&NetworkScanner::Sweep, this, address, prefixLength, monitor);
+}
+
+void NetworkScanner::Stop() {
+  stopped = true;
+  eventfd_write(wakeFd, 1);
+  eventfd_write(queueFd, 1);
+  if(sweepThread.joinable()) {
+    sweepThread.join();
+  }
+  if(resolveThread.joinable()) {
+    resolveThread.join();
+  }
+}
+
+bool NetworkScanner::OpenProbe(int epollFd, uint32_t slot,
+  uint32_t index, unsigned short port) {
+
+  int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if(fd < 0) {
+    return false;
+  }
+
+  // Start a non-blocking connect
+  struct sockaddr_in sa = {};
+  sa.sin_family = AF_INET;
+  sa.sin_port = htons(port);
+  sa.sin_addr.s_addr = htonl(base + index);
+  if(connect(fd, (struct sockaddr*)&sa, sizeof(sa)) == 0 || errno == ECONNREFUSED) {
+    close(fd);
+    MarkAlive(index);
+    return false;
+  }
+  if(errno != EINPROGRESS) {
+    close(fd);
+    return false;
+  }
+
+  // Wait for the connection to complete or fail
+  struct epoll_event ev = {};
+  ev.events = EPOLLOUT;
+  ev.data.u64 = slot;
+  epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+  probes[slot].fd = fd;
+  probes[slot].index = index;
+  probes[slot].deadline = NowMillis() + PROBE_TIMEOUT_MS;
+  return true;
+}
+
+void NetworkScanner::CloseProbe(int epollFd, uint32_t slot, bool reset) {
+
+  // Abort established connections so they don't linger in TIME_WAIT
+  if(reset) {
+    struct linger lin = {1, 0};
+    setsockopt(probes[slot].fd, SOL_SOCKET, SO_LINGER, &lin, sizeof(lin));
+  }
+  epoll_ctl(epollFd, EPOLL_CTL_DEL, probes[slot].fd, NULL);
+  close(probes[slot].fd);
+  probes[slot].fd = -1;
+  freeSlots.push_back(slot);
+}
+
+void NetworkScanner::MarkAlive(uint32_t index) {
+  responded[index] = 1;
+  if(alive[index]) {
+    return;
+  }
+  alive[index] = 1;
+  misses[index] = 0;
+  churn = true;
+  PushUpdate(base + index, HOST_FOUND);
+}
+
+void NetworkScanner::PushUpdate(uint32_t address, UpdateKind kind) {
+  {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    resolveQueue.push_back(Update{address, kind});
+  }
+  eventfd_write(queueFd, 1);
+}
+
+void NetworkScanner::Sweep(uint32_t address, int prefixLength, bool monitor) {
+
+  // Determine the range of addresses
+  if(prefixLength < MIN_PREFIX) {
+    prefixLength = MIN_PREFIX;
+  }
+  uint32_t count = (prefixLength >= 32) ? 1 : (1u << (32 - prefixLength));
+  base = address & ~(count - 1);
+  uint32_t first = 0, last = count - 1;
+  if(count > 2) {
+    first = 1;
+    last = count - 2;
+  }
+  alive.assign(count, 0);
+  responded.assign(count, 0);
+  misses.assign(count, 0);
+
+  // Raise the descriptor limit and size the probe window to fit
+  struct rlimit lim;
+  unsigned int maxInFlight = MAX_IN_FLIGHT;
+  if(getrlimit(RLIMIT_NOFILE, &lim) == 0) {
+    lim.rlim_cur = lim.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &lim);
+    getrlimit(RLIMIT_NOFILE, &lim);
+    if(lim.rlim_cur < maxInFlight + RESERVED_FDS) {
+      maxInFlight = (lim.rlim_cur > 2*RESERVED_FDS) ?
+        (unsigned int)lim.rlim_cur - RESERVED_FDS : RESERVED_FDS;
+    }
+  }
+  probes.assign(maxInFlight, Probe{-1, 0, 0});
+  freeSlots.clear();
+  for(uint32_t i=maxInFlight; i>0; --i) {
+    freeSlots.push_back(i-1);
+  }
+
+  epollFd = epoll_create1(EPOLL_CLOEXEC);
+
+  // Use unprivileged ICMP echo where the kernel permits it
+  icmpFd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_ICMP);
+  if(icmpFd >= 0) {
+    struct epoll_event ev = {};
+    ev.events = EPOLLIN;
+    ev.data.u64 = ICMP_TAG;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, icmpFd, &ev);
+  }
+  if(wakeFd >= 0) {
+    struct epoll_event ev = {};
+    ev.events = EPOLLIN;
+    ev.data.u64 = WAKE_TAG;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev);
+  }
+
+  // Report the hosts the kernel already knows. The first part of a netlink
+  // dump is queued while the request is sent, so it can be read at once;
+  // the socket then stays subscribed to new neighbors.
+  seeds.clear();
+  NeighborTable::ReadArp(neighborEntries);
+  if(neighbors.Open()) {
+    struct epoll_event ev = {};
+    ev.events = EPOLLIN;
+    ev.data.u64 = NEIGHBOR_TAG;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, neighbors.Fd(), &ev);
+  }
+  ReadNeighbors();
+
+  // Probe the rest of the subnet once, starting with the neighbors that
+  // may still be up
+  std::vector<uint32_t> indices;
+  indices.reserve(last - first + 1);
+  std::vector<uint8_t> queued(count, 0);
+  for(uint32_t index : seeds) {
+    if(!alive[index] && !queued[index] && index >= first && index <= last) {
+      queued[index] = 1;
+      indices.push_back(index);
+    }
+  }
+  seeds.clear();
+  for(uint32_t i=first; i<=last; ++i) {
+    if(!alive[i] && !queued[i]) {
+      indices.push_back(i);
+    }
+  }
+  ProbeAddresses(indices, true);
+
+  // The resolver completes the scan once it has reported the hosts found
+  if(!stopped) {
+    PushUpdate(0, SWEEP_DONE);
+  }
+  if(monitor) {
+    Monitor(first, last);
+  }
+
+  neighbors.Close();
+  if(icmpFd >= 0) {
+    close(icmpFd);
+    icmpFd = -1;
+  }
+  close(epollFd);
+  epollFd = -1;
+}
+
+void NetworkScanner::Monitor(uint32_t first, uint32_t last) {
+
+  uint64_t sweepPeriod = MIN_SWEEP_PERIOD_MS;
+  uint32_t count = last - first + 1, cursor = first;
+  std::vector<uint32_t> known, batch;
+  struct epoll_event events[MAX_EVENTS];
+  churn = false;
+
+  while(true) {
+
+    // Wait for the next round, taking in new neighbors as they're reported
+    uint64_t now = NowMillis(), roundTime = now + RECHECK_INTERVAL_MS;
+    while(!stopped && now < roundTime) {
+      int n = epoll_wait(epollFd, events, MAX_EVENTS, (int)(roundTime - now));
+      for(int i=0; i<n; ++i) {
+        HandleSharedEvent(events[i].data.u64);
+      }
+      now = NowMillis();
+    }
+    if(stopped) {
+      break;
+    }
+    if(paused) {
+      continue;
+    }
+
+    // Recheck every known host and the neighbors reported since the last
+    // round, plus the next slice of the rest of the subnet
+    known.clear();
+    for(uint32_t i=first; i<=last; ++i) {
+      if(alive[i]) {
+        known.push_back(i);
+      }
+    }
+    batch = known;
+    std::sort(seeds.begin(), seeds.end());
+    seeds.erase(std::unique(seeds.begin(), seeds.end()), seeds.end());
+    for(uint32_t index : seeds) {
+      if(!alive[index] && index >= first && index <= last) {
+        batch.push_back(index);
+      }
+    }
+    seeds.clear();
+    uint64_t slice = std::max<uint64_t>(1, (uint64_t)count*RECHECK_INTERVAL_MS/sweepPeriod);
+    bool passDone = false;
+    for(uint64_t n=0; n<slice && !passDone; ++n) {
+      if(!alive[cursor]) {
+        batch.push_back(cursor);
+      }
+      if(cursor++ == last) {
+        cursor = first;
+        passDone = true;
+      }
+    }
+    ProbeAddresses(batch, false);
+    if(stopped) {
+      break;
+    }
+
+    // Drop hosts that have stayed silent for too many rounds
+    for(uint32_t index : known) {
+      if(responded[index]) {
+        misses[index] = 0;
+      } else if(++misses[index] == MISS_LIMIT) {
+        alive[index] = 0;
+        churn = true;
+        PushUpdate(base + index, HOST_LOST);
+      }
+    }
+
+    // At the end of each background pass, slow down if the network was
+    // quiet and have the resolver check the known hosts' names again
+    if(passDone) {
+      sweepPeriod = churn ? MIN_SWEEP_PERIOD_MS : std::min(2*sweepPeriod, MAX_SWEEP_PERIOD_MS);
+      churn = false;
+      for(uint32_t i=first; i<=last; ++i) {
+        if(alive[i]) {
+          PushUpdate(base + i, HOST_REFRESH);
+        }
+      }
+    }
+  }
+}
+
+void NetworkScanner::ProbeAddresses(const std::vector<uint32_t>& indices,
+  bool reportProgress) {
+
+  for(uint32_t index : indices) {
+    responded[index] = 0;
+  }
+
+  size_t next = 0;
+  unsigned int port = 0;
+  size_t progressInterval = (indices.size() + PROGRESS_STEPS)/PROGRESS_STEPS;
+  size_t progressCounter = progressInterval;
+  uint64_t icmpDeadline = 0, probeDeadline = 0;
+  struct epoll_event events[MAX_EVENTS];
+
+  while(!stopped) {
+
+    // Fill the probe window
+    while(next < indices.size() && !freeSlots.empty()) {
+      uint32_t index = indices[next];
+      if(port == 0 && icmpFd >= 0 && !responded[index]) {
+        struct icmphdr req = {};
+        req.type = ICMP_ECHO;
+        req.un.echo.sequence = htons((uint16_t)index);
+        struct sockaddr_in sa = {};
+        sa.sin_family = AF_INET;
+        sa.sin_addr.s_addr = htonl(base + index);
+        sendto(icmpFd, &req, sizeof(req), 0, (struct sockaddr*)&sa, sizeof(sa));
+        icmpDeadline = NowMillis() + PROBE_TIMEOUT_MS;
+      }
+      if(!responded[index] && OpenProbe(epollFd, freeSlots.back(), index, PROBE_PORTS[port])) {
+        freeSlots.pop_back();
+      }
+      if(++port == NUM_PORTS) {
+        port = 0;
+        if(++next == progressCounter && reportProgress) {
+          progressFunc();
+          progressCounter += progressInterval;
+        }
+      }
+    }
+
+    // Finish once every probe has completed or expired
+    uint64_t now = NowMillis();
+    bool idle = (freeSlots.size() == probes.size());
+    if(next == indices.size() && idle && now >= icmpDeadline) {
+      break;
+    }
+
+    // Wait no longer than the earliest deadline
+    uint64_t deadline = idle ? icmpDeadline : probeDeadline;
+    int timeout = (deadline > now) ? (int)(deadline - now) : 0;
+    int n = epoll_wait(epollFd, events, MAX_EVENTS, timeout);
+    for(int i=0; i<n; ++i) {
+      if(HandleSharedEvent(events[i].data.u64)) {
+        continue;
+      }
+
+      // Check the result of the connect
+      uint32_t slot = (uint32_t)events[i].data.u64;
+      int err = 0;
+      socklen_t errLen = sizeof(err);
+      getsockopt(probes[slot].fd, SOL_SOCKET, SO_ERROR, &err, &errLen);
+      if(err == 0 || err == ECONNREFUSED) {
+        MarkAlive(probes[slot].index);
+      }
+      CloseProbe(epollFd, slot, err == 0);
+    }
+
+    // Expire probes that have timed out
+    now = NowMillis();
+    probeDeadline = now + PROBE_TIMEOUT_MS;
+    for(uint32_t slot=0; slot<probes.size(); ++slot) {
+      if(probes[slot].fd < 0) {
+        continue;
+      }
+      if(probes[slot].deadline <= now || responded[probes[slot].index]) {
+        CloseProbe(epollFd, slot, false);
+      } else {
+        probeDeadline = std::min(probeDeadline, probes[slot].deadline);
+      }
+    }
+  }
+
+  // Release remaining sockets
+  for(uint32_t slot=0; slot<probes.size(); ++slot) {
+    if(probes[slot].fd >= 0) {
+      CloseProbe(epollFd, slot, false);
+    }
+  }
+}
+
+bool NetworkScanner::HandleSharedEvent(uint64_t tag) {
+  if(tag == ICMP_TAG) {
+    ReadEchoReplies();
+  } else if(tag == NEIGHBOR_TAG) {
+    ReadNeighbors();
+  } else if(tag != WAKE_TAG) {
+    return false;
+  }
+  return true;
+}
+
+void NetworkScanner::ReadEchoReplies() {
+  struct icmphdr reply;
+  struct sockaddr_in sa;
+  socklen_t saLen = sizeof(sa);
+  while(recvfrom(icmpFd, &reply, sizeof(reply), 0,
+    (struct sockaddr*)&sa, &saLen) >= (ssize_t)sizeof(reply)) {
+    uint32_t index = ntohl(sa.sin_addr.s_addr) - base;
+    if(reply.type == ICMP_ECHOREPLY && index < alive.size()) {
+      MarkAlive(index);
+    }
+    saLen = sizeof(sa);
+  }
+}
+
+void NetworkScanner::ReadNeighbors() {
+
+  // A reachable neighbor counts as an answer to the current round. Stale
+  // ones only say the host was up a while ago, so they're probed instead.
+  neighbors.Read(neighborEntries);
+  for(const Neighbor& neighbor : neighborEntries) {
+    uint32_t index = neighbor.address - base;
+    if(index >= alive.size()) {
+      continue;
+    }
+    if(neighbor.reachable) {
+      MarkAlive(index);
+    } else if(!alive[index]) {
+      seeds.push_back(index);
+    }
+  }
+  neighborEntries.clear();
+}
+
+static std::string AddressString(uint32_t address) {
+  char ip[INET_ADDRSTRLEN];
+  struct in_addr addr;
+  addr.s_addr = htonl(address);
+  inet_ntop(AF_INET, &addr, ip, sizeof(ip));
+  return ip;
+}
+
+void NetworkScanner::Resolve(uint32_t dnsServer, bool monitor) {
+
+  std::deque<Update> updates;
+  std::string name;
+  bool lookups = dnsServer != 0 && dns.Open(dnsServer);
+  bool finished = false;
+  names.clear();
+  DnsResolver::NameFunc nameFunc = [this](uint32_t address, const std::string& found) {
+    ReportName(address, found);
+  };
+
+  // Wait for updates and DNS answers. A one-shot scan ends once the
+  // names of the hosts it found are in.
+  struct pollfd fds[2] = {{queueFd, POLLIN, 0}, {dns.Fd(), POLLIN, 0}};
+  while(!stopped && !(finished && dns.Idle())) {
+    poll(fds, lookups ? 2 : 1, dns.Timeout(NowMillis()));
+    if(stopped) {
+      break;
+    }
+
+    // Take every queued update at once
+    eventfd_t count;
+    eventfd_read(queueFd, &count);
+    {
+      std::lock_guard<std::mutex> lock(queueMutex);
+      updates.swap(resolveQueue);
+    }
+    uint64_t now = NowMillis();
+    for(const Update& update : updates) {
+
+      // Every host found by the first sweep has been reported
+      if(update.kind == SWEEP_DONE) {
+        completeFunc();
+        finished = !monitor;
+        continue;
+      }
+      if(update.kind == HOST_LOST) {
+        names.erase(update.address);
+        lostFunc(update.address);
+        continue;
+      }
+
+      // New hosts are reported at once, without a name if it has to be
+      // looked up. A refresh only reports a changed name, once the cached
+      // one has expired and the new one has arrived.
+      name.clear();
+      bool cached = !lookups || dns.Cached(update.address, now, &name);
+      if(!cached) {
+        dns.Lookup(update.address);
+      }
+      if(update.kind == HOST_FOUND) {
+        names[update.address].clear();
+        if(!cached) {
+          hostFunc(":" + AddressString(update.address));
+        }
+      }
+      if(cached) {
+        ReportName(update.address, name);
+      }
+    }
+    updates.clear();
+    dns.Process(NowMillis(), nameFunc);
+  }
+  dns.Close();
+}
+
+void NetworkScanner::ReportName(uint32_t address, const std::string& name) {
+
+  // The host may have been lost while its name was looked up
+  std::unordered_map<uint32_t, std::string>::iterator it = names.find(address);
+  if(it == names.end()) {
+    return;
+  }
+  std::string ip = AddressString(address);
+  const std::string& label = name.empty() ? ip : name;
+  if(it->second != label) {
+    it->second = label;
+    hostFunc(label + ":" + ip);
+  }
+}
@@ -0,0 +1,126 @@
+#ifndef NETWORK_SCANNER_H_
+#define NETWORK_SCANNER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "dnsresolver.h"
+#include "neighbortable.h"
+
+// Finds hosts on a subnet. Hosts the kernel's neighbor table lists as
+// reachable are reported before any probe goes out and aren't probed by
+// the first sweep. Other neighbors are probed ahead of the rest of the
+// subnet. The sweep reports every live host and then completes. In
+// monitor mode the scanner keeps running, re-probing known hosts every few
+// seconds and the rest of the subnet a slice at a time, and only reports
+// hosts that appear, disappear or change name. Names are looked up
+// without holding up the reports.
+class NetworkScanner {
+
+  public:
+    typedef std::function<void(const std::string&)> HostFunc;
+    typedef std::function<void(uint32_t)> AddressFunc;
+    typedef std::function<void()> EventFunc;
+
+    // Found and renamed hosts are reported as "name:address" through
+    // hostFunc, with an empty name while it's looked up, and lost hosts by
+    // address through lostFunc. All reports come from one thread.
+    NetworkScanner(HostFunc hostFunc, AddressFunc lostFunc, EventFunc progressFunc,
+      EventFunc completeFunc);
+    ~NetworkScanner();
+
+    // Sweep the subnet containing the address in the background, then keep
+    // monitoring it if asked. Names are looked up on the DNS server, or not
+    // at all if it's 0. Addresses are in host byte order.
+    void Start(uint32_t address, int prefixLength, uint32_t dnsServer, bool monitor);
+
+    // Abort the sweep and wait for the worker threads to exit
+    void Stop();
+
+    // Skip monitor rounds while paused
+    void SetPaused(bool pause) { paused = pause; }
+
+    // Number of progress updates reported over a full sweep
+    static const unsigned int PROGRESS_STEPS = 64;
+
+  private:
+    typedef struct {
+      int fd;
+      uint32_t index;
+      uint64_t deadline;
+    } Probe;
+
+    // Work for the resolver thread, handled in order
+    enum UpdateKind { HOST_FOUND, HOST_LOST, HOST_REFRESH, SWEEP_DONE };
+    typedef struct {
+      uint32_t address;
+      UpdateKind kind;
+    } Update;
+
+    // Sweep the subnet, then monitor it, from the sweep thread
+    void Sweep(uint32_t address, int prefixLength, bool monitor);
+    void Monitor(uint32_t first, uint32_t last);
+
+    // Probe the addresses at these indices from a single epoll loop,
+    // returning once every probe has been answered or has expired
+    void ProbeAddresses(const std::vector<uint32_t>& indices, bool reportProgress);
+
+    // Handle the sockets watched while probing and between rounds,
+    // returning false for probe slots
+    bool HandleSharedEvent(uint64_t tag);
+    void ReadEchoReplies();
+    void ReadNeighbors();
+
+    // Report updates from the resolver thread, looking up host names
+    void Resolve(uint32_t dnsServer, bool monitor);
+    void ReportName(uint32_t address, const std::string& name);
+
+    bool OpenProbe(int epollFd, uint32_t slot, uint32_t addr, unsigned short port);
+    void CloseProbe(int epollFd, uint32_t slot, bool reset);
+    void MarkAlive(uint32_t index);
+    void PushUpdate(uint32_t address, UpdateKind kind);
+
+    HostFunc hostFunc;
+    AddressFunc lostFunc;
+    EventFunc progressFunc, completeFunc;
+    std::thread sweepThread, resolveThread;
+    std::atomic<bool> stopped, paused;
+
+    // Sweep state. Responded is per probe round; misses counts the rounds
+    // in a row a live host hasn't answered.
+    uint32_t base;
+    std::vector<uint8_t> alive, responded, misses;
+    std::vector<Probe> probes;
+    std::vector<uint32_t> freeSlots;
+    int epollFd, icmpFd;
+    bool churn;
+
+    // Neighbors reported by the kernel, the buffer they're read into, and
+    // the indices of unconfirmed ones waiting to be probed
+    NeighborTable neighbors;
+    std::vector<Neighbor> neighborEntries;
+    std::vector<uint32_t> seeds;
+
+    // Updates waiting for the resolver, which is woken through queueFd
+    std::mutex queueMutex;
+    std::deque<Update> resolveQueue;
+    int queueFd;
+
+    // Resolver state. Names holds the last name reported for each live
+    // address, or its address string if it has none, so it never outgrows
+    // the subnet, which MIN_PREFIX limits to 65536 addresses.
+    DnsResolver dns;
+    std::unordered_map<uint32_t, std::string> names;
+
+    // Event counter that wakes the sweep thread's epoll loop to stop
+    int wakeFd;
+};
+
+#endif  // NETWORK_SCANNER_H_
@@ -1,32 +1,23 @@
 #include "shaderutils.h"
 
-static const char* TAG = "NetworkDiscovery";
-
-std::string ShaderUtils::ReadFile(AAssetManager* mgr, const char* fileName) {
+#include <cstdio>
 
-  std::string shaderCode;
+static const char* TAG = "NetworkDiscovery";
 
-  // Read shader file
-  AAsset* asset = AAssetManager_open(mgr,
-    fileName, AASSET_MODE_BUFFER);
-  unsigned int length =
-      static_cast<unsigned int>(AAsset_getLength(asset));
-  
-  // Read shader text into string
-  shaderCode.reserve(length+1);
-  AAsset_read(asset, &shaderCode[0], length);
-  AAsset_close(asset);
-  shaderCode[length] = '\0';
+// FNV-1a parameters
+static const uint64_t FNV_OFFSET = 14695981039346656037ULL;
+static const uint64_t FNV_PRIME = 1099511628211ULL;
 
-  return shaderCode;
+void ShaderUtils::CompileShader(GLuint shader) {
+  glCompileShader(shader);
+  CheckShader(shader);
 }
 
-void ShaderUtils::CompileShader(GLuint shader) {
+void ShaderUtils::CheckShader(GLuint shader) {
   int status = GL_TRUE;
   GLsizei logLength = 0;
   std::string log;
 
-  glCompileShader(shader);
   glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
   if(status == GL_FALSE) {
     glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
@@ -39,11 +30,15 @@ void ShaderUtils::CompileShader(GLuint shader) {
 }
 
 void ShaderUtils::LinkProgram(GLuint program) {
+  glLinkProgram(program);
+  CheckProgram(program);
+}
+
+void ShaderUtils::CheckProgram(GLuint program) {
   int status = GL_TRUE;
   GLsizei logLength = 0;
   std::string log;
-  
-  glLinkProgram(program);
+
   glGetProgramiv(program, GL_LINK_STATUS, &status);
   if(status == GL_FALSE) {
     glGetProgramiv(program, GL_INFO_LOG_LENGTH, &logLength);   
@@ -53,4 +48,82 @@ void ShaderUtils::LinkProgram(GLuint program) {
     glDeleteProgram(program);    
     exit(EXIT_FAILURE);
   }
-}
\ No newline at end of file
+}
+
+uint64_t ShaderUtils::Hash(const char* data, size_t length, uint64_t hash) {
+  for(size_t i=0; i<length; ++i) {
+    hash ^= (unsigned char)data[i];
+    hash *= FNV_PRIME;
+  }
+  return hash;
+}
+
+uint64_t ShaderUtils::Hash(const std::string& data, uint64_t hash) {
+  return Hash(data.data(), data.length(), hash);
+}
+
+uint64_t ShaderUtils::Hash(const std::string& data) {
+  return Hash(data, FNV_OFFSET);
+}
+
+GLuint ShaderUtils::LoadProgramBinary(const std::string& path) {
+
+  // Read the binary format and data
+  FILE* file = fopen(path.c_str(), "rb");
+  if(!file) {
+    return 0;
+  }
+  GLenum format;
+  std::vector<char> binary;
+  bool valid = false;
+  if(fread(&format, sizeof(format), 1, file) == 1 && fseek(file, 0, SEEK_END) == 0) {
+    long length = ftell(file) - (long)sizeof(format);
+    if(length > 0) {
+      binary.resize(length);
+      fseek(file, sizeof(format), SEEK_SET);
+      valid = fread(binary.data(), 1, length, file) == (size_t)length;
+    }
+  }
+  fclose(file);
+  if(!valid) {
+    return 0;
+  }
+
+  // The driver rejects binaries it can no longer load
+  GLuint program = glCreateProgram();
+  glProgramBinary(program, format, binary.data(), binary.size());
+  int status = GL_FALSE;
+  glGetProgramiv(program, GL_LINK_STATUS, &status);
+  if(status == GL_FALSE) {
+    glDeleteProgram(program);
+    return 0;
+  }
+  return program;
+}
+
+void ShaderUtils::SaveProgramBinary(GLuint program, const std::string& path) {
+
+  // Drivers without binary formats report a zero length
+  GLint length = 0;
+  glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+  if(length <= 0) {
+    return;
+  }
+  std::vector<char> binary(length);
+  GLenum format;
+  glGetProgramBinary(program, length, &length, &format, binary.data());
+
+  // Write to a temporary file so a partial write is never loaded
+  std::string tempPath = path + ".tmp";
+  FILE* file = fopen(tempPath.c_str(), "wb");
+  if(!file) {
+    __android_log_print(ANDROID_LOG_WARN, TAG, "Can't write %s", tempPath.c_str());
+    return;
+  }
+  bool written = fwrite(&format, sizeof(format), 1, file) == 1 &&
+    fwrite(binary.data(), 1, length, file) == (size_t)length;
+  written = (fclose(file) == 0) && written;
+  if(!written || rename(tempPath.c_str(), path.c_str()) != 0) {
+    remove(tempPath.c_str());
+  }
+}
@@ -1,11 +1,11 @@
 #ifndef SHADER_UTILS_H_
 #define SHADER_UTILS_H_
 
+#include <cstdint>
 #include <cstdlib>
 #include <string>
 #include <vector>
 
-#include <android/asset_manager_jni.h>
 #include <android/log.h>
 
 #include <GLES3/gl3.h>
@@ -14,14 +14,29 @@ class ShaderUtils {
   
   public:
   
-    // Read text from shader file in assets folder  
-    static std::string ReadFile(AAssetManager* mgr, const char* fileName);
-    
     // Compile the shader program
     static void CompileShader(GLuint shader);
     
     // Link shaders into the program
     static void LinkProgram(GLuint program);
+
+    // Exit with the info log if compiling or linking failed. These wait
+    // for the driver to finish, so call them after submitting all work.
+    static void CheckShader(GLuint shader);
+    static void CheckProgram(GLuint program);
+
+    // Hash text with FNV-1a, optionally continuing an earlier hash
+    static uint64_t Hash(const std::string& data);
+    static uint64_t Hash(const std::string& data, uint64_t hash);
+    static uint64_t Hash(const char* data, size_t length, uint64_t hash);
+
+    // Load a program binary saved by SaveProgramBinary, returning 0 if
+    // the file is missing or the driver rejects it
+    static GLuint LoadProgramBinary(const std::string& path);
+
+    // Save a linked program's binary. Link with
+    // GL_PROGRAM_BINARY_RETRIEVABLE_HINT set for this to succeed.
+    static void SaveProgramBinary(GLuint program, const std::string& path);
 };
 
 #endif  // SHADER_UTILS_H_
\ No newline at end of file
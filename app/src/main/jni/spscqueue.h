@@ -0,0 +1,69 @@
+#ifndef SPSC_QUEUE_H_
+#define SPSC_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+
+// Bounded single-producer/single-consumer ring. Slots are constructed once
+// and filled in place, so the handoff itself never allocates or locks.
+template<typename T, size_t N>
+class SpscQueue {
+
+  static_assert(N > 0 && (N & (N - 1)) == 0, "Queue size must be a power of two");
+
+  public:
+    SpscQueue(): head(0), cachedTail(0), tail(0), cachedHead(0) {}
+
+    // Producer: slot to fill before Push, or NULL if the queue is full
+    T* Back() {
+      size_t t = tail.load(std::memory_order_relaxed);
+      if(t - cachedHead == N) {
+        cachedHead = head.load(std::memory_order_acquire);
+        if(t - cachedHead == N) {
+          return NULL;
+        }
+      }
+      return &slots[t & (N - 1)];
+    }
+
+    // Producer: publish the slot returned by Back
+    void Push() {
+      tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Consumer: oldest filled slot, or NULL if the queue is empty
+    T* Front() {
+      size_t h = head.load(std::memory_order_relaxed);
+      if(h == cachedTail) {
+        cachedTail = tail.load(std::memory_order_acquire);
+        if(h == cachedTail) {
+          return NULL;
+        }
+      }
+      return &slots[h & (N - 1)];
+    }
+
+    // Consumer: return the slot returned by Front to the producer
+    void Pop() {
+      head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+  private:
+    // Padding keeps each side's indices on its own cache line without
+    // requiring an over-aligned allocation for the owning object
+    static const size_t CACHE_LINE = 64;
+    T slots[N];
+
+    // Consumer-owned line
+    char pad0[CACHE_LINE];
+    std::atomic<size_t> head;
+    size_t cachedTail;
+
+    // Producer-owned line
+    char pad1[CACHE_LINE - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+    std::atomic<size_t> tail;
+    size_t cachedHead;
+    char pad2[CACHE_LINE - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+};
+
+#endif  // SPSC_QUEUE_H_
@@ -0,0 +1,127 @@
+#include "streambuffer.h"
+
+// Wait at most one second for the GPU to release a region
+static const GLuint64 FENCE_TIMEOUT = 1000000000;
+
+StreamBuffer::StreamBuffer():
+  buffer(0),
+  mapped(NULL),
+  frameSize(0),
+  frameStart(0),
+  frameOffset(0),
+  flushOffset(0),
+  frame(0) {
+
+  for(int i=0; i<NUM_STREAM_FRAMES; ++i) {
+    fences[i] = 0;
+  }
+}
+
+void StreamBuffer::Init(GLsizeiptr size, PFNGLBUFFERSTORAGEEXTPROC bufferStorage) {
+
+  frameSize = size;
+  frame = NUM_STREAM_FRAMES - 1;
+
+  // Allocate immutable storage and keep it mapped
+  glGenBuffers(1, &buffer);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+  if(bufferStorage) {
+    bufferStorage(GL_COPY_WRITE_BUFFER, NUM_STREAM_FRAMES * frameSize, NULL,
+      GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT_EXT | GL_MAP_COHERENT_BIT_EXT);
+    mapped = (GLubyte*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, NUM_STREAM_FRAMES * frameSize,
+      GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT_EXT | GL_MAP_COHERENT_BIT_EXT);
+  }
+
+  // Otherwise stage each frame's writes in memory. Immutable storage can't
+  // be respecified, so a buffer that failed to map is replaced.
+  if(!mapped) {
+    if(bufferStorage) {
+      glDeleteBuffers(1, &buffer);
+      glGenBuffers(1, &buffer);
+      glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    }
+    glBufferData(GL_COPY_WRITE_BUFFER, NUM_STREAM_FRAMES * frameSize, NULL, GL_STREAM_DRAW);
+    staging.resize(frameSize);
+  }
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void StreamBuffer::Destroy() {
+
+  for(int i=0; i<NUM_STREAM_FRAMES; ++i) {
+    if(fences[i]) {
+      glDeleteSync(fences[i]);
+      fences[i] = 0;
+    }
+  }
+  if(buffer) {
+    if(mapped) {
+      glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+      glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+      glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+    glDeleteBuffers(1, &buffer);
+    buffer = 0;
+    mapped = NULL;
+  }
+  staging.clear();
+}
+
+void StreamBuffer::Reset() {
+
+  for(int i=0; i<NUM_STREAM_FRAMES; ++i) {
+    fences[i] = 0;
+  }
+  buffer = 0;
+  mapped = NULL;
+  staging.clear();
+  frameOffset = 0;
+  flushOffset = 0;
+}
+
+void StreamBuffer::BeginFrame() {
+
+  frame = (frame + 1) % NUM_STREAM_FRAMES;
+  frameStart = frame * frameSize;
+  frameOffset = 0;
+  flushOffset = 0;
+
+  // Wait until the GPU is done with this region
+  if(fences[frame]) {
+    glClientWaitSync(fences[frame], GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT);
+    glDeleteSync(fences[frame]);
+    fences[frame] = 0;
+  }
+}
+
+void StreamBuffer::EndFrame() {
+  fences[frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+GLsizeiptr StreamBuffer::Available(GLintptr alignment) const {
+  GLintptr aligned = (frameOffset + alignment - 1) / alignment * alignment;
+  return (aligned < frameSize) ? frameSize - aligned : 0;
+}
+
+void* StreamBuffer::Allocate(GLsizeiptr size, GLintptr alignment, GLintptr* offset) {
+
+  GLintptr aligned = (frameOffset + alignment - 1) / alignment * alignment;
+  if(aligned + size > frameSize) {
+    return NULL;
+  }
+  frameOffset = aligned + size;
+  *offset = frameStart + aligned;
+  return mapped ? mapped + *offset : staging.data() + aligned;
+}
+
+void StreamBuffer::Flush() {
+
+  if(mapped || flushOffset == frameOffset) {
+    return;
+  }
+  glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+  glBufferSubData(GL_COPY_WRITE_BUFFER, frameStart + flushOffset, frameOffset - flushOffset,
+    staging.data() + flushOffset);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+  flushOffset = frameOffset;
+}
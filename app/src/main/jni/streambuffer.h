@@ -0,0 +1,64 @@
+#ifndef STREAM_BUFFER_H_
+#define STREAM_BUFFER_H_
+
+#include <cstddef>
+#include <vector>
+
+#include <EGL/egl.h>
+#include <GLES3/gl3.h>
+#include <GLES2/gl2ext.h>
+
+#define NUM_STREAM_FRAMES 3
+
+// Persistently mapped buffer split into one region per frame in flight.
+// Each frame writes into its own region, and a fence keeps the CPU from
+// reusing a region until the GPU has finished reading it. Without
+// GL_EXT_buffer_storage, or if mapping fails, writes are staged in memory
+// and uploaded by Flush.
+class StreamBuffer {
+
+  public:
+    StreamBuffer();
+
+    // Create the buffer and map it for the lifetime of the context, or
+    // stage writes if bufferStorage is NULL
+    void Init(GLsizeiptr frameSize, PFNGLBUFFERSTORAGEEXTPROC bufferStorage);
+    void Destroy();
+
+    // Forget the buffer and fences of a lost context without deleting them
+    void Reset();
+
+    // Move to the next region, waiting for the GPU if it still uses it
+    void BeginFrame();
+
+    // Fence the commands that read the current region
+    void EndFrame();
+
+    // Reserve space in the current region, returns NULL when full
+    void* Allocate(GLsizeiptr size, GLintptr alignment, GLintptr* offset);
+
+    // Upload staged writes so far, before the GPU reads them. Does nothing
+    // when the buffer is mapped.
+    void Flush();
+
+    bool Mapped() const { return mapped != NULL; }
+
+    // Bytes left in the current region after aligning
+    GLsizeiptr Available(GLintptr alignment) const;
+
+    // Bytes reserved in the current region, including alignment padding
+    GLsizeiptr Used() const { return frameOffset; }
+
+    GLuint Buffer() const { return buffer; }
+
+  private:
+    GLuint buffer;
+    GLubyte* mapped;
+    GLsizeiptr frameSize;
+    GLintptr frameStart, frameOffset, flushOffset;
+    std::vector<GLubyte> staging;
+    int frame;
+    GLsync fences[NUM_STREAM_FRAMES];
+};
+
+#endif  // STREAM_BUFFER_H_
@@ -1,435 +1,387 @@
 #include "textutils.h"
 
-TextureAtlas TextUtils::CreateAtlas() {
-  TextureChar ch;
-  TextureAtlas atlas;
+#include <algorithm>
 
-  atlas.lineHeight = 24;
-  atlas.textureWidth = 256;
-  atlas.textureHeight = 256;
-  ch = {0.39453125f, 0.59765625f, 0.02734375f, 0.01953125f, 0.0f, 6.0f, 7.0f};
-  atlas.charMap.emplace(34, ch);
-  ch = {0.0f, 0.7421875f, 0.046875f, 0.05078125f, 0.0f, 6.0f, 11.0f};
-  atlas.charMap.emplace(35, ch);
-  ch = {0.75390625f, 0.6015625f, 0.01171875f, 0.00390625f, -1.0f, 23.0f, 5.0f};
-  atlas.charMap.emplace(32, ch);
-  ch = {0.91015625f, 0.69921875f, 0.01171875f, 0.05078125f, 1.0f, 6.0f, 5.0f};
-  atlas.charMap.emplace(33, ch);
-  ch = {0.69140625f, 0.8046875f, 0.0546875f, 0.05078125f, 0.0f, 6.0f, 13.0f};
-  atlas.charMap.emplace(38, ch);
-  ch = {0.98046875f, 0.66015625f, 0.015625f, 0.01953125f, 0.0f, 6.0f, 4.0f};
-  atlas.charMap.emplace(39, ch);
-  ch = {0.765625f, 0.9296875f, 0.0390625f, 0.05859375f, 0.0f, 5.0f, 10.0f};
-  atlas.charMap.emplace(36, ch);
-  ch = {0.39453125f, 0.8046875f, 0.05859375f, 0.05078125f, 0.0f, 6.0f, 15.0f};
-  atlas.charMap.emplace(37, ch);
-  ch = {0.8671875f, 0.64453125f, 0.0390625f, 0.03125f, 0.0f, 5.0f, 10.0f};
-  atlas.charMap.emplace(42, ch);
-  ch = {0.73828125f, 0.640625f, 0.0390625f, 0.03515625f, 0.0f, 8.0f, 10.0f};
-  atlas.charMap.emplace(43, ch);
-  ch = {0.65234375f, 0.9296875f, 0.01953125f, 0.0625f, 0.0f, 6.0f, 5.0f};
-  atlas.charMap.emplace(40, ch);
-  ch = {0.60546875f, 0.9296875f, 0.01953125f, 0.0625f, 0.0f, 6.0f, 5.0f};
-  atlas.charMap.emplace(41, ch);
-  ch = {0.578125f, 0.59765625f, 0.01171875f, 0.0078125f, 1.0f, 17.0f, 5.0f};
-  atlas.charMap.emplace(46, ch);
-  ch = {0.86328125f, 0.69921875f, 0.02734375f, 0.05078125f, 0.0f, 6.0f, 6.0f};
-  atlas.charMap.emplace(47, ch);
-  ch = {0.44921875f, 0.59765625f, 0.015625f, 0.015625f, 0.0f, 17.0f, 4.0f};
-  atlas.charMap.emplace(44, ch);
-  ch = {0.69921875f, 0.6015625f, 0.0234375f, 0.00390625f, 0.0f, 13.0f, 6.0f};
-  atlas.charMap.emplace(45, ch);
-  ch = {0.30078125f, 0.6953125f, 0.0390625f, 0.05078125f, 0.0f, 6.0f, 10.0f};
-  atlas.charMap.emplace(51, ch);
-  ch = {0.2578125f, 0.6953125f, 0.0390625f, 0.05078125f, 0.0f, 6.0f, 10.0f};
-  atlas.charMap.emplace(50, ch);
-  ch = {0.97265625f, 0.8125f, 0.0234375f, 0.05078125f, 1.0f, 6.0f, 10.0f};
-  atlas.charMap.emplace(49, ch);
-  ch = {0.21484375f, 0.6953125f, 0.0390625f, 0.05078125f, 0.0f, 6.0f, 10.0f};
-  atlas.charMap.emplace(48, ch);
-  ch = {0.04296875f, 0.6875f, 0.0390625f, 0.05078125f, 0.0f, 6.0f, 10.0f};
-  atlas.charMap.emplace(55, ch);
-  ch = {0.68359375f, 0.75f, 0.0390625f, 0.05078125f, 0.0f, 6.0f, 10.0f};
-  atlas.charMap.emplace(54, ch);
-  ch = {0.38671875f, 0.6953125f, 0.0390625f, 0.05078125f, 0.0f, 6.0f, 10.0f};
-  atlas.charMap.emplace(53, ch);
-  ch = {0.34375f, 0.6953125f, 0.0390625f, 0.05078125f, 0.0f, 6.0f, 10.0f};
-  atlas.charMap.emplace(52, ch);
-  ch = {0.953125f, 0.703125f, 0.015625f, 0.046875f, 0.0f, 9.0f, 5.0f};
-  atlas.charMap.emplace(59, ch);
-  ch = {0.6796875f, 0.640625f, 0.01171875f, 0.0390625f, 1.0f, 9.0f, 5.0f};
-  atlas.charMap.emplace(58, ch);
-  ch = {0.8125f, 0.75390625f, 0.0390625f, 0.05078125f, 0.0f, 6.0f, 10.0f};
-  atlas.charMap.emplace(57, ch);
-  ch = {0.76953125f, 0.75390625f, 0.0390625f, 0.05078125f, 0.0f, 6.0f, 10.0f};
-  atlas.charMap.emplace(56, ch);
-  ch = {0.765625f, 0.6953125f, 0.03125f, 0.05078125f, 0.0f, 6.0f, 8.0f};
-  atlas.charMap.emplace(63, ch);
-  ch = {0.78125f, 0.640625f, 0.0390625f, 0.03515625f, 0.0f, 8.0f, 10.0f};
-  atlas.charMap.emplace(62, ch);
-  ch = {0.31640625f, 0.59765625f, 0.0390625f, 0.01953125f, 0.0f, 10.0f, 10.0f};
-  atlas.charMap.emplace(61, ch);
-  ch = {0.82421875f, 0.64453125f, 0.0390625f, 0.03515625f, 0.0f, 8.0f, 10.0f};
-  atlas.charMap.emplace(60, ch);
-  ch = {0.05078125f, 0.7421875f, 0.046875f, 0.05078125f, 1.0f, 6.0f, 13.0f};
-  atlas.charMap.emplace(68, ch);
-  ch = {0.546875f, 0.6953125f, 0.03515625f, 0.05078125f, 1.0f, 6.0f, 10.0f};
-  atlas.charMap.emplace(69, ch);
-  ch = {0.625f, 0.6953125f, 0.03125f, 0.05078125f, 1.0f, 6.0f, 9.0f};
-  atlas.charMap.emplace(70, ch);
-  ch = {0.3046875f, 0.75f, 0.046875f, 0.05078125f, 0.0f, 6.0f, 13.0f};
-  atlas.charMap.emplace(71, ch);
-  ch = {0.69921875f, 0.9296875f, 0.0625f, 0.05859375f, 0.0f, 6.0f, 16.0f};
-  atlas.charMap.emplace(64, ch);
-  ch = {0.86328125f, 0.80859375f, 0.05078125f, 0.05078125f, -1.0f, 6.0f, 11.0f};
-  atlas.charMap.emplace(65, ch);
-  ch = {0.63671875f, 0.75f, 0.04296875f, 0.05078125f, 1.0f, 6.0f, 11.0f};
-  atlas.charMap.emplace(66, ch);
-  ch = {0.58984375f, 0.75f, 0.04296875f, 0.05078125f, 0.0f, 6.0f, 11.0f};
-  atlas.charMap.emplace(67, ch);
-  ch = {0.66015625f, 0.6953125f, 0.03125f, 0.05078125f, 1.0f, 6.0f, 9.0f};
-  atlas.charMap.emplace(76, ch);
-  ch = {0.515625f, 0.8046875f, 0.0546875f, 0.05078125f, 1.0f, 6.0f, 16.0f};
-  atlas.charMap.emplace(77, ch);
-  ch = {0.25390625f, 0.75f, 0.046875f, 0.05078125f, 1.0f, 6.0f, 13.0f};
-  atlas.charMap.emplace(78, ch);
-  ch = {0.45703125f, 0.8046875f, 0.0546875f, 0.05078125f, 0.0f, 6.0f, 14.0f};
-  atlas.charMap.emplace(79, ch);
-  ch = {0.40234375f, 0.75f, 0.04296875f, 0.05078125f, 1.0f, 6.0f, 13.0f};
-  atlas.charMap.emplace(72, ch);
-  ch = {0.89453125f, 0.69921875f, 0.01171875f, 0.05078125f, 1.0f, 6.0f, 5.0f};
-  atlas.charMap.emplace(73, ch);
-  ch = {0.578125f, 0.9296875f, 0.0234375f, 0.0625f, -2.0f, 6.0f, 5.0f};
-  atlas.charMap.emplace(74, ch);
-  ch = {0.35546875f, 0.75f, 0.04296875f, 0.05078125f, 1.0f, 6.0f, 11.0f};
-  atlas.charMap.emplace(75, ch);
-  ch = {0.44921875f, 0.75f, 0.04296875f, 0.05078125f, 1.0f, 6.0f, 13.0f};
-  atlas.charMap.emplace(85, ch);
-  ch = {0.1015625f, 0.74609375f, 0.046875f, 0.05078125f, -1.0f, 6.0f, 10.0f};
-  atlas.charMap.emplace(84, ch);
-  ch = {0.1328125f, 0.80078125f, 0.06640625f, 0.05078125f, 0.0f, 6.0f, 16.0f};
-  atlas.charMap.emplace(87, ch);
-  ch = {0.91796875f, 0.8125f, 0.05078125f, 0.05078125f, -1.0f, 6.0f, 10.0f};
-  atlas.charMap.emplace(86, ch);
-  ch = {0.0f, 0.92578125f, 0.0546875f, 0.0625f, 0.0f, 6.0f, 14.0f};
-  atlas.charMap.emplace(81, ch);
-  ch = {0.85546875f, 0.75390625f, 0.0390625f, 0.05078125f, 1.0f, 6.0f, 11.0f};
-  atlas.charMap.emplace(80, ch);
-  ch = {0.94140625f, 0.7578125f, 0.0390625f, 0.05078125f, 0.0f, 6.0f, 10.0f};
-  atlas.charMap.emplace(83, ch);
-  ch = {0.8984375f, 0.75390625f, 0.0390625f, 0.05078125f, 1.0f, 6.0f, 11.0f};
-  atlas.charMap.emplace(82, ch);
-  ch = {0.62890625f, 0.9296875f, 0.01953125f, 0.0625f, 0.0f, 6.0f, 6.0f};
-  atlas.charMap.emplace(93, ch);
-  ch = {0.80078125f, 0.69921875f, 0.02734375f, 0.05078125f, 0.0f, 6.0f, 6.0f};
-  atlas.charMap.emplace(92, ch);
-  ch = {0.65625f, 0.59765625f, 0.0390625f, 0.00390625f, -1.0f, 21.0f, 8.0f};
-  atlas.charMap.emplace(95, ch);
-  ch = {0.91015625f, 0.64453125f, 0.0390625f, 0.03125f, 0.0f, 6.0f, 10.0f};
-  atlas.charMap.emplace(94, ch);
-  ch = {0.203125f, 0.75f, 0.046875f, 0.05078125f, -1.0f, 6.0f, 10.0f};
-  atlas.charMap.emplace(89, ch);
-  ch = {0.15234375f, 0.74609375f, 0.046875f, 0.05078125f, -1.0f, 6.0f, 10.0f};
-  atlas.charMap.emplace(88, ch);
-  ch = {0.67578125f, 0.9296875f, 0.01953125f, 0.0625f, 1.0f, 6.0f, 6.0f};
-  atlas.charMap.emplace(91, ch);
-  ch = {0.0f, 0.6875f, 0.0390625f, 0.05078125f, 0.0f, 6.0f, 10.0f};
-  atlas.charMap.emplace(90, ch);
-  ch = {0.79296875f, 0.8671875f, 0.03515625f, 0.0546875f, -1.0f, 5.0f, 6.0f};
-  atlas.charMap.emplace(102, ch);
-  ch = {0.3515625f, 0.86328125f, 0.0390625f, 0.0546875f, 0.0f, 9.0f, 10.0f};
-  atlas.charMap.emplace(103, ch);
-  ch = {0.30859375f, 0.86328125f, 0.0390625f, 0.0546875f, 0.0f, 5.0f, 11.0f};
-  atlas.charMap.emplace(100, ch);
-  ch = {0.3671875f, 0.640625f, 0.0390625f, 0.0390625f, 0.0f, 9.0f, 10.0f};
-  atlas.charMap.emplace(101, ch);
-  ch = {0.265625f, 0.86328125f, 0.0390625f, 0.0546875f, 1.0f, 5.0f, 11.0f};
-  atlas.charMap.emplace(98, ch);
-  ch = {0.48828125f, 0.640625f, 0.03515625f, 0.0390625f, 0.0f, 9.0f, 8.0f};
-  atlas.charMap.emplace(99, ch);
-  ch = {0.46875f, 0.59765625f, 0.015625f, 0.01171875f, 3.0f, 5.0f, 10.0f};
-  atlas.charMap.emplace(96, ch);
-  ch = {0.44921875f, 0.640625f, 0.03515625f, 0.0390625f, 0.0f, 9.0f, 10.0f};
-  atlas.charMap.emplace(97, ch);
-  ch = {0.56640625f, 0.640625f, 0.03515625f, 0.0390625f, 1.0f, 9.0f, 11.0f};
-  atlas.charMap.emplace(110, ch);
-  ch = {0.2265625f, 0.640625f, 0.04296875f, 0.0390625f, 0.0f, 9.0f, 11.0f};
-  atlas.charMap.emplace(111, ch);
-  ch = {0.98046875f, 0.87109375f, 0.01171875f, 0.0546875f, 1.0f, 5.0f, 4.0f};
-  atlas.charMap.emplace(108, ch);
-  ch = {0.10546875f, 0.6328125f, 0.05859375f, 0.0390625f, 1.0f, 9.0f, 16.0f};
-  atlas.charMap.emplace(109, ch);
-  ch = {0.08984375f, 1.0f, 0.0234375f, 0.0703125f, -2.0f, 5.0f, 4.0f};
-  atlas.charMap.emplace(106, ch);
-  ch = {0.9453125f, 0.87109375f, 0.03125f, 0.0546875f, 1.0f, 5.0f, 9.0f};
-  atlas.charMap.emplace(107, ch);
-  ch = {0.87109375f, 0.87109375f, 0.03515625f, 0.0546875f, 1.0f, 5.0f, 11.0f};
-  atlas.charMap.emplace(104, ch);
-  ch = {0.046875f, 0.80078125f, 0.01171875f, 0.0546875f, 1.0f, 5.0f, 4.0f};
-  atlas.charMap.emplace(105, ch);
-  ch = {0.16796875f, 0.63671875f, 0.0546875f, 0.0390625f, 0.0f, 9.0f, 14.0f};
-  atlas.charMap.emplace(119, ch);
-  ch = {0.3203125f, 0.640625f, 0.04296875f, 0.0390625f, -1.0f, 9.0f, 9.0f};
-  atlas.charMap.emplace(118, ch);
-  ch = {0.60546875f, 0.640625f, 0.03515625f, 0.0390625f, 1.0f, 9.0f, 11.0f};
-  atlas.charMap.emplace(117, ch);
-  ch = {0.92578125f, 0.69921875f, 0.0234375f, 0.046875f, 0.0f, 7.0f, 6.0f};
-  atlas.charMap.emplace(116, ch);
-  ch = {0.41015625f, 0.640625f, 0.03515625f, 0.0390625f, 0.0f, 9.0f, 8.0f};
-  atlas.charMap.emplace(115, ch);
-  ch = {0.97265625f, 0.703125f, 0.0234375f, 0.0390625f, 1.0f, 9.0f, 7.0f};
-  atlas.charMap.emplace(114, ch);
-  ch = {0.4375f, 0.86328125f, 0.0390625f, 0.0546875f, 0.0f, 9.0f, 11.0f};
-  atlas.charMap.emplace(113, ch);
-  ch = {0.39453125f, 0.86328125f, 0.0390625f, 0.0546875f, 1.0f, 9.0f, 11.0f};
-  atlas.charMap.emplace(112, ch);
-  ch = {0.5078125f, 0.59765625f, 0.0390625f, 0.0078125f, 0.0f, 12.0f, 10.0f};
-  atlas.charMap.emplace(126, ch);
-  ch = {0.546875f, 0.9296875f, 0.02734375f, 0.0625f, 0.0f, 6.0f, 7.0f};
-  atlas.charMap.emplace(125, ch);
-  ch = {0.12890625f, 1.0f, 0.0078125f, 0.0703125f, 4.0f, 5.0f, 10.0f};
-  atlas.charMap.emplace(124, ch);
-  ch = {0.484375f, 0.9296875f, 0.02734375f, 0.0625f, 0.0f, 6.0f, 7.0f};
-  atlas.charMap.emplace(123, ch);
-  ch = {0.64453125f, 0.640625f, 0.03125f, 0.0390625f, 0.0f, 9.0f, 8.0f};
-  atlas.charMap.emplace(122, ch);
-  ch = {0.94140625f, 0.9296875f, 0.04296875f, 0.0546875f, -1.0f, 9.0f, 9.0f};
-  atlas.charMap.emplace(121, ch);
-  ch = {0.52734375f, 0.640625f, 0.03515625f, 0.0390625f, 0.0f, 9.0f, 9.0f};
-  atlas.charMap.emplace(120, ch);
-  ch = {0.13671875f, 0.58984375f, 0.03515625f, 0.02734375f, 0.0f, 11.0f, 9.0f};
-  atlas.charMap.emplace(171, ch);
-  ch = {0.24609375f, 0.59765625f, 0.0234375f, 0.0234375f, 0.0f, 6.0f, 6.0f};
-  atlas.charMap.emplace(170, ch);
-  ch = {0.26953125f, 0.8046875f, 0.05859375f, 0.05078125f, 0.0f, 6.0f, 15.0f};
-  atlas.charMap.emplace(169, ch);
-  ch = {0.55078125f, 0.59765625f, 0.0234375f, 0.0078125f, 2.0f, 6.0f, 10.0f};
-  atlas.charMap.emplace(168, ch);
-  ch = {0.609375f, 0.59765625f, 0.04296875f, 0.00390625f, -1.0f, 4.0f, 9.0f};
-  atlas.charMap.emplace(175, ch);
-  ch = {0.33203125f, 0.8046875f, 0.05859375f, 0.05078125f, 0.0f, 6.0f, 15.0f};
-  atlas.charMap.emplace(174, ch);
-  ch = {0.7265625f, 0.6015625f, 0.0234375f, 0.00390625f, 0.0f, 13.0f, 6.0f};
-  atlas.charMap.emplace(173, ch);
-  ch = {0.2734375f, 0.59765625f, 0.0390625f, 0.01953125f, 0.0f, 12.0f, 10.0f};
-  atlas.charMap.emplace(172, ch);
-  ch = {0.0859375f, 0.6875f, 0.0390625f, 0.05078125f, 0.0f, 6.0f, 10.0f};
-  atlas.charMap.emplace(163, ch);
-  ch = {0.73046875f, 0.6953125f, 0.03125f, 0.05078125f, 1.0f, 6.0f, 10.0f};
-  atlas.charMap.emplace(162, ch);
-  ch = {0.984375f, 0.7578125f, 0.01171875f, 0.05078125f, 1.0f, 9.0f, 5.0f};
-  atlas.charMap.emplace(161, ch);
-  ch = {0.76953125f, 0.6015625f, 0.01171875f, 0.00390625f, -1.0f, 23.0f, 5.0f};
-  atlas.charMap.emplace(160, ch);
-  ch = {0.59765625f, 0.86328125f, 0.03515625f, 0.0546875f, 0.0f, 5.0f, 9.0f};
-  atlas.charMap.emplace(167, ch);
-  ch = {0.1171875f, 1.0f, 0.0078125f, 0.0703125f, 4.0f, 5.0f, 10.0f};
-  atlas.charMap.emplace(166, ch);
-  ch = {0.12890625f, 0.69140625f, 0.0390625f, 0.05078125f, 0.0f, 6.0f, 10.0f};
-  atlas.charMap.emplace(165, ch);
-  ch = {0.05078125f, 0.58984375f, 0.0390625f, 0.02734375f, 0.0f, 9.0f, 10.0f};
-  atlas.charMap.emplace(164, ch);
-  ch = {0.21484375f, 0.59375f, 0.02734375f, 0.0234375f, 0.0f, 6.0f, 7.0f};
-  atlas.charMap.emplace(186, ch);
-  ch = {0.17578125f, 0.59375f, 0.03515625f, 0.02734375f, 0.0f, 11.0f, 9.0f};
-  atlas.charMap.emplace(187, ch);
-  ch = {0.42578125f, 0.59765625f, 0.01953125f, 0.015625f, 0.0f, 19.0f, 4.0f};
-  atlas.charMap.emplace(184, ch);
-  ch = {0.02734375f, 0.5859375f, 0.01953125f, 0.03125f, 0.0f, 6.0f, 6.0f};
-  atlas.charMap.emplace(185, ch);
-  ch = {0.203125f, 0.8046875f, 0.0625f, 0.05078125f, -1.0f, 6.0f, 14.0f};
-  atlas.charMap.emplace(190, ch);
-  ch = {0.6953125f, 0.6953125f, 0.03125f, 0.05078125f, 0.0f, 9.0f, 8.0f};
-  atlas.charMap.emplace(191, ch);
-  ch = {0.75f, 0.80859375f, 0.0546875f, 0.05078125f, 0.0f, 6.0f, 14.0f};
-  atlas.charMap.emplace(188, ch);
-  ch = {0.57421875f, 0.8046875f, 0.0546875f, 0.05078125f, 0.0f, 6.0f, 14.0f};
-  atlas.charMap.emplace(189, ch);
-  ch = {0.953125f, 0.65234375f, 0.0234375f, 0.03125f, 0.0f, 6.0f, 6.0f};
-  atlas.charMap.emplace(178, ch);
-  ch = {0.0f, 0.5859375f, 0.0234375f, 0.03125f, 0.0f, 6.0f, 6.0f};
-  atlas.charMap.emplace(179, ch);
-  ch = {0.359375f, 0.59765625f, 0.03125f, 0.01953125f, 0.0f, 6.0f, 8.0f};
-  atlas.charMap.emplace(176, ch);
-  ch = {0.0f, 0.6328125f, 0.0390625f, 0.04296875f, 0.0f, 8.0f, 10.0f};
-  atlas.charMap.emplace(177, ch);
-  ch = {0.4375f, 0.9296875f, 0.04296875f, 0.0625f, 0.0f, 5.0f, 12.0f};
-  atlas.charMap.emplace(182, ch);
-  ch = {0.59375f, 0.59765625f, 0.01171875f, 0.0078125f, 1.0f, 11.0f, 5.0f};
-  atlas.charMap.emplace(183, ch);
-  ch = {0.48828125f, 0.59765625f, 0.015625f, 0.01171875f, 3.0f, 5.0f, 10.0f};
-  atlas.charMap.emplace(180, ch);
-  ch = {0.83203125f, 0.8671875f, 0.03515625f, 0.0546875f, 1.0f, 9.0f, 11.0f};
-  atlas.charMap.emplace(181, ch);
-  ch = {0.9140625f, 1.0f, 0.01953125f, 0.06640625f, 1.0f, 2.0f, 5.0f};
-  atlas.charMap.emplace(205, ch);
-  ch = {0.9375f, 1.0f, 0.01953125f, 0.06640625f, -1.0f, 2.0f, 5.0f};
-  atlas.charMap.emplace(204, ch);
-  ch = {0.515625f, 0.9296875f, 0.02734375f, 0.0625f, -1.0f, 3.0f, 5.0f};
-  atlas.charMap.emplace(207, ch);
-  ch = {0.8828125f, 1.0f, 0.02734375f, 0.06640625f, -1.0f, 2.0f, 5.0f};
-  atlas.charMap.emplace(206, ch);
-  ch = {0.8046875f, 1.0f, 0.03515625f, 0.06640625f, 1.0f, 2.0f, 10.0f};
-  atlas.charMap.emplace(201, ch);
-  ch = {0.765625f, 1.0f, 0.03515625f, 0.06640625f, 1.0f, 2.0f, 10.0f};
-  atlas.charMap.emplace(200, ch);
-  ch = {0.9609375f, 1.0f, 0.03515625f, 0.0625f, 1.0f, 3.0f, 10.0f};
-  atlas.charMap.emplace(203, ch);
-  ch = {0.84375f, 1.0f, 0.03515625f, 0.06640625f, 1.0f, 2.0f, 10.0f};
-  atlas.charMap.emplace(202, ch);
-  ch = {0.28515625f, 0.9296875f, 0.05078125f, 0.0625f, -1.0f, 3.0f, 11.0f};
-  atlas.charMap.emplace(197, ch);
-  ch = {0.17578125f, 0.9296875f, 0.05078125f, 0.0625f, -1.0f, 3.0f, 11.0f};
-  atlas.charMap.emplace(196, ch);
-  ch = {0.71875f, 1.0f, 0.04296875f, 0.06640625f, 0.0f, 6.0f, 11.0f};
-  atlas.charMap.emplace(199, ch);
-  ch = {0.0625f, 0.80078125f, 0.06640625f, 0.05078125f, -1.0f, 6.0f, 15.0f};
-  atlas.charMap.emplace(198, ch);
-  ch = {0.37109375f, 1.0f, 0.05078125f, 0.06640625f, -1.0f, 2.0f, 11.0f};
-  atlas.charMap.emplace(193, ch);
-  ch = {0.42578125f, 1.0f, 0.05078125f, 0.06640625f, -1.0f, 2.0f, 11.0f};
-  atlas.charMap.emplace(192, ch);
-  ch = {0.23046875f, 0.9296875f, 0.05078125f, 0.0625f, -1.0f, 3.0f, 11.0f};
-  atlas.charMap.emplace(195, ch);
-  ch = {0.31640625f, 1.0f, 0.05078125f, 0.06640625f, -1.0f, 2.0f, 11.0f};
-  atlas.charMap.emplace(194, ch);
-  ch = {0.390625f, 0.9296875f, 0.04296875f, 0.0625f, 1.0f, 3.0f, 13.0f};
-  atlas.charMap.emplace(220, ch);
-  ch = {0.48046875f, 1.0f, 0.046875f, 0.06640625f, -1.0f, 2.0f, 10.0f};
-  atlas.charMap.emplace(221, ch);
-  ch = {0.171875f, 0.69140625f, 0.0390625f, 0.05078125f, 1.0f, 6.0f, 11.0f};
-  atlas.charMap.emplace(222, ch);
-  ch = {0.13671875f, 0.859375f, 0.0390625f, 0.0546875f, 1.0f, 5.0f, 11.0f};
-  atlas.charMap.emplace(223, ch);
-  ch = {0.6328125f, 0.8046875f, 0.0546875f, 0.05078125f, 0.0f, 6.0f, 14.0f};
-  atlas.charMap.emplace(216, ch);
-  ch = {0.671875f, 1.0f, 0.04296875f, 0.06640625f, 1.0f, 2.0f, 13.0f};
-  atlas.charMap.emplace(217, ch);
-  ch = {0.625f, 1.0f, 0.04296875f, 0.06640625f, 1.0f, 2.0f, 13.0f};
-  atlas.charMap.emplace(218, ch);
-  ch = {0.578125f, 1.0f, 0.04296875f, 0.06640625f, 1.0f, 2.0f, 13.0f};
-  atlas.charMap.emplace(219, ch);
-  ch = {0.140625f, 1.0f, 0.0546875f, 0.06640625f, 0.0f, 2.0f, 14.0f};
-  atlas.charMap.emplace(212, ch);
-  ch = {0.05859375f, 0.92578125f, 0.0546875f, 0.0625f, 0.0f, 3.0f, 14.0f};
-  atlas.charMap.emplace(213, ch);
-  ch = {0.1171875f, 0.92578125f, 0.0546875f, 0.0625f, 0.0f, 3.0f, 14.0f};
-  atlas.charMap.emplace(214, ch);
-  ch = {0.09375f, 0.58984375f, 0.0390625f, 0.02734375f, 0.0f, 9.0f, 10.0f};
-  atlas.charMap.emplace(215, ch);
-  ch = {0.80859375f, 0.80859375f, 0.05078125f, 0.05078125f, 0.0f, 6.0f, 13.0f};
-  atlas.charMap.emplace(208, ch);
-  ch = {0.33984375f, 0.9296875f, 0.046875f, 0.0625f, 1.0f, 3.0f, 13.0f};
-  atlas.charMap.emplace(209, ch);
-  ch = {0.19921875f, 1.0f, 0.0546875f, 0.06640625f, 0.0f, 2.0f, 14.0f};
-  atlas.charMap.emplace(210, ch);
-  ch = {0.2578125f, 1.0f, 0.0546875f, 0.06640625f, 0.0f, 2.0f, 14.0f};
-  atlas.charMap.emplace(211, ch);
-  ch = {0.83203125f, 0.69921875f, 0.02734375f, 0.05078125f, -1.0f, 6.0f, 4.0f};
-  atlas.charMap.emplace(239, ch);
-  ch = {0.91015625f, 0.87109375f, 0.03125f, 0.0546875f, -1.0f, 5.0f, 4.0f};
-  atlas.charMap.emplace(238, ch);
-  ch = {0.0f, 0.80078125f, 0.01953125f, 0.0546875f, 1.0f, 5.0f, 4.0f};
-  atlas.charMap.emplace(237, ch);
-  ch = {0.0234375f, 0.80078125f, 0.01953125f, 0.0546875f, -1.0f, 5.0f, 4.0f};
-  atlas.charMap.emplace(236, ch);
-  ch = {0.7265625f, 0.75f, 0.0390625f, 0.05078125f, 0.0f, 6.0f, 10.0f};
-  atlas.charMap.emplace(235, ch);
-  ch = {0.1796875f, 0.86328125f, 0.0390625f, 0.0546875f, 0.0f, 5.0f, 10.0f};
-  atlas.charMap.emplace(234, ch);
-  ch = {0.09375f, 0.859375f, 0.0390625f, 0.0546875f, 0.0f, 5.0f, 10.0f};
-  atlas.charMap.emplace(233, ch);
-  ch = {0.22265625f, 0.86328125f, 0.0390625f, 0.0546875f, 0.0f, 5.0f, 10.0f};
-  atlas.charMap.emplace(232, ch);
-  ch = {0.55859375f, 0.86328125f, 0.03515625f, 0.0546875f, 0.0f, 9.0f, 8.0f};
-  atlas.charMap.emplace(231, ch);
-  ch = {0.04296875f, 0.6328125f, 0.05859375f, 0.0390625f, 0.0f, 9.0f, 15.0f};
-  atlas.charMap.emplace(230, ch);
-  ch = {0.80859375f, 0.9296875f, 0.03515625f, 0.05859375f, 0.0f, 4.0f, 10.0f};
-  atlas.charMap.emplace(229, ch);
-  ch = {0.5859375f, 0.6953125f, 0.03515625f, 0.05078125f, 0.0f, 6.0f, 10.0f};
-  atlas.charMap.emplace(228, ch);
-  ch = {0.46875f, 0.6953125f, 0.03515625f, 0.05078125f, 0.0f, 6.0f, 10.0f};
-  atlas.charMap.emplace(227, ch);
-  ch = {0.63671875f, 0.86328125f, 0.03515625f, 0.0546875f, 0.0f, 5.0f, 10.0f};
-  atlas.charMap.emplace(226, ch);
-  ch = {0.51953125f, 0.86328125f, 0.03515625f, 0.0546875f, 0.0f, 5.0f, 10.0f};
-  atlas.charMap.emplace(225, ch);
-  ch = {0.48046875f, 0.86328125f, 0.03515625f, 0.0546875f, 0.0f, 5.0f, 10.0f};
-  atlas.charMap.emplace(224, ch);
-  ch = {0.046875f, 1.0f, 0.0390625f, 0.0703125f, 1.0f, 5.0f, 11.0f};
-  atlas.charMap.emplace(254, ch);
-  ch = {0.53125f, 1.0f, 0.04296875f, 0.06640625f, -1.0f, 6.0f, 9.0f};
-  atlas.charMap.emplace(255, ch);
-  ch = {0.4296875f, 0.6953125f, 0.03515625f, 0.05078125f, 1.0f, 6.0f, 11.0f};
-  atlas.charMap.emplace(252, ch);
-  ch = {0.0f, 1.0f, 0.04296875f, 0.0703125f, -1.0f, 5.0f, 9.0f};
-  atlas.charMap.emplace(253, ch);
-  ch = {0.71484375f, 0.8671875f, 0.03515625f, 0.0546875f, 1.0f, 5.0f, 11.0f};
-  atlas.charMap.emplace(250, ch);
-  ch = {0.67578125f, 0.86328125f, 0.03515625f, 0.0546875f, 1.0f, 5.0f, 11.0f};
-  atlas.charMap.emplace(251, ch);
-  ch = {0.2734375f, 0.640625f, 0.04296875f, 0.0390625f, 0.0f, 9.0f, 11.0f};
-  atlas.charMap.emplace(248, ch);
-  ch = {0.75390625f, 0.8671875f, 0.03515625f, 0.0546875f, 1.0f, 5.0f, 11.0f};
-  atlas.charMap.emplace(249, ch);
-  ch = {0.54296875f, 0.75f, 0.04296875f, 0.05078125f, 0.0f, 6.0f, 11.0f};
-  atlas.charMap.emplace(246, ch);
-  ch = {0.6953125f, 0.640625f, 0.0390625f, 0.03515625f, 0.0f, 8.0f, 10.0f};
-  atlas.charMap.emplace(247, ch);
-  ch = {0.89453125f, 0.9296875f, 0.04296875f, 0.0546875f, 0.0f, 5.0f, 11.0f};
-  atlas.charMap.emplace(244, ch);
-  ch = {0.49609375f, 0.75f, 0.04296875f, 0.05078125f, 0.0f, 6.0f, 11.0f};
-  atlas.charMap.emplace(245, ch);
-  ch = {0.0f, 0.859375f, 0.04296875f, 0.0546875f, 0.0f, 5.0f, 11.0f};
-  atlas.charMap.emplace(242, ch);
-  ch = {0.84765625f, 0.9296875f, 0.04296875f, 0.0546875f, 0.0f, 5.0f, 11.0f};
-  atlas.charMap.emplace(243, ch);
-  ch = {0.046875f, 0.859375f, 0.04296875f, 0.0546875f, 0.0f, 5.0f, 11.0f};
-  atlas.charMap.emplace(240, ch);
-  ch = {0.5078125f, 0.6953125f, 0.03515625f, 0.05078125f, 1.0f, 6.0f, 11.0f};
-  atlas.charMap.emplace(241, ch);
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
-  return atlas;
+// Drawn in place of characters the atlas doesn't contain ('?')
+static constexpr TextureChar MISSING_GLYPH =
+  {0.765625f, 0.6953125f, 0.03125f, 0.05078125f, 0.0f, 6.0f, 8.0f};
+
+// Glyph metrics for the font texture, indexed by code point. Texture
+// coordinates are normalized to the 256x256 texture, offsets and advances
+// are in pixels.
+static constexpr TextureChar GLYPHS[NUM_DIRECT_GLYPHS] = {
+  MISSING_GLYPH,  // 0
+  MISSING_GLYPH,  // 1
+  MISSING_GLYPH,  // 2
+  MISSING_GLYPH,  // 3
+  MISSING_GLYPH,  // 4
+  MISSING_GLYPH,  // 5
+  MISSING_GLYPH,  // 6
+  MISSING_GLYPH,  // 7
+  MISSING_GLYPH,  // 8
+  MISSING_GLYPH,  // 9
+  MISSING_GLYPH,  // 10
+  MISSING_GLYPH,  // 11
+  MISSING_GLYPH,  // 12
+  MISSING_GLYPH,  // 13
+  MISSING_GLYPH,  // 14
+  MISSING_GLYPH,  // 15
+  MISSING_GLYPH,  // 16
+  MISSING_GLYPH,  // 17
+  MISSING_GLYPH,  // 18
+  MISSING_GLYPH,  // 19
+  MISSING_GLYPH,  // 20
+  MISSING_GLYPH,  // 21
+  MISSING_GLYPH,  // 22
+  MISSING_GLYPH,  // 23
+  MISSING_GLYPH,  // 24
+  MISSING_GLYPH,  // 25
+  MISSING_GLYPH,  // 26
+  MISSING_GLYPH,  // 27
+  MISSING_GLYPH,  // 28
+  MISSING_GLYPH,  // 29
+  MISSING_GLYPH,  // 30
+  MISSING_GLYPH,  // 31
+  {0.75390625f, 0.6015625f, 0.01171875f, 0.00390625f, -1.0f, 23.0f, 5.0f},  // 32
+  {0.91015625f, 0.69921875f, 0.01171875f, 0.05078125f, 1.0f, 6.0f, 5.0f},  // 33
+  {0.39453125f, 0.59765625f, 0.02734375f, 0.01953125f, 0.0f, 6.0f, 7.0f},  // 34
+  {0.0f, 0.7421875f, 0.046875f, 0.05078125f, 0.0f, 6.0f, 11.0f},  // 35
+  {0.765625f, 0.9296875f, 0.0390625f, 0.05859375f, 0.0f, 5.0f, 10.0f},  // 36
+  {0.39453125f, 0.8046875f, 0.05859375f, 0.05078125f, 0.0f, 6.0f, 15.0f},  // 37
+  {0.69140625f, 0.8046875f, 0.0546875f, 0.05078125f, 0.0f, 6.0f, 13.0f},  // 38
+  {0.98046875f, 0.66015625f, 0.015625f, 0.01953125f, 0.0f, 6.0f, 4.0f},  // 39
+  {0.65234375f, 0.9296875f, 0.01953125f, 0.0625f, 0.0f, 6.0f, 5.0f},  // 40
+  {0.60546875f, 0.9296875f, 0.01953125f, 0.0625f, 0.0f, 6.0f, 5.0f},  // 41
+  {0.8671875f, 0.64453125f, 0.0390625f, 0.03125f, 0.0f, 5.0f, 10.0f},  // 42
+  {0.73828125f, 0.640625f, 0.0390625f, 0.03515625f, 0.0f, 8.0f, 10.0f},  // 43
+  {0.44921875f, 0.59765625f, 0.015625f, 0.015625f, 0.0f, 17.0f, 4.0f},  // 44
+  {0.69921875f, 0.6015625f, 0.0234375f, 0.00390625f, 0.0f, 13.0f, 6.0f},  // 45
+  {0.578125f, 0.59765625f, 0.01171875f, 0.0078125f, 1.0f, 17.0f, 5.0f},  // 46
+  {0.86328125f, 0.69921875f, 0.02734375f, 0.05078125f, 0.0f, 6.0f, 6.0f},  // 47
+  {0.21484375f, 0.6953125f, 0.0390625f, 0.05078125f, 0.0f, 6.0f, 10.0f},  // 48
+  {0.97265625f, 0.8125f, 0.0234375f, 0.05078125f, 1.0f, 6.0f, 10.0f},  // 49
+  {0.2578125f, 0.6953125f, 0.0390625f, 0.05078125f, 0.0f, 6.0f, 10.0f},  // 50
+  {0.30078125f, 0.6953125f, 0.0390625f, 0.05078125f, 0.0f, 6.0f, 10.0f},  // 51
+  {0.34375f, 0.6953125f, 0.0390625f, 0.05078125f, 0.0f, 6.0f, 10.0f},  // 52
+  {0.38671875f, 0.6953125f, 0.0390625f, 0.05078125f, 0.0f, 6.0f, 10.0f},  // 53
+  {0.68359375f, 0.75f, 0.0390625f, 0.05078125f, 0.0f, 6.0f, 10.0f},  // 54
+  {0.04296875f, 0.6875f, 0.0390625f, 0.05078125f, 0.0f, 6.0f, 10.0f},  // 55
+  {0.76953125f, 0.75390625f, 0.0390625f, 0.05078125f, 0.0f, 6.0f, 10.0f},  // 56
+  {0.8125f, 0.75390625f, 0.0390625f, 0.05078125f, 0.0f, 6.0f, 10.0f},  // 57
+  {0.6796875f, 0.640625f, 0.01171875f, 0.0390625f, 1.0f, 9.0f, 5.0f},  // 58
+  {0.953125f, 0.703125f, 0.015625f, 0.046875f, 0.0f, 9.0f, 5.0f},  // 59
+  {0.82421875f, 0.64453125f, 0.0390625f, 0.03515625f, 0.0f, 8.0f, 10.0f},  // 60
+  {0.31640625f, 0.59765625f, 0.0390625f, 0.01953125f, 0.0f, 10.0f, 10.0f},  // 61
+  {0.78125f, 0.640625f, 0.0390625f, 0.03515625f, 0.0f, 8.0f, 10.0f},  // 62
+  {0.765625f, 0.6953125f, 0.03125f, 0.05078125f, 0.0f, 6.0f, 8.0f},  // 63
+  {0.69921875f, 0.9296875f, 0.0625f, 0.05859375f, 0.0f, 6.0f, 16.0f},  // 64
+  {0.86328125f, 0.80859375f, 0.05078125f, 0.05078125f, -1.0f, 6.0f, 11.0f},  // 65
+  {0.63671875f, 0.75f, 0.04296875f, 0.05078125f, 1.0f, 6.0f, 11.0f},  // 66
+  {0.58984375f, 0.75f, 0.04296875f, 0.05078125f, 0.0f, 6.0f, 11.0f},  // 67
+  {0.05078125f, 0.7421875f, 0.046875f, 0.05078125f, 1.0f, 6.0f, 13.0f},  // 68
+  {0.546875f, 0.6953125f, 0.03515625f, 0.05078125f, 1.0f, 6.0f, 10.0f},  // 69
+  {0.625f, 0.6953125f, 0.03125f, 0.05078125f, 1.0f, 6.0f, 9.0f},  // 70
+  {0.3046875f, 0.75f, 0.046875f, 0.05078125f, 0.0f, 6.0f, 13.0f},  // 71
+  {0.40234375f, 0.75f, 0.04296875f, 0.05078125f, 1.0f, 6.0f, 13.0f},  // 72
+  {0.89453125f, 0.69921875f, 0.01171875f, 0.05078125f, 1.0f, 6.0f, 5.0f},  // 73
+  {0.578125f, 0.9296875f, 0.0234375f, 0.0625f, -2.0f, 6.0f, 5.0f},  // 74
+  {0.35546875f, 0.75f, 0.04296875f, 0.05078125f, 1.0f, 6.0f, 11.0f},  // 75
+  {0.66015625f, 0.6953125f, 0.03125f, 0.05078125f, 1.0f, 6.0f, 9.0f},  // 76
+  {0.515625f, 0.8046875f, 0.0546875f, 0.05078125f, 1.0f, 6.0f, 16.0f},  // 77
+  {0.25390625f, 0.75f, 0.046875f, 0.05078125f, 1.0f, 6.0f, 13.0f},  // 78
+  {0.45703125f, 0.8046875f, 0.0546875f, 0.05078125f, 0.0f, 6.0f, 14.0f},  // 79
+  {0.85546875f, 0.75390625f, 0.0390625f, 0.05078125f, 1.0f, 6.0f, 11.0f},  // 80
+  {0.0f, 0.92578125f, 0.0546875f, 0.0625f, 0.0f, 6.0f, 14.0f},  // 81
+  {0.8984375f, 0.75390625f, 0.0390625f, 0.05078125f, 1.0f, 6.0f, 11.0f},  // 82
+  {0.94140625f, 0.7578125f, 0.0390625f, 0.05078125f, 0.0f, 6.0f, 10.0f},  // 83
+  {0.1015625f, 0.74609375f, 0.046875f, 0.05078125f, -1.0f, 6.0f, 10.0f},  // 84
+  {0.44921875f, 0.75f, 0.04296875f, 0.05078125f, 1.0f, 6.0f, 13.0f},  // 85
+  {0.91796875f, 0.8125f, 0.05078125f, 0.05078125f, -1.0f, 6.0f, 10.0f},  // 86
+  {0.1328125f, 0.80078125f, 0.06640625f, 0.05078125f, 0.0f, 6.0f, 16.0f},  // 87
+  {0.15234375f, 0.74609375f, 0.046875f, 0.05078125f, -1.0f, 6.0f, 10.0f},  // 88
+  {0.203125f, 0.75f, 0.046875f, 0.05078125f, -1.0f, 6.0f, 10.0f},  // 89
+  {0.0f, 0.6875f, 0.0390625f, 0.05078125f, 0.0f, 6.0f, 10.0f},  // 90
+  {0.67578125f, 0.9296875f, 0.01953125f, 0.0625f, 1.0f, 6.0f, 6.0f},  // 91
+  {0.80078125f, 0.69921875f, 0.02734375f, 0.05078125f, 0.0f, 6.0f, 6.0f},  // 92
+  {0.62890625f, 0.9296875f, 0.01953125f, 0.0625f, 0.0f, 6.0f, 6.0f},  // 93
+  {0.91015625f, 0.64453125f, 0.0390625f, 0.03125f, 0.0f, 6.0f, 10.0f},  // 94
+  {0.65625f, 0.59765625f, 0.0390625f, 0.00390625f, -1.0f, 21.0f, 8.0f},  // 95
+  {0.46875f, 0.59765625f, 0.015625f, 0.01171875f, 3.0f, 5.0f, 10.0f},  // 96
+  {0.44921875f, 0.640625f, 0.03515625f, 0.0390625f, 0.0f, 9.0f, 10.0f},  // 97
+  {0.265625f, 0.86328125f, 0.0390625f, 0.0546875f, 1.0f, 5.0f, 11.0f},  // 98
+  {0.48828125f, 0.640625f, 0.03515625f, 0.0390625f, 0.0f, 9.0f, 8.0f},  // 99
+  {0.30859375f, 0.86328125f, 0.0390625f, 0.0546875f, 0.0f, 5.0f, 11.0f},  // 100
+  {0.3671875f, 0.640625f, 0.0390625f, 0.0390625f, 0.0f, 9.0f, 10.0f},  // 101
+  {0.79296875f, 0.8671875f, 0.03515625f, 0.0546875f, -1.0f, 5.0f, 6.0f},  // 102
+  {0.3515625f, 0.86328125f, 0.0390625f, 0.0546875f, 0.0f, 9.0f, 10.0f},  // 103
+  {0.87109375f, 0.87109375f, 0.03515625f, 0.0546875f, 1.0f, 5.0f, 11.0f},  // 104
+  {0.046875f, 0.80078125f, 0.01171875f, 0.0546875f, 1.0f, 5.0f, 4.0f},  // 105
+  {0.08984375f, 1.0f, 0.0234375f, 0.0703125f, -2.0f, 5.0f, 4.0f},  // 106
+  {0.9453125f, 0.87109375f, 0.03125f, 0.0546875f, 1.0f, 5.0f, 9.0f},  // 107
+  {0.98046875f, 0.87109375f, 0.01171875f, 0.0546875f, 1.0f, 5.0f, 4.0f},  // 108
+  {0.10546875f, 0.6328125f, 0.05859375f, 0.0390625f, 1.0f, 9.0f, 16.0f},  // 109
+  {0.56640625f, 0.640625f, 0.03515625f, 0.0390625f, 1.0f, 9.0f, 11.0f},  // 110
+  {0.2265625f, 0.640625f, 0.04296875f, 0.0390625f, 0.0f, 9.0f, 11.0f},  // 111
+  {0.39453125f, 0.86328125f, 0.0390625f, 0.0546875f, 1.0f, 9.0f, 11.0f},  // 112
+  {0.4375f, 0.86328125f, 0.0390625f, 0.0546875f, 0.0f, 9.0f, 11.0f},  // 113
+  {0.97265625f, 0.703125f, 0.0234375f, 0.0390625f, 1.0f, 9.0f, 7.0f},  // 114
+  {0.41015625f, 0.640625f, 0.03515625f, 0.0390625f, 0.0f, 9.0f, 8.0f},  // 115
+  {0.92578125f, 0.69921875f, 0.0234375f, 0.046875f, 0.0f, 7.0f, 6.0f},  // 116
+  {0.60546875f, 0.640625f, 0.03515625f, 0.0390625f, 1.0f, 9.0f, 11.0f},  // 117
+  {0.3203125f, 0.640625f, 0.04296875f, 0.0390625f, -1.0f, 9.0f, 9.0f},  // 118
+  {0.16796875f, 0.63671875f, 0.0546875f, 0.0390625f, 0.0f, 9.0f, 14.0f},  // 119
+  {0.52734375f, 0.640625f, 0.03515625f, 0.0390625f, 0.0f, 9.0f, 9.0f},  // 120
+  {0.94140625f, 0.9296875f, 0.04296875f, 0.0546875f, -1.0f, 9.0f, 9.0f},  // 121
+  {0.64453125f, 0.640625f, 0.03125f, 0.0390625f, 0.0f, 9.0f, 8.0f},  // 122
+  {0.484375f, 0.9296875f, 0.02734375f, 0.0625f, 0.0f, 6.0f, 7.0f},  // 123
+  {0.12890625f, 1.0f, 0.0078125f, 0.0703125f, 4.0f, 5.0f, 10.0f},  // 124
+  {0.546875f, 0.9296875f, 0.02734375f, 0.0625f, 0.0f, 6.0f, 7.0f},  // 125
+  {0.5078125f, 0.59765625f, 0.0390625f, 0.0078125f, 0.0f, 12.0f, 10.0f},  // 126
+  MISSING_GLYPH,  // 127
+  MISSING_GLYPH,  // 128
+  MISSING_GLYPH,  // 129
+  MISSING_GLYPH,  // 130
+  MISSING_GLYPH,  // 131
+  MISSING_GLYPH,  // 132
+  MISSING_GLYPH,  // 133
+  MISSING_GLYPH,  // 134
+  MISSING_GLYPH,  // 135
+  MISSING_GLYPH,  // 136
+  MISSING_GLYPH,  // 137
+  MISSING_GLYPH,  // 138
+  MISSING_GLYPH,  // 139
+  MISSING_GLYPH,  // 140
+  MISSING_GLYPH,  // 141
+  MISSING_GLYPH,  // 142
+  MISSING_GLYPH,  // 143
+  MISSING_GLYPH,  // 144
+  MISSING_GLYPH,  // 145
+  MISSING_GLYPH,  // 146
+  MISSING_GLYPH,  // 147
+  MISSING_GLYPH,  // 148
+  MISSING_GLYPH,  // 149
+  MISSING_GLYPH,  // 150
+  MISSING_GLYPH,  // 151
+  MISSING_GLYPH,  // 152
+  MISSING_GLYPH,  // 153
+  MISSING_GLYPH,  // 154
+  MISSING_GLYPH,  // 155
+  MISSING_GLYPH,  // 156
+  MISSING_GLYPH,  // 157
+  MISSING_GLYPH,  // 158
+  MISSING_GLYPH,  // 159
+  {0.76953125f, 0.6015625f, 0.01171875f, 0.00390625f, -1.0f, 23.0f, 5.0f},  // 160
+  {0.984375f, 0.7578125f, 0.01171875f, 0.05078125f, 1.0f, 9.0f, 5.0f},  // 161
+  {0.73046875f, 0.6953125f, 0.03125f, 0.05078125f, 1.0f, 6.0f, 10.0f},  // 162
+  {0.0859375f, 0.6875f, 0.0390625f, 0.05078125f, 0.0f, 6.0f, 10.0f},  // 163
+  {0.05078125f, 0.58984375f, 0.0390625f, 0.02734375f, 0.0f, 9.0f, 10.0f},  // 164
+  {0.12890625f, 0.69140625f, 0.0390625f, 0.05078125f, 0.0f, 6.0f, 10.0f},  // 165
+  {0.1171875f, 1.0f, 0.0078125f, 0.0703125f, 4.0f, 5.0f, 10.0f},  // 166
+  {0.59765625f, 0.86328125f, 0.03515625f, 0.0546875f, 0.0f, 5.0f, 9.0f},  // 167
+  {0.55078125f, 0.59765625f, 0.0234375f, 0.0078125f, 2.0f, 6.0f, 10.0f},  // 168
+  {0.26953125f, 0.8046875f, 0.05859375f, 0.05078125f, 0.0f, 6.0f, 15.0f},  // 169
+  {0.24609375f, 0.59765625f, 0.0234375f, 0.0234375f, 0.0f, 6.0f, 6.0f},  // 170
+  {0.13671875f, 0.58984375f, 0.03515625f, 0.02734375f, 0.0f, 11.0f, 9.0f},  // 171
+  {0.2734375f, 0.59765625f, 0.0390625f, 0.01953125f, 0.0f, 12.0f, 10.0f},  // 172
+  {0.7265625f, 0.6015625f, 0.0234375f, 0.00390625f, 0.0f, 13.0f, 6.0f},  // 173
+  {0.33203125f, 0.8046875f, 0.05859375f, 0.05078125f, 0.0f, 6.0f, 15.0f},  // 174
+  {0.609375f, 0.59765625f, 0.04296875f, 0.00390625f, -1.0f, 4.0f, 9.0f},  // 175
+  {0.359375f, 0.59765625f, 0.03125f, 0.01953125f, 0.0f, 6.0f, 8.0f},  // 176
+  {0.0f, 0.6328125f, 0.0390625f, 0.04296875f, 0.0f, 8.0f, 10.0f},  // 177
+  {0.953125f, 0.65234375f, 0.0234375f, 0.03125f, 0.0f, 6.0f, 6.0f},  // 178
+  {0.0f, 0.5859375f, 0.0234375f, 0.03125f, 0.0f, 6.0f, 6.0f},  // 179
+  {0.48828125f, 0.59765625f, 0.015625f, 0.01171875f, 3.0f, 5.0f, 10.0f},  // 180
+  {0.83203125f, 0.8671875f, 0.03515625f, 0.0546875f, 1.0f, 9.0f, 11.0f},  // 181
+  {0.4375f, 0.9296875f, 0.04296875f, 0.0625f, 0.0f, 5.0f, 12.0f},  // 182
+  {0.59375f, 0.59765625f, 0.01171875f, 0.0078125f, 1.0f, 11.0f, 5.0f},  // 183
+  {0.42578125f, 0.59765625f, 0.01953125f, 0.015625f, 0.0f, 19.0f, 4.0f},  // 184
+  {0.02734375f, 0.5859375f, 0.01953125f, 0.03125f, 0.0f, 6.0f, 6.0f},  // 185
+  {0.21484375f, 0.59375f, 0.02734375f, 0.0234375f, 0.0f, 6.0f, 7.0f},  // 186
+  {0.17578125f, 0.59375f, 0.03515625f, 0.02734375f, 0.0f, 11.0f, 9.0f},  // 187
+  {0.75f, 0.80859375f, 0.0546875f, 0.05078125f, 0.0f, 6.0f, 14.0f},  // 188
+  {0.57421875f, 0.8046875f, 0.0546875f, 0.05078125f, 0.0f, 6.0f, 14.0f},  // 189
+  {0.203125f, 0.8046875f, 0.0625f, 0.05078125f, -1.0f, 6.0f, 14.0f},  // 190
+  {0.6953125f, 0.6953125f, 0.03125f, 0.05078125f, 0.0f, 9.0f, 8.0f},  // 191
+  {0.42578125f, 1.0f, 0.05078125f, 0.06640625f, -1.0f, 2.0f, 11.0f},  // 192
+  {0.37109375f, 1.0f, 0.05078125f, 0.06640625f, -1.0f, 2.0f, 11.0f},  // 193
+  {0.31640625f, 1.0f, 0.05078125f, 0.06640625f, -1.0f, 2.0f, 11.0f},  // 194
+  {0.23046875f, 0.9296875f, 0.05078125f, 0.0625f, -1.0f, 3.0f, 11.0f},  // 195
+  {0.17578125f, 0.9296875f, 0.05078125f, 0.0625f, -1.0f, 3.0f, 11.0f},  // 196
+  {0.28515625f, 0.9296875f, 0.05078125f, 0.0625f, -1.0f, 3.0f, 11.0f},  // 197
+  {0.0625f, 0.80078125f, 0.06640625f, 0.05078125f, -1.0f, 6.0f, 15.0f},  // 198
+  {0.71875f, 1.0f, 0.04296875f, 0.06640625f, 0.0f, 6.0f, 11.0f},  // 199
+  {0.765625f, 1.0f, 0.03515625f, 0.06640625f, 1.0f, 2.0f, 10.0f},  // 200
+  {0.8046875f, 1.0f, 0.03515625f, 0.06640625f, 1.0f, 2.0f, 10.0f},  // 201
+  {0.84375f, 1.0f, 0.03515625f, 0.06640625f, 1.0f, 2.0f, 10.0f},  // 202
+  {0.9609375f, 1.0f, 0.03515625f, 0.0625f, 1.0f, 3.0f, 10.0f},  // 203
+  {0.9375f, 1.0f, 0.01953125f, 0.06640625f, -1.0f, 2.0f, 5.0f},  // 204
+  {0.9140625f, 1.0f, 0.01953125f, 0.06640625f, 1.0f, 2.0f, 5.0f},  // 205
+  {0.8828125f, 1.0f, 0.02734375f, 0.06640625f, -1.0f, 2.0f, 5.0f},  // 206
+  {0.515625f, 0.9296875f, 0.02734375f, 0.0625f, -1.0f, 3.0f, 5.0f},  // 207
+  {0.80859375f, 0.80859375f, 0.05078125f, 0.05078125f, 0.0f, 6.0f, 13.0f},  // 208
+  {0.33984375f, 0.9296875f, 0.046875f, 0.0625f, 1.0f, 3.0f, 13.0f},  // 209
+  {0.19921875f, 1.0f, 0.0546875f, 0.06640625f, 0.0f, 2.0f, 14.0f},  // 210
+  {0.2578125f, 1.0f, 0.0546875f, 0.06640625f, 0.0f, 2.0f, 14.0f},  // 211
+  {0.140625f, 1.0f, 0.0546875f, 0.06640625f, 0.0f, 2.0f, 14.0f},  // 212
+  {0.05859375f, 0.92578125f, 0.0546875f, 0.0625f, 0.0f, 3.0f, 14.0f},  // 213
+  {0.1171875f, 0.92578125f, 0.0546875f, 0.0625f, 0.0f, 3.0f, 14.0f},  // 214
+  {0.09375f, 0.58984375f, 0.0390625f, 0.02734375f, 0.0f, 9.0f, 10.0f},  // 215
+  {0.6328125f, 0.8046875f, 0.0546875f, 0.05078125f, 0.0f, 6.0f, 14.0f},  // 216
+  {0.671875f, 1.0f, 0.04296875f, 0.06640625f, 1.0f, 2.0f, 13.0f},  // 217
+  {0.625f, 1.0f, 0.04296875f, 0.06640625f, 1.0f, 2.0f, 13.0f},  // 218
+  {0.578125f, 1.0f, 0.04296875f, 0.06640625f, 1.0f, 2.0f, 13.0f},  // 219
+  {0.390625f, 0.9296875f, 0.04296875f, 0.0625f, 1.0f, 3.0f, 13.0f},  // 220
+  {0.48046875f, 1.0f, 0.046875f, 0.06640625f, -1.0f, 2.0f, 10.0f},  // 221
+  {0.171875f, 0.69140625f, 0.0390625f, 0.05078125f, 1.0f, 6.0f, 11.0f},  // 222
+  {0.13671875f, 0.859375f, 0.0390625f, 0.0546875f, 1.0f, 5.0f, 11.0f},  // 223
+  {0.48046875f, 0.86328125f, 0.03515625f, 0.0546875f, 0.0f, 5.0f, 10.0f},  // 224
+  {0.51953125f, 0.86328125f, 0.03515625f, 0.0546875f, 0.0f, 5.0f, 10.0f},  // 225
+  {0.63671875f, 0.86328125f, 0.03515625f, 0.0546875f, 0.0f, 5.0f, 10.0f},  // 226
+  {0.46875f, 0.6953125f, 0.03515625f, 0.05078125f, 0.0f, 6.0f, 10.0f},  // 227
+  {0.5859375f, 0.6953125f, 0.03515625f, 0.05078125f, 0.0f, 6.0f, 10.0f},  // 228
+  {0.80859375f, 0.9296875f, 0.03515625f, 0.05859375f, 0.0f, 4.0f, 10.0f},  // 229
+  {0.04296875f, 0.6328125f, 0.05859375f, 0.0390625f, 0.0f, 9.0f, 15.0f},  // 230
+  {0.55859375f, 0.86328125f, 0.03515625f, 0.0546875f, 0.0f, 9.0f, 8.0f},  // 231
+  {0.22265625f, 0.86328125f, 0.0390625f, 0.0546875f, 0.0f, 5.0f, 10.0f},  // 232
+  {0.09375f, 0.859375f, 0.0390625f, 0.0546875f, 0.0f, 5.0f, 10.0f},  // 233
+  {0.1796875f, 0.86328125f, 0.0390625f, 0.0546875f, 0.0f, 5.0f, 10.0f},  // 234
+  {0.7265625f, 0.75f, 0.0390625f, 0.05078125f, 0.0f, 6.0f, 10.0f},  // 235
+  {0.0234375f, 0.80078125f, 0.01953125f, 0.0546875f, -1.0f, 5.0f, 4.0f},  // 236
+  {0.0f, 0.80078125f, 0.01953125f, 0.0546875f, 1.0f, 5.0f, 4.0f},  // 237
+  {0.91015625f, 0.87109375f, 0.03125f, 0.0546875f, -1.0f, 5.0f, 4.0f},  // 238
+  {0.83203125f, 0.69921875f, 0.02734375f, 0.05078125f, -1.0f, 6.0f, 4.0f},  // 239
+  {0.046875f, 0.859375f, 0.04296875f, 0.0546875f, 0.0f, 5.0f, 11.0f},  // 240
+  {0.5078125f, 0.6953125f, 0.03515625f, 0.05078125f, 1.0f, 6.0f, 11.0f},  // 241
+  {0.0f, 0.859375f, 0.04296875f, 0.0546875f, 0.0f, 5.0f, 11.0f},  // 242
+  {0.84765625f, 0.9296875f, 0.04296875f, 0.0546875f, 0.0f, 5.0f, 11.0f},  // 243
+  {0.89453125f, 0.9296875f, 0.04296875f, 0.0546875f, 0.0f, 5.0f, 11.0f},  // 244
+  {0.49609375f, 0.75f, 0.04296875f, 0.05078125f, 0.0f, 6.0f, 11.0f},  // 245
+  {0.54296875f, 0.75f, 0.04296875f, 0.05078125f, 0.0f, 6.0f, 11.0f},  // 246
+  {0.6953125f, 0.640625f, 0.0390625f, 0.03515625f, 0.0f, 8.0f, 10.0f},  // 247
+  {0.2734375f, 0.640625f, 0.04296875f, 0.0390625f, 0.0f, 9.0f, 11.0f},  // 248
+  {0.75390625f, 0.8671875f, 0.03515625f, 0.0546875f, 1.0f, 5.0f, 11.0f},  // 249
+  {0.71484375f, 0.8671875f, 0.03515625f, 0.0546875f, 1.0f, 5.0f, 11.0f},  // 250
+  {0.67578125f, 0.86328125f, 0.03515625f, 0.0546875f, 1.0f, 5.0f, 11.0f},  // 251
+  {0.4296875f, 0.6953125f, 0.03515625f, 0.05078125f, 1.0f, 6.0f, 11.0f},  // 252
+  {0.0f, 1.0f, 0.04296875f, 0.0703125f, -1.0f, 5.0f, 9.0f},  // 253
+  {0.046875f, 1.0f, 0.0390625f, 0.0703125f, 1.0f, 5.0f, 11.0f},  // 254
+  {0.53125f, 1.0f, 0.04296875f, 0.06640625f, -1.0f, 6.0f, 9.0f},  // 255
+};
+
+// The font has no glyphs beyond Latin-1, so the sparse table is empty
+static constexpr TextureAtlas FONT_ATLAS = {
+  24, 256, 256, GLYPHS, NULL, 0, &MISSING_GLYPH
+};
+
+static bool CompareGlyphCode(const SparseGlyph& glyph, unsigned int code) {
+  return glyph.code < code;
+}
+
+const TextureAtlas& TextUtils::GetAtlas() {
+  return FONT_ATLAS;
 }
 
-void TextUtils::GenerateVertices(std::string name, std::vector<GLfloat>& vertices,
-  float x, float y, float scale, TextureAtlas& atlas) {
+const TextureChar& TextUtils::SparseGlyphLookup(const TextureAtlas& atlas, unsigned int code) {
+  const SparseGlyph* end = atlas.sparseGlyphs + atlas.numSparseGlyphs;
+  const SparseGlyph* it = std::lower_bound(atlas.sparseGlyphs, end, code, CompareGlyphCode);
+  if(it != end && it->code == code) {
+    return it->ch;
+  }
+  return *atlas.missingGlyph;
+}
 
-  TextureChar ch;
-  float texWidth, texHeight, texAdvance, texHorizOffset, texVertOffset;
+// Write the bottom-left and top-right vertices of a glyph at the pen
+// position, for instanced drawing. Each vertex is (x, y, s, t); the SIMD
+// paths produce the same bits as the scalar one.
+static inline void WriteGlyph(GLfloat* out, float x, float y, const TextureChar& ch,
+  float scale, const TextureAtlas& atlas) {
 
-  int len = name.length();
+#if defined(__ARM_NEON)
+  static const uint32_t EVEN_LANES[4] = {~0u, 0u, ~0u, 0u};
+  uint32x4_t even = vld1q_u32(EVEN_LANES);
+  float32x4_t c = vld1q_f32(&ch.x);
 
-  // Set vertices
-  for(unsigned int i=0; i<len; ++i) {
+  // Quad size in screen and texture space
+  float32x4_t size = vcombine_f32(vget_high_f32(c), vget_high_f32(c));
+  float32x4_t sizeScale = {scale, scale, 1.0f, 1.0f};
+  float32x4_t texScale = {(float)atlas.textureWidth, (float)atlas.textureHeight, 1.0f, 1.0f};
+  size = vmulq_f32(vmulq_f32(size, sizeScale), texScale);
 
-    ch = atlas.charMap[name[i]];
-    texWidth = ch.width * scale * atlas.textureWidth;
-    texHeight = ch.height * scale * atlas.textureHeight;
-    texAdvance = ch.xAdvance * scale;
-    texHorizOffset = ch.xOffset * scale;
-    texVertOffset = ch.yOffset * scale;
+  // Top-left corner
+  float32x4_t offScale = {scale, -scale, 0.0f, 0.0f};
+  float32x4_t off = vcombine_f32(vld1_f32(&ch.xOffset), vdup_n_f32(0.0f));
+  float32x2_t pen = {x, y};
+  float32x4_t corner = vaddq_f32(vcombine_f32(pen, vget_low_f32(c)), vmulq_f32(off, offScale));
 
-    vertices.push_back(x + texHorizOffset + texWidth);
-    vertices.push_back(y - texVertOffset - texHeight);
-    vertices.push_back(ch.x + ch.width);
-    vertices.push_back(ch.y - ch.height);
+  // Right edges take x/s from corner+size, bottom edges y/t from corner-size
+  float32x4_t plus = vaddq_f32(corner, size);
+  float32x4_t minus = vsubq_f32(corner, size);
+  vst1q_f32(out, vbslq_f32(even, corner, minus));
+  vst1q_f32(out + 4, vbslq_f32(even, plus, corner));
+#elif defined(__SSE2__)
+  __m128 even = _mm_castsi128_ps(_mm_setr_epi32(-1, 0, -1, 0));
+  __m128 c = _mm_loadu_ps(&ch.x);
 
-    vertices.push_back(x + texHorizOffset);
-    vertices.push_back(y - texVertOffset - texHeight);
-    vertices.push_back(ch.x);
-    vertices.push_back(ch.y - ch.height);
+  // Quad size in screen and texture space
+  __m128 size = _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 2, 3, 2));
+  size = _mm_mul_ps(_mm_mul_ps(size, _mm_setr_ps(scale, scale, 1.0f, 1.0f)),
+    _mm_setr_ps((float)atlas.textureWidth, (float)atlas.textureHeight, 1.0f, 1.0f));
 
-    vertices.push_back(x + texHorizOffset + texWidth);
-    vertices.push_back(y - texVertOffset);
-    vertices.push_back(ch.x + ch.width);
-    vertices.push_back(ch.y);
+  // Top-left corner
+  __m128 off = _mm_setr_ps(ch.xOffset, ch.yOffset, 0.0f, 0.0f);
+  __m128 corner = _mm_add_ps(_mm_movelh_ps(_mm_setr_ps(x, y, 0.0f, 0.0f), c),
+    _mm_mul_ps(off, _mm_setr_ps(scale, -scale, 0.0f, 0.0f)));
 
-    vertices.push_back(x + texHorizOffset);
-    vertices.push_back(y - texVertOffset);
-    vertices.push_back(ch.x);
-    vertices.push_back(ch.y);
-    x += texAdvance;
+  // Right edges take x/s from corner+size, bottom edges y/t from corner-size
+  __m128 plus = _mm_add_ps(corner, size);
+  __m128 minus = _mm_sub_ps(corner, size);
+  _mm_storeu_ps(out, _mm_or_ps(_mm_and_ps(even, corner), _mm_andnot_ps(even, minus)));
+  _mm_storeu_ps(out + 4, _mm_or_ps(_mm_and_ps(even, plus), _mm_andnot_ps(even, corner)));
+#else
+  float texWidth = ch.width * scale * atlas.textureWidth;
+  float texHeight = ch.height * scale * atlas.textureHeight;
+  float texHorizOffset = ch.xOffset * scale;
+  float texVertOffset = ch.yOffset * scale;
+
+  out[0] = x + texHorizOffset;
+  out[1] = y - texVertOffset - texHeight;
+  out[2] = ch.x;
+  out[3] = ch.y - ch.height;
+
+  out[4] = x + texHorizOffset + texWidth;
+  out[5] = y - texVertOffset;
+  out[6] = ch.x + ch.width;
+  out[7] = ch.y;
+#endif
+}
+
+void TextUtils::GenerateInstances(const TextRun* runs, unsigned int numRuns,
+  std::vector<GLfloat>& instances, float scale, const TextureAtlas& atlas) {
+
+  // Size the output once
+  size_t numChars = 0;
+  for(unsigned int i=0; i<numRuns; ++i) {
+    numChars += runs[i].text->length();
+  }
+  size_t start = instances.size();
+  instances.resize(start + 8*numChars);
+  GLfloat* out = instances.data() + start;
+
+  // Set vertices
+  for(unsigned int i=0; i<numRuns; ++i) {
+    const std::string& text = *runs[i].text;
+    float x = runs[i].x, y = runs[i].y;
+    for(unsigned int j=0; j<text.length(); ++j) {
+      const TextureChar& ch = Glyph(atlas, (unsigned char)text[j]);
+      WriteGlyph(out, x, y, ch, scale, atlas);
+      out += 8;
+      x += ch.xAdvance * scale;
+    }
   }
 }
@@ -3,7 +3,6 @@
 
 #include <cmath>
 #include <cstdlib>
-#include <map>
 #include <string>
 #include <vector>
 
@@ -17,22 +16,52 @@ typedef struct {
   float xOffset, yOffset, xAdvance;
 } TextureChar;
 
+// Code points below this are looked up directly, which covers every byte
+// of a std::string
+#define NUM_DIRECT_GLYPHS 256
+
+typedef struct {
+  unsigned int code;
+  TextureChar ch;
+} SparseGlyph;
+
 typedef struct {
   unsigned int lineHeight;
   unsigned int textureWidth, textureHeight;
-  std::map<unsigned int, TextureChar> charMap;
+  const TextureChar* glyphs;  // NUM_DIRECT_GLYPHS entries
+  const SparseGlyph* sparseGlyphs;  // Sorted by code point
+  unsigned int numSparseGlyphs;
+  const TextureChar* missingGlyph;
 } TextureAtlas;
 
+// A string to lay out with its pen starting position
+typedef struct {
+  const std::string* text;
+  float x, y;
+} TextRun;
+
 class TextUtils {
   
   public:
   
-    // Create a texture atlas from the font file
-    static TextureAtlas CreateAtlas();
+    // Texture atlas for the font file, built at compile time
+    static const TextureAtlas& GetAtlas();
+
+    // Look up a glyph, returning the missing glyph for unknown code points
+    static inline const TextureChar& Glyph(const TextureAtlas& atlas, unsigned int code) {
+      if(code < NUM_DIRECT_GLYPHS) {
+        return atlas.glyphs[code];
+      }
+      return SparseGlyphLookup(atlas, code);
+    }
+
+    // Append the bottom-left and top-right vertices of each glyph, to be
+    // expanded into a quad per instance
+    static void GenerateInstances(const TextRun* runs, unsigned int numRuns,
+      std::vector<GLfloat>& instances, float scale, const TextureAtlas& atlas);
 
-    // Generate vertices from a string
-    static void GenerateVertices(std::string name, std::vector<GLfloat>& vertices,
-      float x, float y, float displayScale, TextureAtlas& atlas);
+  private:
+    static const TextureChar& SparseGlyphLookup(const TextureAtlas& atlas, unsigned int code);
 };
 
 #endif  // TEXT_UTILS_H_
\ No newline at end of file
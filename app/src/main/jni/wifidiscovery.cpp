@@ -2,8 +2,7 @@
 
 #include <android/asset_manager_jni.h>
 
-#include <codecvt>
-#include <locale>
+#include <string>
 
 #include "vr/gvr/capi/include/gvr.h"
 #include "wifidiscovery_renderer.h"
@@ -12,11 +11,16 @@ extern "C" {
 
 JNIEXPORT jlong JNICALL 
 Java_com_quiller_wifidiscovery_WiFiDiscoveryActivity_createRenderer(
-  JNIEnv *env, jclass cls, jlong gvrContext, jobject assetMgr) {   
+  JNIEnv *env, jclass cls, jlong gvrContext, jobject assetMgr,
+  jobject classLoader, jobject context, jstring cacheDir, jstring hostCacheDir) {
 
+  const char* cachePath = env->GetStringUTFChars(cacheDir, NULL);
+  const char* hostCachePath = env->GetStringUTFChars(hostCacheDir, NULL);
   WiFiDiscoveryRenderer *renderer =
     new WiFiDiscoveryRenderer(reinterpret_cast<gvr_context*>(gvrContext),
-      AAssetManager_fromJava(env, assetMgr));
+      AAssetManager_fromJava(env, assetMgr), cachePath, hostCachePath);
+  env->ReleaseStringUTFChars(cacheDir, cachePath);
+  env->ReleaseStringUTFChars(hostCacheDir, hostCachePath);
   return reinterpret_cast<intptr_t>(renderer);
 }
 
@@ -34,13 +38,6 @@ Java_com_quiller_wifidiscovery_WiFiDiscoveryActivity_nativeOnDrawFrame(
   reinterpret_cast<WiFiDiscoveryRenderer *>(renderer)->OnDrawFrame();
 }
 
-JNIEXPORT void JNICALL
-Java_com_quiller_wifidiscovery_WiFiDiscoveryActivity_nativeProgressUpdate(
-    JNIEnv *env, jclass cls, jlong renderer) {
-
-  reinterpret_cast<WiFiDiscoveryRenderer *>(renderer)->PublishProgress();
-}
-
 JNIEXPORT void JNICALL
 Java_com_quiller_wifidiscovery_WiFiDiscoveryActivity_nativeSetState(
     JNIEnv *env, jclass cls, jlong renderer, jint state) {
@@ -49,27 +46,35 @@ Java_com_quiller_wifidiscovery_WiFiDiscoveryActivity_nativeSetState(
 }
 
 JNIEXPORT void JNICALL
-Java_com_quiller_wifidiscovery_WiFiDiscoveryActivity_nativeSetScanComplete(
-    JNIEnv *env, jclass cls, jlong renderer) {
-
-  reinterpret_cast<WiFiDiscoveryRenderer *>(renderer)->SetScanComplete();
-}
-
-JNIEXPORT void JNICALL
-Java_com_quiller_wifidiscovery_WiFiDiscoveryActivity_nativeAddHost(
-    JNIEnv *env, jclass cls, jlong renderer, jstring result) {
-
-// Convert the jstring to a wstring
-  const jchar* jchars = env->GetStringChars(result, NULL);
-  jsize length = env->GetStringLength(result);
-  std::wstring wstr;
-  wstr.assign(jchars, jchars + length);
-
-// Convert the wstring to a string
-  std::wstring_convert<std::codecvt_utf8<wchar_t>> converter;
-  std::string str = converter.to_bytes(wstr);
-
-  reinterpret_cast<WiFiDiscoveryRenderer *>(renderer)->AddHost(str);
+Java_com_quiller_wifidiscovery_WiFiDiscoveryActivity_nativeStartScan(
+    JNIEnv *env, jclass cls, jlong renderer, jstring address, jint prefixLength,
+    jstring ssid, jstring bssid, jstring dnsServer) {
+
+  const char* chars = env->GetStringUTFChars(address, NULL);
+  std::string str(chars);
+  env->ReleaseStringUTFChars(address, chars);
+
+  // The network's identity, which may be unavailable
+  std::string ssidStr, bssidStr;
+  if(ssid) {
+    chars = env->GetStringUTFChars(ssid, NULL);
+    ssidStr = chars;
+    env->ReleaseStringUTFChars(ssid, chars);
+  }
+  if(bssid) {
+    chars = env->GetStringUTFChars(bssid, NULL);
+    bssidStr = chars;
+    env->ReleaseStringUTFChars(bssid, chars);
+  }
+  std::string dnsStr;
+  if(dnsServer) {
+    chars = env->GetStringUTFChars(dnsServer, NULL);
+    dnsStr = chars;
+    env->ReleaseStringUTFChars(dnsServer, chars);
+  }
+
+  reinterpret_cast<WiFiDiscoveryRenderer *>(renderer)->StartScan(str, prefixLength,
+    ssidStr, bssidStr, dnsStr);
 }
 
 JNIEXPORT void JNICALL
@@ -86,6 +91,14 @@ Java_com_quiller_wifidiscovery_WiFiDiscoveryActivity_nativeOnPause(
   reinterpret_cast<WiFiDiscoveryRenderer *>(renderer)->OnPause();
 }
 
+JNIEXPORT jstring JNICALL
+Java_com_quiller_wifidiscovery_WiFiDiscoveryActivity_nativeGetFrameStats(
+    JNIEnv *env, jclass cls, jlong renderer) {
+
+  std::string stats = reinterpret_cast<WiFiDiscoveryRenderer *>(renderer)->GetFrameStats();
+  return env->NewStringUTF(stats.c_str());
+}
+
 JNIEXPORT void JNICALL
 Java_com_quiller_wifidiscovery_WiFiDiscoveryActivity_nativeOnDestroy(
     JNIEnv *env, jclass cls, jlong renderer) {
@@ -1,5 +1,10 @@
 #include "wifidiscovery_renderer.h"
 
+#include <arpa/inet.h>
+
+#include <cstring>
+#include <thread>
+
 static const char* TAG = "WiFiDiscovery";
 std::vector<std::string> shaderNames = {
   "messages.vert", "messages.frag",
@@ -7,7 +12,8 @@ std::vector<std::string> shaderNames = {
   "pointer.vert", "pointer.frag",
   "host.vert", "host.frag",
   "box.vert", "box.frag",
-  "boxtext.vert", "boxtext.frag"};
+  "boxtext.vert", "boxtext.frag",
+  "label.vert", "messages.frag"};
 static const float PLAYER_DEPTH = -5.0f;
 static const float CIRCLE_RADIUS = 0.15f;
 
@@ -15,6 +21,33 @@ static const float HOST_WIDTH = 0.3f;
 static const float HOST_HEIGHT = 0.3f;
 static const float HOST_HORIZ_SPACING = 0.45f;
 static const float HOST_VERT_SPACING = 0.75f;
+static const unsigned int HOSTS_PER_ROW = 15;
+static const float WALL_TOP = -0.6f;
+
+// Lost hosts' buttons are parked this far above the wall
+static const float HIDDEN_OFFSET = 1000.0f;
+
+// Least time between rewrites of the host cache while monitoring
+static const std::chrono::seconds HOST_CACHE_SAVE_INTERVAL(60);
+
+// Initial sizes of the growable host buffers
+static const GLuint INITIAL_HOST_CAPACITY = 256;
+
+// Uniform buffer layout
+static const GLintptr UBO_TARGET = 2*sizeof(gvr::Mat4f);
+static const GLintptr UBO_SELECTED_OFFSET = UBO_TARGET + 2*sizeof(float);
+static const GLintptr UBO_SELECTED_INDEX = UBO_SELECTED_OFFSET + 2*sizeof(float);
+static const GLsizeiptr UBO_SIZE = UBO_SELECTED_INDEX + sizeof(int);
+
+// Bytes of streamed data available to each frame
+static const GLsizeiptr STREAM_FRAME_SIZE = 256*1024;
+
+// Shaders and textures packed by tools/assetpack
+static const char* BUNDLE_NAME = "wifi_discovery.pack";
+
+// Both atlas textures are raw single-channel images
+static const GLsizei TEXTURE_SIZE = 256;
+static const size_t TEXTURE_BYTES = TEXTURE_SIZE*TEXTURE_SIZE;
 
 static const float DISPLAY_TEXT_HEIGHT = 0.20f;
 static const float DISPLAY_TEXT_SPACING = 0.15f;
@@ -25,6 +58,28 @@ static const float BORDER_COLOR = 0.6f;
 static const float HOST_TEXT_SPACING = -0.08f;
 static const float IP_TEXT_SPACING = -0.3f;
 
+// Prefix of the host name in the detail box
+static const char* HOST_PREFIX = "Host: ";
+static const size_t HOST_PREFIX_LENGTH = 6;
+
+// Attribute locations are bound before linking, so the VAOs can be set
+// up while the programs are still compiling
+enum {
+  ATTRIB_COORDS, ATTRIB_TEXCOORDS, ATTRIB_OFFSET, ATTRIB_COLOR,
+  ATTRIB_LOWER, ATTRIB_UPPER, ATTRIB_PEN, ATTRIB_GLYPH, NUM_ATTRIBS
+};
+static const char* ATTRIB_NAMES[NUM_ATTRIBS] = {
+  "in_coords", "in_texcoords", "in_offset", "in_color",
+  "in_lower", "in_upper", "in_pen", "in_glyph"};
+
+// Vertex shader headers selecting the per-eye matrix
+static const char* MULTIVIEW_HEADER =
+  "#extension GL_OVR_multiview : require\n"
+  "layout(num_views = 2) in;\n"
+  "#define VIEW_ID gl_ViewID_OVR\n";
+static const char* SINGLE_VIEW_HEADER = "#define VIEW_ID 0\n";
+static const GLsizei MULTIVIEW_SAMPLES = 4;
+
 // Near and far clipping planes.
 static const float near = 1.0f;
 static const float far = 100.0f;
@@ -61,58 +116,213 @@ void handleMessage(GLenum source​, GLenum type​, GLuint id​,
   const void* userData);
 
 WiFiDiscoveryRenderer::WiFiDiscoveryRenderer(
-  gvr_context* gvrContext, AAssetManager* assetMgr):
+  gvr_context* gvrContext, AAssetManager* assetMgr, const std::string& cachePath,
+  const std::string& hostCachePath):
+  hostCapacity(INITIAL_HOST_CAPACITY),
+  picker(HOST_WIDTH + HOST_HORIZ_SPACING),
+  scanComplete(false),
+  closing(false),
+  hostCacheDir(hostCachePath),
+  networkHash(0),
+  hostCacheReady(false),
+  hostCacheLoaded(false),
+  hostCacheDirty(false),
+  hostCacheSnapshotHash(0),
+  hostCacheQueued(false),
+  hostCacheStopping(false),
+  assetManager(assetMgr),
+  cacheDir(cachePath),
+  numCachedPrograms(0),
+  parallelCompile(false),
   gvrApi(gvr::GvrApi::WrapNonOwned(gvrContext)),
   buffViewport(gvrApi->CreateBufferViewport()),
-  assetManager(assetMgr),
-  ready(false),
-  firstFrame(true),
-  hostReady(false),
   selectedHost(-1),
-  numIndices(0),
-  numOffsets(0),
-  numDisplayChars(0),
   spinnerSegments(2),
-  atlas(TextUtils::CreateAtlas()){}
+  ready(false),
+  firstFrame(true),
+  createTime(std::chrono::steady_clock::now()),
+  multiview(false),
+  multiviewFbo(0),
+  blitFbo(0),
+  multiviewTex(0),
+  atlas(TextUtils::GetAtlas()),
+  numUploadedHosts(0) {
+
+  selectedOffset[0] = 0.0f; selectedOffset[1] = 0.0f;
+  std::fill(programReady, programReady + NUM_PROGRAMS, false);
+
+  // An empty field of view forces the first projection to be built
+  for(int i=0; i<2; ++i) {
+    eyeFovs[i].left = eyeFovs[i].right = eyeFovs[i].bottom = eyeFovs[i].top = 0.0f;
+  }
+}
 
 WiFiDiscoveryRenderer::~WiFiDiscoveryRenderer() {
+
+  // Release a scanner thread waiting for queue space so it can be joined
+  {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    closing = true;
+  }
+  queueSpace.notify_all();
+  scanner.reset();
+
+  // Let the last queued save finish
+  if(hostCacheWriter.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(hostCacheMutex);
+      hostCacheStopping = true;
+    }
+    hostCacheWake.notify_one();
+    hostCacheWriter.join();
+  }
   glDeleteBuffers(NUM_VBOS, vbos);
-  glDeleteBuffers(NUM_IBOS, ibos);
-  glDeleteBuffers(NUM_UBOS, ubos);
+  stream.Destroy();
   glDeleteVertexArrays(NUM_VAOS, vaos);
   glDeleteTextures(NUM_TEXTURES, tids);
+#ifdef FRAME_PROFILING
+  gpuTimer.Destroy();
+#endif
+  if(multiview) {
+    glDeleteFramebuffers(1, &multiviewFbo);
+    glDeleteFramebuffers(1, &blitFbo);
+    glDeleteTextures(1, &multiviewTex);
+  }
 }
 
 void WiFiDiscoveryRenderer::InitShaders() {
 
   GLuint vertDescriptor, fragDescriptor;
-  std::string vertFile, fragFile;
+  AssetSlice vertFile, fragFile;
   unsigned int progIndex;
+  const char* header = multiview ? MULTIVIEW_HEADER : SINGLE_VIEW_HEADER;
+  char cacheName[32];
+
+  // Cached binaries are only valid for the driver that produced them and
+  // the attribute locations they were linked with
+  std::string driver = std::string((const char*)glGetString(GL_RENDERER)) +
+    (const char*)glGetString(GL_VERSION) + header;
+  for(unsigned int i=0; i<NUM_ATTRIBS; ++i) {
+    driver += ATTRIB_NAMES[i];
+  }
+  uint64_t driverHash = ShaderUtils::Hash(driver);
+  numCachedPrograms = 0;
 
-  // Process each pair of shaders
+  // Submit every program before checking any of them, so the driver can
+  // compile them concurrently
   for(unsigned int i=0; i<shaderNames.size(); i+=2) {
+    progIndex = i/2;
+    programReady[progIndex] = false;
+    vertFile = bundle.Find(shaderNames[i].c_str());
+    fragFile = bundle.Find(shaderNames[i+1].c_str());
+    if(!vertFile.data || !fragFile.data) {
+      __android_log_print(ANDROID_LOG_ERROR, TAG, "Can't find %s or %s",
+        shaderNames[i].c_str(), shaderNames[i+1].c_str());
+      exit(EXIT_FAILURE);
+    }
+
+    // Use the cached binary for this source and driver if there is one
+    uint64_t key = ShaderUtils::Hash(fragFile.data, fragFile.size,
+      ShaderUtils::Hash(vertFile.data, vertFile.size, driverHash));
+    snprintf(cacheName, sizeof(cacheName), "/%016llx.bin", (unsigned long long)key);
+    cachePaths[progIndex] = cacheDir + cacheName;
+    if(!cacheDir.empty()) {
+      programs[progIndex] = ShaderUtils::LoadProgramBinary(cachePaths[progIndex]);
+      if(programs[progIndex] != 0) {
+        ++numCachedPrograms;
+        SetupProgram(progIndex);
+        continue;
+      }
+    }
 
-    // Read and compile vertex shader
+    // Compile vertex shader, inserting the view header after #version. The
+    // sources point into the asset bundle, so every length is explicit.
     vertDescriptor = glCreateShader(GL_VERTEX_SHADER);
-    vertFile = ShaderUtils::ReadFile(assetManager, shaderNames[i].c_str());
-    const GLchar* vertSource = vertFile.c_str();
-    glShaderSource(vertDescriptor, 1, &vertSource, 0);
-    ShaderUtils::CompileShader(vertDescriptor);
-
-    // Read and compile fragment shader
+    const char* vertEnd = vertFile.data + vertFile.size;
+    const char* versionEnd = (const char*)memchr(vertFile.data, '\n', vertFile.size);
+    versionEnd = versionEnd ? versionEnd + 1 : vertEnd;
+    const GLchar* vertSources[3] = {vertFile.data, header, versionEnd};
+    const GLint vertLengths[3] = {(GLint)(versionEnd - vertFile.data), -1,
+      (GLint)(vertEnd - versionEnd)};
+    glShaderSource(vertDescriptor, 3, vertSources, vertLengths);
+    glCompileShader(vertDescriptor);
+
+    // Compile fragment shader
     fragDescriptor = glCreateShader(GL_FRAGMENT_SHADER);
-    fragFile = ShaderUtils::ReadFile(assetManager, shaderNames[i+1].c_str());
-    const GLchar* fragSource = fragFile.c_str();
-    glShaderSource(fragDescriptor, 1, &fragSource, 0);
-    ShaderUtils::CompileShader(fragDescriptor);
+    const GLchar* fragSource = fragFile.data;
+    const GLint fragLength = (GLint)fragFile.size;
+    glShaderSource(fragDescriptor, 1, &fragSource, &fragLength);
+    glCompileShader(fragDescriptor);
 
     // Create program and bind attributes
-    progIndex = i/2;
     programs[progIndex] = glCreateProgram();
     glAttachShader(programs[progIndex], vertDescriptor);
     glAttachShader(programs[progIndex], fragDescriptor);
-    ShaderUtils::LinkProgram(programs[progIndex]);
+    for(GLuint j=0; j<NUM_ATTRIBS; ++j) {
+      glBindAttribLocation(programs[progIndex], j, ATTRIB_NAMES[j]);
+    }
+    glProgramParameteri(programs[progIndex], GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(programs[progIndex]);
+    pendingShaders[progIndex][0] = vertDescriptor;
+    pendingShaders[progIndex][1] = fragDescriptor;
+  }
+}
+
+void WiFiDiscoveryRenderer::PollPrograms() {
+
+  for(unsigned int i=0; i<NUM_PROGRAMS; ++i) {
+    if(programReady[i]) {
+      continue;
+    }
+
+    // Without the extension any status query blocks, so finish at most
+    // one program per frame
+    if(!parallelCompile) {
+      FinishProgram(i);
+      return;
+    }
+    GLint complete = GL_FALSE;
+    glGetProgramiv(programs[i], GL_COMPLETION_STATUS_KHR, &complete);
+    if(complete) {
+      FinishProgram(i);
+    }
+  }
+}
+
+void WiFiDiscoveryRenderer::FinishProgram(unsigned int index) {
+
+  // Exit with the log on failure, as synchronous compilation did
+  ShaderUtils::CheckShader(pendingShaders[index][0]);
+  ShaderUtils::CheckShader(pendingShaders[index][1]);
+  ShaderUtils::CheckProgram(programs[index]);
+  glDeleteShader(pendingShaders[index][0]);
+  glDeleteShader(pendingShaders[index][1]);
+
+  // Save the binary for the next start
+  if(!cacheDir.empty()) {
+    ShaderUtils::SaveProgramBinary(programs[index], cachePaths[index]);
   }
+  SetupProgram(index);
+}
+
+void WiFiDiscoveryRenderer::SetupProgram(unsigned int index) {
+
+  // Every program reads its uniforms from binding point 0
+  GLuint program = programs[index];
+  glUniformBlockBinding(program, glGetUniformBlockIndex(program, "ubo"), 0);
+
+  // The label program reads glyph metrics from binding point 1
+  if(index == 6) {
+    glUniformBlockBinding(program, glGetUniformBlockIndex(program, "glyphs"), 1);
+  }
+
+  // The text programs sample the distance field from unit 1
+  if(index == 0 || index == 5 || index == 6) {
+    glUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "texSampler"), 1);
+    glUseProgram(0);
+  }
+  programReady[index] = true;
 }
 
 void WiFiDiscoveryRenderer::InitMessages() {
@@ -133,13 +343,13 @@ void WiFiDiscoveryRenderer::InitMessages() {
   glUnmapBuffer(GL_ARRAY_BUFFER);
 
   // Associate coordinate data with in_coords
-  GLint coordIndex = glGetAttribLocation(programs[0], "in_coords");
+  GLint coordIndex = ATTRIB_COORDS;
   glEnableVertexAttribArray((GLuint)coordIndex);
   glVertexAttribPointer((GLuint)coordIndex, 2,
     GL_FLOAT, GL_FALSE, 4*sizeof(GLfloat), 0);
 
   // Associate color data with in_texcoords
-  GLint texcoordIndex = glGetAttribLocation(programs[0], "in_texcoords");
+  GLint texcoordIndex = ATTRIB_TEXCOORDS;
   glEnableVertexAttribArray((GLuint)texcoordIndex);
   glVertexAttribPointer((GLuint)texcoordIndex, 2,
     GL_FLOAT, GL_FALSE, 4*sizeof(GLfloat), (GLvoid*)8);
@@ -172,15 +382,11 @@ void WiFiDiscoveryRenderer::InitSpinner() {
   glUnmapBuffer(GL_ARRAY_BUFFER);
 
   // Associate coordinate data with in_coords
-  GLint coordIndex = glGetAttribLocation(programs[1], "in_coords");
+  GLint coordIndex = ATTRIB_COORDS;
   glEnableVertexAttribArray((GLuint)coordIndex);
   glVertexAttribPointer((GLuint)coordIndex, 2,
     GL_FLOAT, GL_FALSE, 0, 0);
 
-  // Set the selected button to -1
-  glBufferSubData(GL_UNIFORM_BUFFER, sizeof(gvr::Mat4f) + sizeof(target) + sizeof(offsets),
-    sizeof(selectedHost), (GLvoid*)&selectedHost);
-
   // Unbind the VAO
   glBindVertexArray(0);
 }
@@ -194,13 +400,13 @@ void WiFiDiscoveryRenderer::InitPointer() {
   glBindBuffer(GL_ARRAY_BUFFER, vbos[0]);
 
   // Associate coordinate data with in_coords
-  GLint coordIndex = glGetAttribLocation(programs[2], "in_coords");
+  GLint coordIndex = ATTRIB_COORDS;
   glEnableVertexAttribArray((GLuint)coordIndex);
   glVertexAttribPointer((GLuint)coordIndex, 2,
     GL_FLOAT, GL_FALSE, 4*sizeof(GLfloat), (GLvoid*)(32*sizeof(float)));
 
   // Associate color data with in_texcoords
-  GLint texcoordIndex = glGetAttribLocation(programs[2], "in_texcoords");
+  GLint texcoordIndex = ATTRIB_TEXCOORDS;
   glEnableVertexAttribArray((GLuint)texcoordIndex);
   glVertexAttribPointer((GLuint)texcoordIndex, 2,
     GL_FLOAT, GL_FALSE, 4*sizeof(GLfloat), (GLvoid*)(34*sizeof(float)));
@@ -218,17 +424,28 @@ void WiFiDiscoveryRenderer::InitHosts() {
   glBindBuffer(GL_ARRAY_BUFFER, vbos[0]);
 
   // Associate coordinate data with in_coords
-  GLint coordIndex = glGetAttribLocation(programs[3], "in_coords");
+  GLint coordIndex = ATTRIB_COORDS;
   glEnableVertexAttribArray((GLuint)coordIndex);
   glVertexAttribPointer((GLuint)coordIndex, 2,
     GL_FLOAT, GL_FALSE, 4*sizeof(GLfloat), (GLvoid*)(48*sizeof(float)));
 
   // Associate color data with in_texcoords
-  GLint texcoordIndex = glGetAttribLocation(programs[3], "in_texcoords");
+  GLint texcoordIndex = ATTRIB_TEXCOORDS;
   glEnableVertexAttribArray((GLuint)texcoordIndex);
   glVertexAttribPointer((GLuint)texcoordIndex, 2,
     GL_FLOAT, GL_FALSE, 4*sizeof(GLfloat), (GLvoid*)(50*sizeof(float)));
 
+  // Configure the instance VBO
+  glBindBuffer(GL_ARRAY_BUFFER, vbos[3]);
+  glBufferData(GL_ARRAY_BUFFER, 2*hostCapacity*sizeof(GLfloat), NULL, GL_DYNAMIC_DRAW);
+
+  // Associate per-host offsets with in_offset
+  GLint offsetIndex = ATTRIB_OFFSET;
+  glEnableVertexAttribArray((GLuint)offsetIndex);
+  glVertexAttribPointer((GLuint)offsetIndex, 2,
+    GL_FLOAT, GL_FALSE, 2*sizeof(GLfloat), 0);
+  glVertexAttribDivisor((GLuint)offsetIndex, 1);
+
   // Unbind the VAO
   glBindVertexArray(0);
 }
@@ -239,26 +456,38 @@ void WiFiDiscoveryRenderer::InitText() {
   glBindVertexArray(vaos[4]);
 
   glBindBuffer(GL_ARRAY_BUFFER, vbos[2]);
-  glBufferStorageEXT(GL_ARRAY_BUFFER, 81920, NULL, GL_MAP_WRITE_BIT);
+  glBufferData(GL_ARRAY_BUFFER, MAX_LABEL_CHARS*hostCapacity*sizeof(LabelGlyph),
+    NULL, GL_DYNAMIC_DRAW);
 
-  // Associate coordinate data with in_coords
-  GLint coordIndex = glGetAttribLocation(programs[0], "in_coords");
-  glEnableVertexAttribArray((GLuint)coordIndex);
-  glVertexAttribPointer((GLuint)coordIndex, 2,
-    GL_FLOAT, GL_FALSE, 4*sizeof(GLfloat), 0);
+  // Associate the pen position of each glyph with in_pen
+  GLint penIndex = ATTRIB_PEN;
+  glEnableVertexAttribArray((GLuint)penIndex);
+  glVertexAttribPointer((GLuint)penIndex, 2,
+    GL_FLOAT, GL_FALSE, sizeof(LabelGlyph), 0);
+  glVertexAttribDivisor((GLuint)penIndex, 1);
 
-  // Associate color data with in_texcoords
-  GLint texcoordIndex = glGetAttribLocation(programs[0], "in_texcoords");
-  glEnableVertexAttribArray((GLuint)texcoordIndex);
-  glVertexAttribPointer((GLuint)texcoordIndex, 2,
-    GL_FLOAT, GL_FALSE, 4*sizeof(GLfloat), (GLvoid*)8);
-
-  // Configure the IBO
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibos[0]);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, 20480, NULL, GL_DYNAMIC_DRAW);
+  // Associate the glyph code with in_glyph
+  GLint glyphIndex = ATTRIB_GLYPH;
+  glEnableVertexAttribArray((GLuint)glyphIndex);
+  glVertexAttribIPointer((GLuint)glyphIndex, 1,
+    GL_UNSIGNED_INT, sizeof(LabelGlyph), (GLvoid*)(2*sizeof(GLfloat)));
+  glVertexAttribDivisor((GLuint)glyphIndex, 1);
 
   // Unbind the VAO
   glBindVertexArray(0);
+
+  // Build the glyph metrics block: the corners of each glyph's quad
+  // relative to the pen at label scale, with glyph 0 left empty
+  std::vector<GLfloat> corners(8, 0.0f);
+  float displayScale = DISPLAY_TEXT_HEIGHT/atlas.lineHeight;
+  for(unsigned int code=1; code<NUM_DIRECT_GLYPHS; ++code) {
+    std::string glyph(1, (char)code);
+    TextRun run = {&glyph, 0.0f, 0.0f};
+    TextUtils::GenerateInstances(&run, 1, corners, displayScale, atlas);
+  }
+  glBindBuffer(GL_UNIFORM_BUFFER, vbos[4]);
+  glBufferData(GL_UNIFORM_BUFFER, corners.size()*sizeof(GLfloat), corners.data(), GL_STATIC_DRAW);
+  glBindBufferBase(GL_UNIFORM_BUFFER, 1, vbos[4]);
 }
 
 void WiFiDiscoveryRenderer::InitBox() {
@@ -266,20 +495,12 @@ void WiFiDiscoveryRenderer::InitBox() {
   // Configure the VAO
   glBindVertexArray(vaos[5]);
 
-  glBindBuffer(GL_ARRAY_BUFFER, vbos[3]);
-  glBufferStorageEXT(GL_ARRAY_BUFFER, 24*sizeof(float), NULL, GL_MAP_WRITE_BIT);
-
-  // Associate coordinate data with in_coords
-  GLint coordIndex = glGetAttribLocation(programs[4], "in_coords");
-  glEnableVertexAttribArray((GLuint)coordIndex);
-  glVertexAttribPointer((GLuint)coordIndex, 2,
-    GL_FLOAT, GL_FALSE, 3*sizeof(GLfloat), 0);
-
-  // Associate color data with in_texcoords
-  GLint texcoordIndex = glGetAttribLocation(programs[4], "in_color");
-  glEnableVertexAttribArray((GLuint)texcoordIndex);
-  glVertexAttribPointer((GLuint)texcoordIndex, 1,
-    GL_FLOAT, GL_FALSE, 3*sizeof(GLfloat), (GLvoid*)8);
+  // The data comes from the stream buffer, so only enable the attributes
+  // here. StreamSelection points them at each frame's copy.
+  boxAttribs[0] = ATTRIB_COORDS;
+  glEnableVertexAttribArray(boxAttribs[0]);
+  boxAttribs[1] = ATTRIB_COLOR;
+  glEnableVertexAttribArray(boxAttribs[1]);
 
   // Unbind the VAO
   glBindVertexArray(0);
@@ -289,25 +510,15 @@ void WiFiDiscoveryRenderer::InitBoxText() {
 
   // Configure the VAO
   glBindVertexArray(vaos[6]);
-  glBindBuffer(GL_ARRAY_BUFFER, vbos[4]);
-  glBufferStorageEXT(GL_ARRAY_BUFFER, 8192, NULL,
-    GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT_EXT | GL_MAP_COHERENT_BIT_EXT);
 
-  // Associate coordinate data with in_coords
-  GLint coordIndex = glGetAttribLocation(programs[5], "in_coords");
-  glEnableVertexAttribArray((GLuint)coordIndex);
-  glVertexAttribPointer((GLuint)coordIndex, 2,
-    GL_FLOAT, GL_FALSE, 4*sizeof(GLfloat), 0);
-
-  // Associate color data with in_texcoords
-  GLint texcoordIndex = glGetAttribLocation(programs[5], "in_texcoords");
-  glEnableVertexAttribArray((GLuint)texcoordIndex);
-  glVertexAttribPointer((GLuint)texcoordIndex, 2,
-    GL_FLOAT, GL_FALSE, 4*sizeof(GLfloat), (GLvoid*)8);
-
-  // Configure the IBO
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibos[1]);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, 2560, NULL, GL_DYNAMIC_DRAW);
+  // Each glyph is one instance whose corners come from the stream buffer.
+  // The shader expands them into a quad, so no index buffer is needed.
+  boxTextAttribs[0] = ATTRIB_LOWER;
+  glEnableVertexAttribArray(boxTextAttribs[0]);
+  glVertexAttribDivisor(boxTextAttribs[0], 1);
+  boxTextAttribs[1] = ATTRIB_UPPER;
+  glEnableVertexAttribArray(boxTextAttribs[1]);
+  glVertexAttribDivisor(boxTextAttribs[1], 1);
 
   // Unbind the VAO
   glBindVertexArray(0);
@@ -318,31 +529,94 @@ void WiFiDiscoveryRenderer::InitTextures() {
   glActiveTexture(GL_TEXTURE0);
   glBindTexture(GL_TEXTURE_2D, tids[0]);
 
-  // Read pixel data and associate it with texture
-  AAsset* asset = AAssetManager_open(assetManager, "wifi_discovery.bmp", AASSET_MODE_BUFFER);
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, 256, 256, 0,
-    GL_RED, GL_UNSIGNED_BYTE, AAsset_getBuffer(asset));
+  // Hand the mapped pixel data straight to the texture
+  AssetSlice pixels = bundle.Find("wifi_discovery.bmp");
+  if(pixels.size < TEXTURE_BYTES) {
+    __android_log_print(ANDROID_LOG_ERROR, TAG, "Can't read wifi_discovery.bmp");
+    exit(EXIT_FAILURE);
+  }
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, TEXTURE_SIZE, TEXTURE_SIZE, 0,
+    GL_RED, GL_UNSIGNED_BYTE, pixels.data);
 
   // Set texture parameters
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-  // Close asset file
-  AAsset_close(asset);
+  // The text programs sample the distance field version of the atlas from
+  // unit 1, generated offline by tools/sdfgen with the same layout
+  glActiveTexture(GL_TEXTURE1);
+  glBindTexture(GL_TEXTURE_2D, tids[1]);
+  pixels = bundle.Find("wifi_discovery_sdf.bmp");
+  if(pixels.size < TEXTURE_BYTES) {
+    __android_log_print(ANDROID_LOG_ERROR, TAG, "Can't read wifi_discovery_sdf.bmp");
+    exit(EXIT_FAILURE);
+  }
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, TEXTURE_SIZE, TEXTURE_SIZE, 0,
+    GL_RED, GL_UNSIGNED_BYTE, pixels.data);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glActiveTexture(GL_TEXTURE0);
+}
+
+void WiFiDiscoveryRenderer::InitMultiview() {
+
+  // Each layer holds one eye at half the render width
+  eyeSize.width = renderSize.width/2;
+  eyeSize.height = renderSize.height;
+
+  if(multiviewTex == 0) {
+    glGenFramebuffers(1, &multiviewFbo);
+    glGenFramebuffers(1, &blitFbo);
+  } else {
+    glDeleteTextures(1, &multiviewTex);
+  }
+
+  // Create the layered color target
+  glGenTextures(1, &multiviewTex);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, multiviewTex);
+  glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_RGBA8, eyeSize.width, eyeSize.height, 2);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+  // Attach both layers, multisampled when the driver allows it
+  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, multiviewFbo);
+  if(glFramebufferTextureMultisampleMultiviewOVR) {
+    glFramebufferTextureMultisampleMultiviewOVR(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+      multiviewTex, 0, MULTIVIEW_SAMPLES, 0, 2);
+  } else {
+    glFramebufferTextureMultiviewOVR(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+      multiviewTex, 0, 0, 2);
+  }
+  if(glCheckFramebufferStatus(GL_DRAW_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+    __android_log_print(ANDROID_LOG_ERROR, TAG, "Multiview framebuffer incomplete");
+  }
+  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
 }
 
 void WiFiDiscoveryRenderer::OnSurfaceCreated() {
 
+  std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+  // A recreated context has none of the old buffers, so every host is
+  // uploaded again
+  numUploadedHosts = 0;
+  changedHosts.clear();
+
+  // Likewise the multiview target, which InitMultiview creates when unset,
+  // and the stream buffer's fences
+  multiviewTex = 0;
+  multiviewFbo = 0;
+  blitFbo = 0;
+  stream.Reset();
+
   // Initialize OpenGL processing
   gvrApi->InitializeGl();
   glEnable(GL_SCISSOR_TEST);
-  glEnable(GL_PRIMITIVE_RESTART_FIXED_INDEX);
   glDepthMask(GL_FALSE);
   glEnable(GL_BLEND);
   glBlendFunc(GL_SRC_ALPHA, GL_SRC_COLOR);
   glLineWidth(2.0f);
-  glBufferStorageEXT =
-    (PFNGLBUFFERSTORAGEEXTPROC) eglGetProcAddress("glBufferStorageEXT");
 
   // Configure event handling
   glEnable(GL_DEBUG_OUTPUT_KHR);
@@ -350,25 +624,62 @@ void WiFiDiscoveryRenderer::OnSurfaceCreated() {
 
   // Initialize objects and shaders
   glGenVertexArrays(NUM_VAOS, vaos);
-  glGenBuffers(NUM_IBOS, ibos);
   glGenBuffers(NUM_VBOS, vbos);
-  glGenBuffers(NUM_UBOS, ubos);
   glGenTextures(NUM_TEXTURES, tids);
+
+  // Map the shaders and textures in one go
+  if(!bundle.Open(assetManager, BUNDLE_NAME)) {
+    __android_log_print(ANDROID_LOG_ERROR, TAG, "Can't open %s", BUNDLE_NAME);
+    exit(EXIT_FAILURE);
+  }
+
+  // Use single-pass stereo when the driver supports it
+  const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+  glFramebufferTextureMultiviewOVR = (PFNGLFRAMEBUFFERTEXTUREMULTIVIEWOVRPROC)
+    eglGetProcAddress("glFramebufferTextureMultiviewOVR");
+  glFramebufferTextureMultisampleMultiviewOVR = (PFNGLFRAMEBUFFERTEXTUREMULTISAMPLEMULTIVIEWOVRPROC)
+    eglGetProcAddress("glFramebufferTextureMultisampleMultiviewOVR");
+  multiview = extensions && strstr(extensions, "GL_OVR_multiview") &&
+    glFramebufferTextureMultiviewOVR;
+  if(!extensions || !strstr(extensions, "GL_OVR_multiview_multisampled_render_to_texture")) {
+    glFramebufferTextureMultisampleMultiviewOVR = NULL;
+  }
+
+  // Map the stream buffer persistently when the driver supports it
+  glBufferStorageEXT =
+    (PFNGLBUFFERSTORAGEEXTPROC) eglGetProcAddress("glBufferStorageEXT");
+  if(!extensions || !strstr(extensions, "GL_EXT_buffer_storage")) {
+    glBufferStorageEXT = NULL;
+  }
+
+  // Compile in the background when the driver supports it
+  glMaxShaderCompilerThreadsKHR = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)
+    eglGetProcAddress("glMaxShaderCompilerThreadsKHR");
+  parallelCompile = extensions && strstr(extensions, "GL_KHR_parallel_shader_compile") &&
+    glMaxShaderCompilerThreadsKHR;
+  if(parallelCompile) {
+    glMaxShaderCompilerThreadsKHR(0xffffffff);
+  }
+
+  // Time the render passes on the GPU when the driver supports it
+#ifdef FRAME_PROFILING
+  if(!gpuTimer.Init(extensions)) {
+    __android_log_print(ANDROID_LOG_INFO, TAG, "GPU pass timing not supported");
+  }
+#endif
   InitShaders();
 
-  // Initialize uniform buffer object
-  glBindBuffer(GL_UNIFORM_BUFFER, ubos[0]);
-  glBufferData(GL_UNIFORM_BUFFER,
-    sizeof(gvr::Mat4f) + sizeof(target) + sizeof(offsets) + sizeof(selectedHost),
-    NULL, GL_DYNAMIC_DRAW);
+  // The messages are all the first frames draw, so only wait for them
+  if(!programReady[0]) {
+    FinishProgram(0);
+  }
 
-  // Associate each program with the UBO
-  GLuint uboIndex;
-  for(GLuint i=0; i<NUM_PROGRAMS; ++i) {
-    uboIndex = glGetUniformBlockIndex(programs[i], "ubo");
-    glUniformBlockBinding(programs[i], uboIndex, i);
-    glBindBufferBase(GL_UNIFORM_BUFFER, i, ubos[0]);
+  // Create the persistently mapped stream buffer for per-frame data
+  stream.Init(STREAM_FRAME_SIZE, glBufferStorageEXT);
+  if(!stream.Mapped()) {
+    __android_log_print(ANDROID_LOG_INFO, TAG, "Stream buffer not mapped, staging writes");
   }
+  glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uboAlignment);
 
   // Initialize data
   InitMessages();
@@ -379,6 +690,7 @@ void WiFiDiscoveryRenderer::OnSurfaceCreated() {
   InitText();
   InitBox();
   InitBoxText();
+  bundle.Close();
 
   // Determine the rendering size
   gvr::Sizei maxSize = gvrApi->GetMaximumEffectiveRenderTargetSize();
@@ -393,6 +705,12 @@ void WiFiDiscoveryRenderer::OnSurfaceCreated() {
   specs[0].SetDepthStencilFormat(GVR_DEPTH_STENCIL_FORMAT_DEPTH_16);
   specs[0].SetSamples(4);
 
+  // Multiview renders into its own layers, so the GVR buffer can't be multisampled
+  if(multiview) {
+    specs[0].SetSamples(1);
+    specs[0].SetDepthStencilFormat(GVR_DEPTH_STENCIL_FORMAT_NONE);
+  }
+
   // Create the swap chain and viewport list
   swapChain.reset(new gvr::SwapChain(gvrApi->CreateSwapChain(specs)));
   viewports.reset(new gvr::BufferViewportList(
@@ -404,13 +722,47 @@ void WiFiDiscoveryRenderer::OnSurfaceCreated() {
   controllerApi->Resume();
   target[0] = 0.0f; target[1] = 0.0f;
 
+  if(multiview) {
+    InitMultiview();
+  }
+
+  // Report startup time, which drops on warm starts once the programs are cached
+  float surfaceMs = std::chrono::duration<float, std::milli>(
+    std::chrono::steady_clock::now() - startTime).count();
+  __android_log_print(ANDROID_LOG_INFO, TAG,
+    "Surface created in %.1f ms, %u of %u programs from cache",
+    surfaceMs, numCachedPrograms, (unsigned int)NUM_PROGRAMS);
+
+  // Show the hosts from the last scan of this network right away
+  LoadHostCache();
+
   ready = true;
 }
 
 void WiFiDiscoveryRenderer::OnDrawFrame() {
 
+  PROFILE_SCOPE(frameTimer, profiler, PHASE_FRAME);
+  PROFILE_SCOPE(phaseTimer, profiler, PHASE_SETUP);
+
+  // Check for completion first so every host pushed before it is drained.
+  // Cached hosts go in before any live ones so those can replace them.
+  bool complete = scanComplete.exchange(false, std::memory_order_acquire);
+  LoadHostCache();
+  DrainHosts();
+  if(complete) {
+    state = SCAN_FINISHED;
+    RemoveStaleHosts();
+    SaveHostCache();
+  } else if(hostCacheDirty && state == SCAN_FINISHED &&
+            std::chrono::steady_clock::now() - hostCacheSaveTime > HOST_CACHE_SAVE_INTERVAL) {
+    SaveHostCache();
+  }
+
   glActiveTexture(GL_TEXTURE0);
 
+  // Pick up programs that finished compiling since the last frame
+  PollPrograms();
+
   gvr::Sizei size = gvrApi->GetMaximumEffectiveRenderTargetSize();
   size.width = size.width/2;
   size.height = size.height/2;
@@ -418,11 +770,20 @@ void WiFiDiscoveryRenderer::OnDrawFrame() {
      renderSize.height != size.height) {
     swapChain->ResizeBuffer(0, size);
     renderSize = size;
+    if(multiview) {
+      InitMultiview();
+    }
   }
 
   // Initialize the buffer viewport list
   viewports->SetToRecommendedBufferViewports();
 
+  // Claim this frame's region of the stream buffer
+  stream.BeginFrame();
+#ifdef FRAME_PROFILING
+  gpuTimer.BeginFrame();
+#endif
+
   // Determine the headset's future orientation
   gvr::ClockTimePoint time = gvr::GvrApi::GetTimePointNow();
   time.monotonic_system_time_nanos += 50000000;
@@ -430,122 +791,161 @@ void WiFiDiscoveryRenderer::OnDrawFrame() {
     gvrApi->GetHeadSpaceFromStartSpaceRotation(time);
   headMatrix = gvrApi->ApplyNeckModel(initMatrix, 1.0);
 
-  // Determine the controller's target if connected
+  // Determine the controller's pointing ray and its target on the wall
+  // if connected. The ray starts at the player.
+  PROFILE_NEXT(phaseTimer, PHASE_CONTROLLER);
+  static const float RAY_ORIGIN[3] = {0.0f, 0.0f, 0.0f};
+  float ray[3] = {0.0f, 0.0f, -1.0f};
   controllerState.Update(*controllerApi);
   if(!firstFrame && controllerState.GetConnectionState() == GVR_CONTROLLER_CONNECTED) {
     gvr_quatf q = controllerState.GetOrientation();
     float tmp = (q.qw * q.qw) - (q.qx * q.qx) - (q.qy * q.qy) + (q.qz * q.qz);
     target[0] = (2.0f * q.qw * q.qy - 2.0f * q.qx * q.qz) * (PLAYER_DEPTH / tmp);
     target[1] = (-2.0f * q.qw * q.qx - 2.0f * q.qy * q.qz) * (PLAYER_DEPTH / tmp);
+    ray[0] = 2.0f * q.qx * q.qz - 2.0f * q.qw * q.qy;
+    ray[1] = 2.0f * q.qw * q.qx + 2.0f * q.qy * q.qz;
+    ray[2] = -tmp;
   } else {
     target[0] = 0.0f; target[1] = 0.0f;
   }
   if(controllerState.GetRecentered()) {
     target[0] = 0.0f; target[1] = 0.0f;
+    ray[0] = 0.0f; ray[1] = 0.0f; ray[2] = -1.0f;
   }
-  glBufferSubData(GL_UNIFORM_BUFFER, sizeof(gvr::Mat4f),
-    sizeof(target), (GLvoid*)target);
-
-  // Determine which button is pressed, if any
-  bool changed = false;
-  int oldSelectedHost = selectedHost;
-  selectedHost = -1;
-  for(int i=0; i<numOffsets; i+=2) {
-    if((target[0] > (offsets[i] - HOST_WIDTH/2)) &&
-      (target[0] < (offsets[i] + HOST_WIDTH/2)) &&
-      (target[1] > (offsets[i+1] - HOST_HEIGHT)) &&
-      (target[1] < offsets[i+1])) {
-        selectedHost = i/2;
-        if(oldSelectedHost != i/2) {
-          changed = true;
-        }
-        break;
-      }
+
+  // Determine which host the ray hits, if any
+  PROFILE_NEXT(phaseTimer, PHASE_SELECTION);
+  selectedHost = picker.Pick(RAY_ORIGIN, ray);
+  if(selectedHost != -1) {
+    selectedOffset[0] = offsets[2*selectedHost];
+    selectedOffset[1] = offsets[2*selectedHost+1];
   }
 
-  if(changed) {
+  // Write the detail box for the selected host, or drop the selection if
+  // it doesn't fit
+  PROFILE_NEXT(phaseTimer, PHASE_UNIFORMS);
+  if(selectedHost != -1 && !StreamSelection()) {
+    selectedHost = -1;
+  }
 
-    // Update selectedHost uniform
-    glBufferSubData(GL_UNIFORM_BUFFER, sizeof(gvr::Mat4f) + sizeof(target) + sizeof(offsets),
-      sizeof(selectedHost), (GLvoid*)&selectedHost);
+  // Write this frame's uniforms, one block per pass
+  viewports->GetBufferViewport(0, &buffViewport);
+  eyeMatrices[0] = EyeMatrix(GVR_LEFT_EYE, buffViewport);
+  viewports->GetBufferViewport(1, &buffViewport);
+  eyeMatrices[1] = EyeMatrix(GVR_RIGHT_EYE, buffViewport);
+  if(multiview) {
+    uniformOffsets[0] = WriteUniforms(eyeMatrices, 2);
+  } else {
+    uniformOffsets[0] = WriteUniforms(&eyeMatrices[0], 1);
+    uniformOffsets[1] = WriteUniforms(&eyeMatrices[1], 1);
+  }
 
-    // Update the box VBO
+  // Grow the instance buffers when full. The old contents are discarded
+  // and re-uploaded from the CPU copies below.
+  PROFILE_NEXT(phaseTimer, PHASE_UPLOAD);
+  if(hosts.size() > hostCapacity) {
+    while(hosts.size() > hostCapacity) {
+      hostCapacity *= 2;
+    }
     glBindBuffer(GL_ARRAY_BUFFER, vbos[3]);
-    unsigned int len = hosts[selectedHost].box.size();
-    GLsizeiptr dataSize = (GLsizeiptr)len * sizeof(float);
-    GLfloat* vertexBuffer =
-      (GLfloat*)glMapBufferRange(GL_ARRAY_BUFFER, 0, dataSize, GL_MAP_WRITE_BIT);
-    std::copy(hosts[selectedHost].box.data(), hosts[selectedHost].box.data() + len, vertexBuffer);
-    glUnmapBuffer(GL_ARRAY_BUFFER);
-
-    // Update the box text VBO
-    glBindBuffer(GL_ARRAY_BUFFER, vbos[4]);
-    len = hosts[selectedHost].text.size();
-    dataSize = (GLsizeiptr)len * sizeof(float);
-    vertexBuffer = (GLfloat*)glMapBufferRange(GL_ARRAY_BUFFER, 0, dataSize, GL_MAP_WRITE_BIT);
-    std::copy(hosts[selectedHost].text.data(), hosts[selectedHost].text.data() + len, vertexBuffer);
-    glUnmapBuffer(GL_ARRAY_BUFFER);
-    
-    // Update the box text IBO
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibos[1]);
-    dataSize = (GLsizeiptr)hosts[selectedHost].textIndices.size();
-    GLubyte* indexBuffer =
-      (GLubyte*)glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, 0, dataSize, GL_MAP_WRITE_BIT);
-    std::copy(hosts[selectedHost].textIndices.data(), hosts[selectedHost].textIndices.data() + dataSize, indexBuffer);
-    glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
-  }
-
-  // Update host data
-  if(hostReady) {
-
-    // Update offsets
-    glBufferSubData(GL_UNIFORM_BUFFER, sizeof(gvr::Mat4f) + sizeof(target),
-      2*(GLsizeiptr)hosts.size()*sizeof(float), (GLvoid*)offsets);
-
-    // Update the text VBO
+    glBufferData(GL_ARRAY_BUFFER, 2*hostCapacity*sizeof(GLfloat), NULL, GL_DYNAMIC_DRAW);
     glBindBuffer(GL_ARRAY_BUFFER, vbos[2]);
-    unsigned int len = textVertices.size();
-    GLsizeiptr dataSize = (GLsizeiptr)len * sizeof(textVertices[0]);
-    GLfloat* vertexBuffer =
-      (GLfloat*)glMapBufferRange(GL_ARRAY_BUFFER, 0, dataSize, GL_MAP_WRITE_BIT);
-    std::copy(textVertices.data(), textVertices.data() + len, vertexBuffer);
-    glUnmapBuffer(GL_ARRAY_BUFFER);
-
-    // Update the text IBO
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibos[0]);
-    len = textIndices.size();
-    dataSize = (GLsizeiptr)len * sizeof(textIndices[0]);
-        
-    GLushort* indexBuffer =
-      (GLushort*)glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, 0, dataSize, GL_MAP_WRITE_BIT);
-    std::copy(textIndices.data(), textIndices.data() + dataSize, indexBuffer);
-    glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
-
-    hostReady = false;
-    state = SCAN_FINISHED;
+    glBufferData(GL_ARRAY_BUFFER, MAX_LABEL_CHARS*hostCapacity*sizeof(LabelGlyph),
+      NULL, GL_DYNAMIC_DRAW);
+    numUploadedHosts = 0;
   }
 
-  // Acquire the frame and bind it
-  gvr::Frame frame = swapChain->AcquireFrame();
-  frame.BindBuffer(0);
+  // Upload the offsets and labels of hosts added since the last frame
+  // through the stream buffer. Whatever doesn't fit in this frame's region
+  // goes up next frame.
+  if(numUploadedHosts < hosts.size()) {
+    GLuint count = std::min((GLuint)hosts.size() - numUploadedHosts,
+      (GLuint)(stream.Available(sizeof(GLfloat)) /
+        (2*sizeof(GLfloat) + MAX_LABEL_CHARS*sizeof(LabelGlyph))));
+    if(StreamCopy(vbos[3], 2*numUploadedHosts*sizeof(GLfloat),
+         &offsets[2*numUploadedHosts], 2*count*sizeof(GLfloat)) &&
+       StreamCopy(vbos[2], MAX_LABEL_CHARS*numUploadedHosts*sizeof(LabelGlyph),
+         &labelGlyphs[MAX_LABEL_CHARS*numUploadedHosts],
+         MAX_LABEL_CHARS*count*sizeof(LabelGlyph))) {
+      numUploadedHosts += count;
+      PROFILE_COUNT(profiler, COUNTER_HOSTS_UPLOADED, count);
+    }
+  }
+
+  // Rewrite the offsets and label slots of uploaded hosts that were
+  // renamed, lost or replaced
+  while(!changedHosts.empty() && stream.Available(sizeof(GLfloat)) >=
+        (GLsizeiptr)(2*sizeof(GLfloat) + MAX_LABEL_CHARS*sizeof(LabelGlyph))) {
+    unsigned int index = changedHosts.back();
+    if(index < numUploadedHosts &&
+       !(StreamCopy(vbos[3], 2*index*sizeof(GLfloat), &offsets[2*index], 2*sizeof(GLfloat)) &&
+         StreamCopy(vbos[2], MAX_LABEL_CHARS*index*sizeof(LabelGlyph),
+           &labelGlyphs[MAX_LABEL_CHARS*index], MAX_LABEL_CHARS*sizeof(LabelGlyph)))) {
+      break;
+    }
+    changedHosts.pop_back();
+  }
 
-  // Set uniform buffer
-  glBindBuffer(GL_UNIFORM_BUFFER, ubos[0]);
+  // Upload the uniforms and detail box if they were staged
+  stream.Flush();
 
   // Set the clear color
   glClearColor(0.0f, 0.30f, 0.25f, 1.0f);
-  viewports->GetBufferViewport(0, &buffViewport);
-  RenderEye(GVR_LEFT_EYE, buffViewport);
-  viewports->GetBufferViewport(1, &buffViewport);
-  RenderEye(GVR_RIGHT_EYE, buffViewport);
+  if(multiview) {
+    PROFILE_NEXT(phaseTimer, PHASE_MULTIVIEW);
+    RenderMultiview();
+  }
+
+  // Acquire the frame and bind it
+  PROFILE_NEXT(phaseTimer, PHASE_ACQUIRE);
+  gvr::Frame frame = swapChain->AcquireFrame();
+  frame.BindBuffer(0);
+
+  if(multiview) {
+
+    // Copy each layer into its eye's half of the frame
+    PROFILE_NEXT(phaseTimer, PHASE_BLIT);
+    glDisable(GL_SCISSOR_TEST);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, blitFbo);
+    for(int i=0; i<2; ++i) {
+      viewports->GetBufferViewport(i, &buffViewport);
+      const gvr::Rectf& rect = buffViewport.GetSourceUv();
+      int left = static_cast<int>(rect.left * renderSize.width);
+      int bottom = static_cast<int>(rect.bottom * renderSize.height);
+      int right = static_cast<int>(rect.right * renderSize.width);
+      int top = static_cast<int>(rect.top * renderSize.height);
+      glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, multiviewTex, 0, i);
+      glBlitFramebuffer(0, 0, eyeSize.width, eyeSize.height,
+        left, bottom, right, top, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    }
+    glEnable(GL_SCISSOR_TEST);
+  } else {
+    PROFILE_NEXT(phaseTimer, PHASE_LEFT_EYE);
+    viewports->GetBufferViewport(0, &buffViewport);
+    RenderEye(GVR_LEFT_EYE, buffViewport);
+    PROFILE_NEXT(phaseTimer, PHASE_RIGHT_EYE);
+    viewports->GetBufferViewport(1, &buffViewport);
+    RenderEye(GVR_RIGHT_EYE, buffViewport);
+  }
+  PROFILE_NEXT(phaseTimer, PHASE_SUBMIT);
 
   glBindVertexArray(0);
 
-  // Unbind the frame
+  // Unbind the frame and fence this frame's stream region
   frame.Unbind();
+  PROFILE_COUNT(profiler, COUNTER_STREAM_BYTES, stream.Used());
+  stream.EndFrame();
 
   // Submit the frame
   frame.Submit(*viewports, headMatrix);
+
+  // Report startup latency
+  if(firstFrame) {
+    float startupMs = std::chrono::duration<float, std::milli>(
+      std::chrono::steady_clock::now() - createTime).count();
+    __android_log_print(ANDROID_LOG_INFO, TAG,
+      "First frame submitted %.1f ms after renderer creation", startupMs);
+  }
   firstFrame = false;
 }
 
@@ -561,134 +961,341 @@ void WiFiDiscoveryRenderer::RenderEye(gvr::Eye eye,
   glViewport(left, bottom, width, height);
   glScissor(left, bottom, width, height);
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-  glBindTexture(GL_TEXTURE_2D, tids[0]);
 
-  // Compute the MVP matrix
+  // Use this eye's uniform block
+  glBindBufferRange(GL_UNIFORM_BUFFER, 0, stream.Buffer(),
+    uniformOffsets[eye], UBO_SIZE);
+
+#ifdef FRAME_PROFILING
+  gpuTimer.SetView(eye == GVR_LEFT_EYE ? VIEW_LEFT : VIEW_RIGHT);
+#endif
+  RenderScene();
+}
+
+void WiFiDiscoveryRenderer::RenderMultiview() {
+
+  // One uniform block holds both eye matrices
+  glBindBufferRange(GL_UNIFORM_BUFFER, 0, stream.Buffer(),
+    uniformOffsets[0], UBO_SIZE);
+
+  // Draw both layers at once
+  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, multiviewFbo);
+  glViewport(0, 0, eyeSize.width, eyeSize.height);
+  glScissor(0, 0, eyeSize.width, eyeSize.height);
+  glClear(GL_COLOR_BUFFER_BIT);
+#ifdef FRAME_PROFILING
+  gpuTimer.SetView(VIEW_BOTH);
+#endif
+  RenderScene();
+  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+}
+
+gvr::Mat4f WiFiDiscoveryRenderer::EyeMatrix(gvr::Eye eye,
+  const gvr::BufferViewport& vport) {
+
+  // The projection only changes with the field of view
+  gvr::Rectf fov = vport.GetSourceFov();
+  if(!(fov == eyeFovs[eye])) {
+    eyeFovs[eye] = fov;
+    eyeProjections[eye] = MatrixUtils::Perspective(fov, near, far);
+  }
+
+  // Compute the MVP matrix in GL's column-major order
   gvr::Mat4f viewMatrix = MatrixUtils::MultiplyMM(
     gvrApi->GetEyeFromHeadMatrix(eye), headMatrix);
-  gvr::Mat4f projMatrix =
-    MatrixUtils::Perspective(vport.GetSourceFov(), near, far);
-  gvr::Mat4f mvpMatrix =
-    MatrixUtils::MultiplyMM(projMatrix, viewMatrix);
-  gvr::Mat4f lastMatrix = MatrixUtils::Transpose(mvpMatrix);
+  return MatrixUtils::MultiplyMMTranspose(eyeProjections[eye], viewMatrix);
+}
+
+GLintptr WiFiDiscoveryRenderer::WriteUniforms(const gvr::Mat4f* matrices, int count) {
+
+  // The uniforms are written right after the detail box, which
+  // StreamSelection leaves room for
+  GLintptr offset;
+  GLubyte* block = (GLubyte*)stream.Allocate(UBO_SIZE, uboAlignment, &offset);
+  if(!block) {
+    __android_log_print(ANDROID_LOG_ERROR, TAG, "No room for uniforms in the stream buffer");
+    exit(EXIT_FAILURE);
+  }
+  memcpy(block, matrices, count*sizeof(gvr::Mat4f));
+  memcpy(block + UBO_TARGET, target, sizeof(target));
+  memcpy(block + UBO_SELECTED_OFFSET, selectedOffset, sizeof(selectedOffset));
+  memcpy(block + UBO_SELECTED_INDEX, &selectedHost, sizeof(selectedHost));
+  return offset;
+}
+
+bool WiFiDiscoveryRenderer::StreamSelection() {
+
+  // Leave room for both uniform blocks after the box
+  WiFiHost& host = hosts[selectedHost];
+  GLsizeiptr size = (host.box.size() + host.text.size())*sizeof(GLfloat);
+  if(stream.Available(sizeof(GLfloat)) < size + 2*(UBO_SIZE + uboAlignment)) {
+    return false;
+  }
+
+  // Point the box VAO at this frame's copy of the box vertices
+  GLintptr offset;
+  GLfloat* boxData = (GLfloat*)stream.Allocate(
+    host.box.size()*sizeof(GLfloat), sizeof(GLfloat), &offset);
+  std::copy(host.box.begin(), host.box.end(), boxData);
+  glBindVertexArray(vaos[5]);
+  glBindBuffer(GL_ARRAY_BUFFER, stream.Buffer());
+  glVertexAttribPointer(boxAttribs[0], 2,
+    GL_FLOAT, GL_FALSE, 3*sizeof(GLfloat), (GLvoid*)offset);
+  glVertexAttribPointer(boxAttribs[1], 1,
+    GL_FLOAT, GL_FALSE, 3*sizeof(GLfloat), (GLvoid*)(offset + 2*sizeof(GLfloat)));
+
+  // Do the same for the box text glyph instances
+  GLfloat* textData = (GLfloat*)stream.Allocate(
+    host.text.size()*sizeof(GLfloat), sizeof(GLfloat), &offset);
+  std::copy(host.text.begin(), host.text.end(), textData);
+  glBindVertexArray(vaos[6]);
+  glVertexAttribPointer(boxTextAttribs[0], 4,
+    GL_FLOAT, GL_FALSE, 8*sizeof(GLfloat), (GLvoid*)offset);
+  glVertexAttribPointer(boxTextAttribs[1], 4,
+    GL_FLOAT, GL_FALSE, 8*sizeof(GLfloat), (GLvoid*)(offset + 4*sizeof(GLfloat)));
+  glBindVertexArray(0);
+  return true;
+}
+
+bool WiFiDiscoveryRenderer::StreamCopy(GLuint buffer, GLintptr dstOffset,
+  const void* data, GLsizeiptr size) {
 
-  // Pass MVP matrix to shader
-  glBufferSubData(GL_UNIFORM_BUFFER, 0,
-    sizeof(gvr::Mat4f), (GLvoid*)lastMatrix.m);
+  if(size == 0) {
+    return true;
+  }
+
+  // Stage the data in the stream buffer and let the GPU copy it
+  GLintptr offset;
+  void* staging = stream.Allocate(size, sizeof(GLfloat), &offset);
+  if(!staging) {
+    return false;
+  }
+  memcpy(staging, data, size);
+  stream.Flush();
+  glBindBuffer(GL_COPY_READ_BUFFER, stream.Buffer());
+  glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+  glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, offset, dstOffset, size);
+  return true;
+}
+
+void WiFiDiscoveryRenderer::RenderScene() {
+
+  glBindTexture(GL_TEXTURE_2D, tids[0]);
 
   switch(state) {
 
     case NOT_CONNECTED:
 
       // Draw not connected message
+      GPU_PASS_BEGIN(gpuTimer, PASS_MESSAGES);
       glUseProgram(programs[0]);
       glBindVertexArray(vaos[0]);
       glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
       glBindVertexArray(0);
+      GPU_PASS_END(gpuTimer);
       break;
 
     case SCANNING:
 
       // Draw scanning process message
+      GPU_PASS_BEGIN(gpuTimer, PASS_MESSAGES);
       glUseProgram(programs[0]);
       glBindVertexArray(vaos[0]);
       glDrawArrays(GL_TRIANGLE_STRIP, 4, 4);
       glBindVertexArray(0);
+      GPU_PASS_END(gpuTimer);
 
       // Draw spinner
-      glUseProgram(programs[1]);
-      glBindVertexArray(vaos[1]);
-      glDrawArrays(GL_LINE_STRIP, 0, spinnerSegments);
-      glBindVertexArray(0);
+      if(programReady[1]) {
+        GPU_PASS_BEGIN(gpuTimer, PASS_SPINNER);
+        glUseProgram(programs[1]);
+        glBindVertexArray(vaos[1]);
+        glDrawArrays(GL_LINE_STRIP, 0, spinnerSegments);
+        glBindVertexArray(0);
+        GPU_PASS_END(gpuTimer);
+      }
       break;
 
     case SCAN_FINISHED:
+      break;
+  }
 
-      // Draw hosts
+  // Hosts are drawn as soon as they arrive
+  if(state != NOT_CONNECTED && !hosts.empty()) {
+
+    // Draw hosts
+    if(programReady[3]) {
+      GPU_PASS_BEGIN(gpuTimer, PASS_HOSTS);
       glBindTexture(GL_TEXTURE_2D, tids[0]);
       glUseProgram(programs[3]);
       glBindVertexArray(vaos[3]);
-      glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, hosts.size());
+      glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, numUploadedHosts);
       glBindVertexArray(0);
+      GPU_PASS_END(gpuTimer);
+    }
 
-      // Draw text
-      glUseProgram(programs[0]);
+    // Draw labels
+    if(programReady[6]) {
+      GPU_PASS_BEGIN(gpuTimer, PASS_LABELS);
+      glUseProgram(programs[6]);
       glBindVertexArray(vaos[4]);
-      glDrawElements(GL_TRIANGLE_STRIP, numIndices, GL_UNSIGNED_SHORT, (void*)0);
+      glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, MAX_LABEL_CHARS*numUploadedHosts);
       glBindVertexArray(0);
+      GPU_PASS_END(gpuTimer);
+    }
 
-      if(selectedHost != -1) {
+    // The box and its text need both programs
+    if(selectedHost != -1 && programReady[4] && programReady[5]) {
 
-        // Draw box and border
-        glUseProgram(programs[4]);
-        glBindVertexArray(vaos[5]);
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-        glDrawArrays(GL_LINE_LOOP, 4, 4);
-        glBindVertexArray(0);
+      // Draw box and border
+      GPU_PASS_BEGIN(gpuTimer, PASS_BOX);
+      glUseProgram(programs[4]);
+      glBindVertexArray(vaos[5]);
+      glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+      glDrawArrays(GL_LINE_LOOP, 4, 4);
+      glBindVertexArray(0);
 
-        // Draw text
-        glUseProgram(programs[5]);
-        glBindVertexArray(vaos[6]);
-        glDrawElements(GL_TRIANGLE_STRIP, hosts[selectedHost].textIndices.size(), GL_UNSIGNED_BYTE, (void*)0);
-        glBindVertexArray(0);
-      }
+      // Draw text
+      glUseProgram(programs[5]);
+      glBindVertexArray(vaos[6]);
+      glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, hosts[selectedHost].text.size()/8);
+      glBindVertexArray(0);
+      GPU_PASS_END(gpuTimer);
+    }
 
-      // Draw pointer
+    // Draw pointer
+    if(programReady[2]) {
+      GPU_PASS_BEGIN(gpuTimer, PASS_POINTER);
       glUseProgram(programs[2]);
       glBindVertexArray(vaos[2]);
       glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
       glBindVertexArray(0);
-      break;
+      GPU_PASS_END(gpuTimer);
+    }
   }
 }
 
+void WiFiDiscoveryRenderer::StartScan(const std::string& address, int prefixLength,
+  const std::string& ssid, const std::string& bssid, const std::string& dnsServer) {
+
+  struct in_addr addr, dnsAddr;
+  if(inet_pton(AF_INET, address.c_str(), &addr) != 1) {
+    __android_log_print(ANDROID_LOG_ERROR, TAG, "Invalid address %s", address.c_str());
+    return;
+  }
+
+  // Without a DNS server, hosts are named by their addresses
+  if(inet_pton(AF_INET, dnsServer.c_str(), &dnsAddr) != 1) {
+    dnsAddr.s_addr = 0;
+  }
+
+  // Name this network's host cache after its SSID, BSSID and subnet, and
+  // hand it to the GL thread
+  if(!hostCacheDir.empty()) {
+    uint32_t mask = (prefixLength > 0) ? ~0u << (32 - std::min(prefixLength, 32)) : 0;
+    char subnet[32], fileName[40];
+    snprintf(subnet, sizeof(subnet), "/%08x/%d", ntohl(addr.s_addr) & mask, prefixLength);
+    networkHash = ShaderUtils::Hash(ssid + "/" + bssid + subnet);
+    snprintf(fileName, sizeof(fileName), "/hosts_%016llx.bin", (unsigned long long)networkHash);
+    hostCachePath = hostCacheDir + fileName;
+    hostCacheReady.store(true, std::memory_order_release);
+  }
+
+  // Hits, losses, progress and completion are reported from the scanner's
+  // threads. The scanner keeps watching the network after the first sweep.
+  scanner.reset(new NetworkScanner(
+    [this](const std::string& host) { AddHost(host); },
+    [this](uint32_t address) { LoseHost(address); },
+    [this]() { PublishProgress(); },
+    [this]() { SetScanComplete(); }));
+  scanner->Start(ntohl(addr.s_addr), prefixLength, ntohl(dnsAddr.s_addr), true);
+}
+
+WiFiDiscoveryRenderer::WiFiHost* WiFiDiscoveryRenderer::QueueSlot() {
+
+  // Wait for the GL thread to free a slot. Nothing drains the queue while
+  // the app is paused, so sleep until DrainHosts or the destructor wakes us.
+  WiFiHost* slot = hostQueue.Back();
+  if(slot == NULL) {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    queueSpace.wait(lock, [this, &slot]() {
+      return closing || (slot = hostQueue.Back()) != NULL;
+    });
+  }
+  return closing ? NULL : slot;
+}
+
 void WiFiDiscoveryRenderer::AddHost(std::string hostString) {
 
-  WiFiHost host;
-  std::string name;
-  TextureChar ch;
-  GLuint len;
+  WiFiHost* slot = QueueSlot();
+  if(slot == NULL) {
+    return;
+  }
+  BuildHost(*slot, hostString);
+  slot->live = true;
+  slot->removed = false;
+  hostQueue.Push();
+}
+
+void WiFiDiscoveryRenderer::LoseHost(uint32_t address) {
+
+  WiFiHost* slot = QueueSlot();
+  if(slot == NULL) {
+    return;
+  }
+  slot->address = address;
+  slot->removed = true;
+  hostQueue.Push();
+}
+
+void WiFiDiscoveryRenderer::BuildHost(WiFiHost& host, const std::string& hostString) {
+
   float displayScale = DISPLAY_TEXT_HEIGHT/atlas.lineHeight;
   float boxScale = BOX_TEXT_HEIGHT/atlas.lineHeight;
 
-  // Separate host name from IP address
-  size_t colonPos = hostString.find(":");
-  host.hostName = hostString.substr(0, colonPos);
-  host.ipAddr = hostString.substr(colonPos+1, hostString.length() - colonPos);  
+  // Everything is assigned in place, so a queue slot reuses the storage
+  // of the hosts it carried before
+  host.box.clear();
+  host.text.clear();
+
+  // Separate host name from IP address, which follows the last colon
+  size_t colonPos = hostString.rfind(':');
+  host.ipAddr.assign(hostString, colonPos + 1, std::string::npos);
+  host.pending = (colonPos == 0);
+  if(host.pending) {
+    host.hostName.assign(host.ipAddr);
+  } else {
+    host.hostName.assign(hostString, 0, colonPos);
+  }
+  struct in_addr addr;
+  host.address = (inet_pton(AF_INET, host.ipAddr.c_str(), &addr) == 1) ? ntohl(addr.s_addr) : 0;
   if(host.hostName.length() < 9) {
-    host.displayName = host.hostName;
+    host.displayName.assign(host.hostName);
   } else {
-    host.displayName = host.hostName.substr(0, 7).append("...");
+    host.displayName.assign(host.hostName, 0, 7).append("...");
   }
-  numDisplayChars += host.displayName.length();
-  host.hostName.insert(0, "Host: ");
+  host.hostName.insert(0, HOST_PREFIX);
   host.ipAddr.insert(0, "IP Address: ");
 
   // Get display width
   host.displayWidth = 0.0f;
-  name = host.displayName;
-  len = name.length();
-  for(unsigned int i=0; i<len; ++i) {
-    ch = atlas.charMap[name[i]];
-    host.displayWidth += ch.xAdvance * displayScale;
+  for(unsigned int i=0; i<host.displayName.length(); ++i) {
+    host.displayWidth += TextUtils::Glyph(atlas, (unsigned char)host.displayName[i]).xAdvance *
+      displayScale;
   }
 
   // Get hostname width
   host.hostWidth = 0.0f;
-  name = host.hostName;
-  len = name.length();
-  for(unsigned int i=0; i<len; ++i) {
-    ch = atlas.charMap[name[i]];
-    host.hostWidth += ch.xAdvance * boxScale;
+  for(unsigned int i=0; i<host.hostName.length(); ++i) {
+    host.hostWidth += TextUtils::Glyph(atlas, (unsigned char)host.hostName[i]).xAdvance *
+      boxScale;
   }
 
   // Get IP address width
   host.ipWidth = 0.0f;
-  name = host.ipAddr;
-  len = name.length();
-  for(unsigned int i=0; i<len; ++i) {
-    ch = atlas.charMap[name[i]];
-    host.ipWidth += ch.xAdvance * boxScale;
+  for(unsigned int i=0; i<host.ipAddr.length(); ++i) {
+    host.ipWidth += TextUtils::Glyph(atlas, (unsigned char)host.ipAddr[i]).xAdvance *
+      boxScale;
   }
 
   // Generate vertices for the box/border
@@ -706,87 +1313,261 @@ void WiFiDiscoveryRenderer::AddHost(std::string hostString) {
   host.box.push_back(-boxWidth/2.0f); host.box.push_back(0.0f); host.box.push_back(BORDER_COLOR);
   host.box.push_back(boxWidth/2.0f); host.box.push_back(0.0f); host.box.push_back(BORDER_COLOR);
 
-  // Generate vertices for the host name
-  unsigned int numBoxChars = host.hostName.length() + host.ipAddr.length();
-  host.text.reserve(16 * numBoxChars);
+  // Generate glyph instances for the host name and IP address
   float x = -1.0f * maxWidth/2.0f;
-  TextUtils::GenerateVertices(host.hostName, host.text, x, HOST_TEXT_SPACING, boxScale, atlas);
+  TextRun runs[2] = {
+    {&host.hostName, x, HOST_TEXT_SPACING},
+    {&host.ipAddr, x, IP_TEXT_SPACING}};
+  TextUtils::GenerateInstances(runs, 2, host.text, boxScale, atlas);
+}
 
-  // Generate vertices for the IP address
-  x = -1.0f * maxWidth/2.0f;
-  TextUtils::GenerateVertices(host.ipAddr, host.text, x, IP_TEXT_SPACING, boxScale, atlas);
+void WiFiDiscoveryRenderer::DrainHosts() {
+
+  // Slots are copied rather than moved from, so they keep their buffers
+  // for the producer. Copying into an existing host reuses its storage.
+  WiFiHost* slot;
+  bool hidden = false, drained = false;
+  while((slot = hostQueue.Front()) != NULL) {
+
+    // A live host takes over the cached host at its address, keeping its
+    // place on the wall. Only a changed name needs a new label.
+    std::unordered_map<uint32_t, unsigned int>::iterator it = hostIndices.find(slot->address);
+    if(slot->removed) {
+      if(it != hostIndices.end()) {
+        HideHost(it->second);
+        hidden = true;
+      }
+    } else if(it != hostIndices.end()) {
+
+      // A cached host keeps its name while the live one's is looked up
+      WiFiHost& host = hosts[it->second];
+      if(slot->pending) {
+        host.live = true;
+      } else {
+        bool renamed = host.hostName != slot->hostName;
+        host = *slot;
+        if(renamed) {
+          WriteLabel(it->second);
+          changedHosts.push_back(it->second);
+        }
+      }
+    } else if(!freeHosts.empty()) {
+
+      // New hosts fill the earliest empty place first
+      unsigned int index = freeHosts.front();
+      std::pop_heap(freeHosts.begin(), freeHosts.end(), std::greater<unsigned int>());
+      freeHosts.pop_back();
+      hostIndices[slot->address] = index;
+      hosts[index] = *slot;
+      PlaceHost(index);
+      changedHosts.push_back(index);
+    } else if(hosts.size() < MAX_HOSTS) {
+      hostIndices[slot->address] = hosts.size();
+      hosts.push_back(*slot);
+      PlaceHost(hosts.size() - 1);
+    }
+    hostQueue.Pop();
+    hostCacheDirty = true;
+    drained = true;
+  }
 
-  // Generate indices for the box text
-  host.textIndices.reserve(5 * numBoxChars);
-  for(unsigned int i=0; i<numBoxChars; i++) {
-    host.textIndices.push_back((GLubyte)(4*i));
-    host.textIndices.push_back((GLubyte)(4*i+1));
-    host.textIndices.push_back((GLubyte)(4*i+2));
-    host.textIndices.push_back((GLubyte)(4*i+3));
-    host.textIndices.push_back(0xff);
+  // Wake the producer if it's waiting for space. Taking the lock orders
+  // this after its last check of the queue.
+  if(drained) {
+    {
+      std::lock_guard<std::mutex> lock(queueMutex);
+    }
+    queueSpace.notify_one();
+  }
+  if(hidden) {
+    TrimHosts();
   }
+}
 
-  hosts.push_back(host);
+void WiFiDiscoveryRenderer::HideHost(unsigned int hostIndex) {
+
+  // Park the button out of sight, blank the label and let picks through
+  WiFiHost& host = hosts[hostIndex];
+  hostIndices.erase(host.address);
+  host.removed = true;
+  host.displayName.clear();
+  offsets[2*hostIndex] = 0.0f;
+  offsets[2*hostIndex+1] = HIDDEN_OFFSET;
+  WriteLabel(hostIndex);
+  picker.Remove(hostIndex);
+  changedHosts.push_back(hostIndex);
+  freeHosts.push_back(hostIndex);
+  std::push_heap(freeHosts.begin(), freeHosts.end(), std::greater<unsigned int>());
 }
 
-void WiFiDiscoveryRenderer::SetScanComplete() {
+void WiFiDiscoveryRenderer::TrimHosts() {
+
+  // Stop drawing empty places at the end of the wall
+  size_t numHosts = hosts.size();
+  while(!hosts.empty() && hosts.back().removed) {
+    hosts.pop_back();
+  }
+  if(hosts.size() == numHosts) {
+    return;
+  }
+  offsets.resize(2*hosts.size());
+  labelGlyphs.resize(MAX_LABEL_CHARS*hosts.size());
+  numUploadedHosts = std::min(numUploadedHosts, (GLuint)hosts.size());
+  size_t limit = hosts.size();
+  freeHosts.erase(std::remove_if(freeHosts.begin(), freeHosts.end(),
+    [limit](unsigned int index) { return index >= limit; }), freeHosts.end());
+  std::make_heap(freeHosts.begin(), freeHosts.end(), std::greater<unsigned int>());
+  changedHosts.erase(std::remove_if(changedHosts.begin(), changedHosts.end(),
+    [limit](unsigned int index) { return index >= limit; }), changedHosts.end());
+}
+
+void WiFiDiscoveryRenderer::LoadHostCache() {
+
+  if(hostCacheLoaded || !hostCacheReady.load(std::memory_order_acquire)) {
+    return;
+  }
+  hostCacheLoaded = true;
+  std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+  HostCache cache;
+  if(!cache.Open(hostCachePath, networkHash)) {
+    return;
+  }
+
+  // Cached hosts are placed like live ones, but stay unconfirmed until
+  // the scan finds them again
+  char ip[INET_ADDRSTRLEN];
+  WiFiHost host;
+  unsigned int count = std::min(cache.Size(), (unsigned int)MAX_HOSTS);
+  for(unsigned int i=0; i<count; ++i) {
+    struct in_addr addr;
+    addr.s_addr = htonl(cache.Address(i));
+    inet_ntop(AF_INET, &addr, ip, sizeof(ip));
+    BuildHost(host, cache.Name(i) + ":" + ip);
+    host.live = false;
+    host.removed = false;
+    hostIndices[host.address] = hosts.size();
+    hosts.push_back(host);
+    PlaceHost(hosts.size() - 1);
+  }
+
+  float loadMs = std::chrono::duration<float, std::milli>(
+    std::chrono::steady_clock::now() - startTime).count();
+  __android_log_print(ANDROID_LOG_INFO, TAG, "Loaded %u cached hosts in %.1f ms",
+    count, loadMs);
+}
 
-  float x, y, x_limit, y_limit, displayScale;
-
-  // Determine rows and columns
-  unsigned int hostsPerRow;
-  unsigned int numHosts = hosts.size();
-  numOffsets = 2*numHosts;  
-  if(numHosts < 40) {
-    hostsPerRow = 8;
-  } else if(numHosts < 80) {
-    hostsPerRow = 10;    
-  } else if(numHosts < 160) {
-    hostsPerRow = 12;
+void WiFiDiscoveryRenderer::RemoveStaleHosts() {
+
+  // Empty the places of cached hosts the scan didn't find
+  for(unsigned int i=0; i<hosts.size(); ++i) {
+    if(!hosts[i].live && !hosts[i].removed) {
+      HideHost(i);
+    }
+  }
+  TrimHosts();
+}
+
+void WiFiDiscoveryRenderer::SaveHostCache() {
+
+  if(hostCachePath.empty()) {
+    return;
+  }
+
+  // Hand the writer a copy of the names, stripped of the prefix added for
+  // display. The writer holds the lock only to take the snapshot.
+  hostCacheDirty = false;
+  hostCacheSaveTime = std::chrono::steady_clock::now();
+  {
+    std::lock_guard<std::mutex> lock(hostCacheMutex);
+    hostCacheSnapshot.clear();
+    hostCacheSnapshot.reserve(hostIndices.size());
+    for(unsigned int i=0; i<hosts.size(); ++i) {
+      if(!hosts[i].removed) {
+        hostCacheSnapshot.push_back(CachedHost{hosts[i].address,
+          hosts[i].hostName.substr(HOST_PREFIX_LENGTH)});
+      }
+    }
+    hostCacheSnapshotPath = hostCachePath;
+    hostCacheSnapshotHash = networkHash;
+    hostCacheQueued = true;
+  }
+  if(hostCacheWriter.joinable()) {
+    hostCacheWake.notify_one();
   } else {
-    hostsPerRow = 16;
-  }
-  unsigned int numRows = numHosts/hostsPerRow;
-    
-  // Display full rows of hosts
-  x_limit = -1.0f * (HOST_WIDTH + HOST_HORIZ_SPACING) * (hostsPerRow - 1.0f)/2.0f;  
-  y_limit = (HOST_HEIGHT + HOST_VERT_SPACING) * (numRows - 1.0f)/2.0f;
-  for(unsigned int row=0; row<numRows; row++) {
-    for(unsigned int col=0; col<hostsPerRow; col++) {
-      offsets[2*(row*hostsPerRow + col)] = x_limit + col*(HOST_WIDTH + HOST_HORIZ_SPACING);
-      offsets[2*(row*hostsPerRow + col)+1] = y_limit - row*(HOST_HEIGHT + HOST_VERT_SPACING);
-    }    
-  }
-
-  // Display partial row of hosts
-  unsigned int index = numRows*hostsPerRow;
-  unsigned int numCols = numHosts - index;
-  x_limit = -1.0f * (HOST_WIDTH + HOST_HORIZ_SPACING) * (numCols - 1.0f)/2.0f;  
-  for(unsigned int col=0; col<numCols; col++) {
-    offsets[2*(index + col)] = x_limit + col*(HOST_WIDTH + HOST_HORIZ_SPACING);
-    offsets[2*(index + col)+1] = y_limit - numRows*(HOST_HEIGHT + HOST_VERT_SPACING);
-  }
-  
-  // Set dimensions
-  displayScale = DISPLAY_TEXT_HEIGHT/atlas.lineHeight;
-  textVertices.reserve(16 * numDisplayChars);
-  for(int hostIndex = 0; hostIndex < numHosts; hostIndex++) {
-    x = offsets[2*hostIndex] - hosts[hostIndex].displayWidth/2.0f;
-    y = offsets[2*hostIndex+1] - DISPLAY_TEXT_SPACING;
-    TextUtils::GenerateVertices(hosts[hostIndex].displayName, textVertices, x, y, displayScale, atlas);
-  }
-
-  // Set indices
-  numIndices = 5*numDisplayChars;
-  textIndices.reserve(5 * numDisplayChars);
-  for(unsigned short i=0; i<numDisplayChars; i++) {
-    textIndices.push_back((GLushort)(4*i));
-    textIndices.push_back((GLushort)(4*i+1));
-    textIndices.push_back((GLushort)(4*i+2));
-    textIndices.push_back((GLushort)(4*i+3));
-    textIndices.push_back((GLushort)0xffff);
-  }
-  hostReady = true;
+    hostCacheWriter = std::thread(&WiFiDiscoveryRenderer::WriteHostCache, this);
+  }
+}
+
+void WiFiDiscoveryRenderer::WriteHostCache() {
+
+  std::vector<CachedHost> snapshot;
+  std::string path;
+  uint64_t hash;
+  std::unique_lock<std::mutex> lock(hostCacheMutex);
+  while(true) {
+    hostCacheWake.wait(lock, [this]() { return hostCacheQueued || hostCacheStopping; });
+    if(!hostCacheQueued) {
+      return;
+    }
+    snapshot.swap(hostCacheSnapshot);
+    path = hostCacheSnapshotPath;
+    hash = hostCacheSnapshotHash;
+    hostCacheQueued = false;
+    lock.unlock();
+    if(!HostCache::Save(path, hash, snapshot)) {
+      __android_log_print(ANDROID_LOG_WARN, TAG, "Can't write %s", path.c_str());
+    }
+    lock.lock();
+  }
+}
+
+void WiFiDiscoveryRenderer::PlaceHost(unsigned int hostIndex) {
+
+  // Columns fill outward from the center so partial rows stay centered
+  // and earlier hosts never move
+  unsigned int row = hostIndex / HOSTS_PER_ROW;
+  unsigned int col = hostIndex % HOSTS_PER_ROW;
+  float side = (col % 2 == 1) ? -1.0f : 1.0f;
+  if(offsets.size() < 2*(hostIndex + 1)) {
+    offsets.resize(2*(hostIndex + 1));
+  }
+  offsets[2*hostIndex] = side * ((col + 1)/2) * (HOST_WIDTH + HOST_HORIZ_SPACING);
+  offsets[2*hostIndex+1] = WALL_TOP - row*(HOST_HEIGHT + HOST_VERT_SPACING);
+
+  // The host's button is the box the controller ray can hit
+  float x = offsets[2*hostIndex], y = offsets[2*hostIndex+1];
+  float boxMin[3] = {x - HOST_WIDTH/2, y - HOST_HEIGHT, PLAYER_DEPTH};
+  float boxMax[3] = {x + HOST_WIDTH/2, y, PLAYER_DEPTH};
+  picker.Set(hostIndex, boxMin, boxMax);
+
+  WriteLabel(hostIndex);
+}
+
+void WiFiDiscoveryRenderer::WriteLabel(unsigned int hostIndex) {
+
+  // Each host owns MAX_LABEL_CHARS glyph slots, so relabeling a host
+  // only rewrites its own slots. Unused slots hold the empty glyph.
+  if(labelGlyphs.size() < MAX_LABEL_CHARS*(hostIndex + 1)) {
+    labelGlyphs.resize(MAX_LABEL_CHARS*(hostIndex + 1));
+  }
+  LabelGlyph* glyphs = &labelGlyphs[MAX_LABEL_CHARS*hostIndex];
+  const std::string& name = hosts[hostIndex].displayName;
+
+  // Advance the pen across the label
+  float displayScale = DISPLAY_TEXT_HEIGHT/atlas.lineHeight;
+  float x = offsets[2*hostIndex] - hosts[hostIndex].displayWidth/2.0f;
+  float y = offsets[2*hostIndex+1] - DISPLAY_TEXT_SPACING;
+  for(unsigned int i=0; i<MAX_LABEL_CHARS; ++i) {
+    GLuint code = (i < name.length()) ? (unsigned char)name[i] : 0;
+    glyphs[i].pen[0] = x;
+    glyphs[i].pen[1] = y;
+    glyphs[i].glyph = code;
+    x += TextUtils::Glyph(atlas, code).xAdvance * displayScale;
+  }
+}
+
+void WiFiDiscoveryRenderer::SetScanComplete() {
+  scanComplete.store(true, std::memory_order_release);
 }
 
 void WiFiDiscoveryRenderer::SetState(int wifiState) {
@@ -801,12 +1582,31 @@ void WiFiDiscoveryRenderer::OnPause() {
   if(ready) {
     gvrApi->PauseTracking();
   }
+  if(scanner) {
+    scanner->SetPaused(true);
+  }
+
+  // Log where the CPU and GPU time went while running
+#ifdef FRAME_PROFILING
+  __android_log_print(ANDROID_LOG_INFO, TAG, "Frame statistics:\n%s", GetFrameStats().c_str());
+#endif
+}
+
+std::string WiFiDiscoveryRenderer::GetFrameStats() {
+#ifdef FRAME_PROFILING
+  return profiler.Report() + gpuTimer.Report();
+#else
+  return std::string();
+#endif
 }
 
 void WiFiDiscoveryRenderer::OnResume() {
   if(ready) {
     gvrApi->ResumeTracking();
   }
+  if(scanner) {
+    scanner->SetPaused(false);
+  }
 }
 
 void handleMessage(GLenum source​, GLenum type​, GLuint id​,
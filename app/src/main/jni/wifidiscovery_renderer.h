@@ -4,7 +4,15 @@
 #include <jni.h>
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
 
 #include <android/asset_manager_jni.h>
 #include <android/log.h>
@@ -16,21 +24,52 @@
 #include "vr/gvr/capi/include/gvr.h"
 #include "vr/gvr/capi/include/gvr_controller.h"
 
+#include "assetbundle.h"
+#include "frameprofiler.h"
+#include "gputimer.h"
+#include "hostcache.h"
+#include "hostpicker.h"
 #include "matrixutils.h"
+#include "networkscanner.h"
 #include "shaderutils.h"
+#include "spscqueue.h"
+#include "streambuffer.h"
 #include "textutils.h"
 
 #define NUM_VAOS 7
 #define NUM_VBOS 5
-#define NUM_IBOS 2
-#define NUM_UBOS 1
-#define NUM_TEXTURES 1
-#define NUM_PROGRAMS 6
+#define NUM_TEXTURES 2
+#define NUM_PROGRAMS 7
+#define MAX_HOSTS 65536
+#define HOST_QUEUE_SIZE 256
+#define MAX_LABEL_CHARS 10
+
+// OVR_multiview entry points, declared here when the platform headers lack them
+#ifndef GL_OVR_multiview
+#define GL_OVR_multiview 1
+typedef void (GL_APIENTRYP PFNGLFRAMEBUFFERTEXTUREMULTIVIEWOVRPROC) (GLenum target,
+  GLenum attachment, GLuint texture, GLint level, GLint baseViewIndex, GLsizei numViews);
+#endif
+#ifndef GL_OVR_multiview_multisampled_render_to_texture
+#define GL_OVR_multiview_multisampled_render_to_texture 1
+typedef void (GL_APIENTRYP PFNGLFRAMEBUFFERTEXTUREMULTISAMPLEMULTIVIEWOVRPROC) (GLenum target,
+  GLenum attachment, GLuint texture, GLint level, GLsizei samples, GLint baseViewIndex,
+  GLsizei numViews);
+#endif
+
+// KHR_parallel_shader_compile, likewise
+#ifndef GL_KHR_parallel_shader_compile
+#define GL_KHR_parallel_shader_compile 1
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+typedef void (GL_APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSKHRPROC) (GLuint count);
+#endif
 
 class WiFiDiscoveryRenderer {
 
   public:
-    WiFiDiscoveryRenderer(gvr_context_* gvrContext, AAssetManager* assetMgr);
+    WiFiDiscoveryRenderer(gvr_context_* gvrContext, AAssetManager* assetMgr,
+      const std::string& cachePath, const std::string& hostCachePath);
     ~WiFiDiscoveryRenderer();
 
     void OnSurfaceCreated();
@@ -41,7 +80,10 @@ class WiFiDiscoveryRenderer {
     void InitSpinner();
     void SetState(int state);
     void AddHost(std::string host);
+    void LoseHost(uint32_t address);
     void SetScanComplete();
+    void StartScan(const std::string& address, int prefixLength,
+      const std::string& ssid, const std::string& bssid, const std::string& dnsServer);
     void InitMessages();
     void InitPointer();
     void InitTextures();
@@ -49,9 +91,17 @@ class WiFiDiscoveryRenderer {
     void InitText();
     void InitBox();
     void InitBoxText();
+    void InitMultiview();
     void RenderEye(gvr::Eye eye, const gvr::BufferViewport& viewport);
+    void RenderMultiview();
+    void RenderScene();
+    gvr::Mat4f EyeMatrix(gvr::Eye eye, const gvr::BufferViewport& viewport);
     void PublishProgress();
 
+    // CPU phase and GPU pass statistics, empty when profiling is
+    // compiled out
+    std::string GetFrameStats();
+
   private:
     enum WiFiState { NOT_CONNECTED = 0, SCANNING = 1, SCAN_FINISHED = 2};
     WiFiState state;
@@ -60,40 +110,147 @@ class WiFiDiscoveryRenderer {
       std::string displayName, hostName, ipAddr;
       float displayWidth, hostWidth, ipWidth, maxWidth;
       std::vector<GLfloat> box;
-      std::vector<GLfloat> text;      
-      std::vector<GLubyte> textIndices;
+      std::vector<GLfloat> text;      // Two corners per glyph
+      uint32_t address;               // Host byte order
+      bool live;                      // Found by this scan, not just cached
+      bool removed;                   // Lost; in the queue, only the address is set
+      bool pending;                   // Found before its name was looked up
     } WiFiHost;
-    std::vector<WiFiHost> hosts;
-    float offsets[256];
+    std::deque<WiFiHost> hosts;
+
+    // One instance per label glyph. The vertex shader expands the quad from
+    // the glyph metrics block; glyph 0 is empty.
+    typedef struct {
+      GLfloat pen[2];
+      GLuint glyph;
+    } LabelGlyph;
+
+    // Per-host instance data, mirrored in vbos[3]
+    std::vector<GLfloat> offsets;
+    GLfloat selectedOffset[2];
+    GLuint hostCapacity;
+
+    // Controller hit testing against the hosts' buttons
+    HostPicker picker;
+
+    // Hosts found, renamed and lost by the scanner, handed to the GL thread.
+    // The producer sleeps on queueSpace while the queue is full.
+    SpscQueue<WiFiHost, HOST_QUEUE_SIZE> hostQueue;
+    std::atomic<bool> scanComplete, closing;
+    std::mutex queueMutex;
+    std::condition_variable queueSpace;
+    WiFiHost* QueueSlot();
+    void DrainHosts();
+    void PlaceHost(unsigned int hostIndex);
+    void BuildHost(WiFiHost& host, const std::string& hostString);
+
+    // Lost hosts leave their place on the wall empty, so nothing else moves.
+    // New hosts fill the earliest empty place, kept in a min-heap.
+    std::vector<unsigned int> freeHosts;
+    void HideHost(unsigned int hostIndex);
+    void TrimHosts();
+
+    // Hosts from the last scan of this network are shown until the live
+    // scan confirms, renames or drops them. The path is set by StartScan.
+    std::string hostCacheDir, hostCachePath;
+    uint64_t networkHash;
+    std::atomic<bool> hostCacheReady;
+    bool hostCacheLoaded;
+    std::unordered_map<uint32_t, unsigned int> hostIndices;
+    std::vector<unsigned int> changedHosts;
+    bool hostCacheDirty;
+    std::chrono::steady_clock::time_point hostCacheSaveTime;
+    void LoadHostCache();
+    void RemoveStaleHosts();
+    void SaveHostCache();
+
+    // Saves are written one at a time by a single thread, which skips to
+    // the latest snapshot if several were queued meanwhile
+    std::thread hostCacheWriter;
+    std::mutex hostCacheMutex;
+    std::condition_variable hostCacheWake;
+    std::vector<CachedHost> hostCacheSnapshot;
+    std::string hostCacheSnapshotPath;
+    uint64_t hostCacheSnapshotHash;
+    bool hostCacheQueued, hostCacheStopping;
+    void WriteHostCache();
 
     // Buffer descriptors
-    GLuint vaos[NUM_VAOS], vbos[NUM_VBOS], ibos[NUM_IBOS],
-      ubos[NUM_UBOS], tids[NUM_TEXTURES], programs[NUM_PROGRAMS];
+    GLuint vaos[NUM_VAOS], vbos[NUM_VBOS],
+      tids[NUM_TEXTURES], programs[NUM_PROGRAMS];
+
+    // Per-frame uniforms and selection data are written into the stream buffer
+    StreamBuffer stream;
+    GLint uboAlignment;
+    GLintptr uniformOffsets[2];
+    GLuint boxAttribs[2], boxTextAttribs[2];
+    // The streamers return false when this frame's region has no room left
+    GLintptr WriteUniforms(const gvr::Mat4f* matrices, int count);
+    bool StreamSelection();
+    bool StreamCopy(GLuint buffer, GLintptr dstOffset, const void* data, GLsizeiptr size);
 
     AAssetManager* assetManager;
+
+    // Packed assets, mapped while the surface is created
+    AssetBundle bundle;
+
+    // Directory for cached program binaries, empty to disable the cache
+    std::string cacheDir;
+    unsigned int numCachedPrograms;
+
+    // Programs are submitted together and finished as the driver completes
+    // them. Each is drawn only once it's ready.
+    bool parallelCompile;
+    bool programReady[NUM_PROGRAMS];
+    GLuint pendingShaders[NUM_PROGRAMS][2];
+    std::string cachePaths[NUM_PROGRAMS];
+    PFNGLMAXSHADERCOMPILERTHREADSKHRPROC glMaxShaderCompilerThreadsKHR;
+    void PollPrograms();
+    void FinishProgram(unsigned int index);
+    void SetupProgram(unsigned int index);
     std::unique_ptr<gvr::GvrApi> gvrApi;
     std::unique_ptr<gvr::SwapChain> swapChain;
     std::unique_ptr<gvr::BufferViewportList> viewports;
     gvr::BufferViewport buffViewport;
     gvr::Sizei renderSize;
     gvr::Mat4f headMatrix;
-    int selectedHost, spinnerSegments;
-    bool ready, firstFrame, hostReady;
+
+    // Per-eye projections and the fields of view they were built from
+    gvr::Rectf eyeFovs[2];
+    gvr::Mat4f eyeProjections[2];
+    int selectedHost;
+    std::atomic<int> spinnerSegments;
+    bool ready, firstFrame;
+    std::chrono::steady_clock::time_point createTime;
+#ifdef FRAME_PROFILING
+    FrameProfiler profiler;
+    GpuTimer gpuTimer;
+#endif
+
+    // Subnet sweep
+    std::unique_ptr<NetworkScanner> scanner;
 
     // Extension function
     PFNGLBUFFERSTORAGEEXTPROC glBufferStorageEXT;
 
+    // Single-pass stereo into a two-layer texture, blitted into the GVR frame
+    bool multiview;
+    GLuint multiviewFbo, blitFbo, multiviewTex;
+    gvr::Sizei eyeSize;
+    gvr::Mat4f eyeMatrices[2];
+    PFNGLFRAMEBUFFERTEXTUREMULTIVIEWOVRPROC glFramebufferTextureMultiviewOVR;
+    PFNGLFRAMEBUFFERTEXTUREMULTISAMPLEMULTIVIEWOVRPROC glFramebufferTextureMultisampleMultiviewOVR;
+
     // Controller
     std::unique_ptr<gvr::ControllerApi> controllerApi;
     gvr::ControllerState controllerState;
     float target[2];
 
     // Text
-    TextureAtlas atlas;
-    std::vector<GLfloat> textVertices;
-    std::vector<GLushort> textIndices;
-    GLuint numIndices, numDisplayChars;
-    unsigned int numOffsets;
+    const TextureAtlas& atlas;
+    std::vector<LabelGlyph> labelGlyphs;
+    GLuint numUploadedHosts;
+    void WriteLabel(unsigned int hostIndex);
 };
 
 #endif  // MEDIA_PLAYER_RENDERER_H_
\ No newline at end of file
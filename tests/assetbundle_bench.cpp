@@ -0,0 +1,107 @@
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <benchmark/benchmark.h>
+
+#include "assetbundle.h"
+
+// Startup asset loading: the packed bundle opened once with every file
+// found in it, against opening each source file on its own as before the
+// bundle. Both read every byte. Cold runs (1) drop the files from the page
+// cache before each iteration, warm runs (0) don't.
+//   assetbundle_bench --benchmark_counters_tabular=true
+
+static const std::string BUNDLE_PATH = std::string(ASSET_DIR) + "/wifi_discovery.pack";
+
+static std::vector<std::string> SourceNames() {
+  std::vector<std::string> names;
+  DIR* dir = opendir(ASSET_SRC_DIR);
+  if(dir) {
+    for(struct dirent* entry = readdir(dir); entry; entry = readdir(dir)) {
+      if(entry->d_name[0] != '.') {
+        names.push_back(entry->d_name);
+      }
+    }
+    closedir(dir);
+  }
+  std::sort(names.begin(), names.end());
+  return names;
+}
+
+static void DropFromCache(const std::string& path) {
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if(fd >= 0) {
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+  }
+}
+
+static unsigned int Checksum(const char* data, size_t size) {
+  unsigned int sum = 0;
+  for(size_t i=0; i<size; ++i) {
+    sum += (unsigned char)data[i];
+  }
+  return sum;
+}
+
+static void BM_OpenBundle(benchmark::State& state) {
+  std::vector<std::string> names = SourceNames();
+  for(auto _ : state) {
+    if(state.range(0)) {
+      state.PauseTiming();
+      DropFromCache(BUNDLE_PATH);
+      state.ResumeTiming();
+    }
+    AssetBundle bundle;
+    if(!bundle.Open(BUNDLE_PATH.c_str())) {
+      state.SkipWithError("can't open the bundle");
+      return;
+    }
+    unsigned int sum = 0;
+    for(const std::string& name : names) {
+      AssetSlice slice = bundle.Find(name.c_str());
+      if(!slice.data) {
+        state.SkipWithError(("bundle is missing " + name).c_str());
+        return;
+      }
+      sum += Checksum(slice.data, slice.size);
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.counters["files"] = names.size();
+}
+
+static void BM_OpenFiles(benchmark::State& state) {
+  std::vector<std::string> names = SourceNames();
+  for(auto _ : state) {
+    if(state.range(0)) {
+      state.PauseTiming();
+      for(const std::string& name : names) {
+        DropFromCache(std::string(ASSET_SRC_DIR) + "/" + name);
+      }
+      state.ResumeTiming();
+    }
+    unsigned int sum = 0;
+    for(const std::string& name : names) {
+      AssetBuffer file;
+      if(!file.Open((std::string(ASSET_SRC_DIR) + "/" + name).c_str())) {
+        state.SkipWithError(("can't open " + name).c_str());
+        return;
+      }
+      sum += Checksum(file.Data(), file.Size());
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.counters["files"] = names.size();
+}
+
+BENCHMARK(BM_OpenBundle)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_OpenFiles)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,303 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "dnsresolver.h"
+#include "testutils.h"
+
+static uint64_t NowMillis() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// What the stand-in server does with queries for an address: answer with
+// a name, or give one of the replies the resolver must survive first
+enum Behavior {
+  ANSWER, NXDOMAIN, DROP_FIRST, DELAY, MALFORMED_FIRST, WRONG_ID_FIRST,
+  POINTER_LOOP, SILENT
+};
+
+typedef struct {
+  Behavior behavior;
+  std::string name;
+} Reply;
+
+// A DNS server on an ephemeral loopback port, answering PTR queries from
+// a table on its own thread
+class StandInDns {
+
+  public:
+    StandInDns(): fd(socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0)), port(0), stopped(false) {
+      struct sockaddr_in sa = {};
+      sa.sin_family = AF_INET;
+      sa.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+      socklen_t saLen = sizeof(sa);
+      if(fd >= 0 && bind(fd, (struct sockaddr*)&sa, sizeof(sa)) == 0 &&
+         getsockname(fd, (struct sockaddr*)&sa, &saLen) == 0) {
+        port = ntohs(sa.sin_port);
+      }
+    }
+    ~StandInDns() {
+      stopped = true;
+      if(thread.joinable()) {
+        thread.join();
+      }
+      close(fd);
+    }
+
+    unsigned short Port() const { return port; }
+
+    // Set the replies before starting, since the table isn't locked
+    void Set(uint32_t address, Behavior behavior, const std::string& name = std::string()) {
+      replies[address] = Reply{behavior, name};
+    }
+    void Start() {
+      thread = std::thread([this]() { Serve(); });
+    }
+
+    unsigned int Queries(uint32_t address) {
+      std::lock_guard<std::mutex> lock(mutex);
+      return queries[address];
+    }
+
+  private:
+    typedef struct {
+      uint64_t time;
+      std::vector<unsigned char> packet;
+      struct sockaddr_in to;
+    } Pending;
+
+    void Serve() {
+      std::vector<Pending> delayed;
+      unsigned char packet[DNS_PACKET_SIZE];
+      while(!stopped) {
+        struct pollfd pfd = {fd, POLLIN, 0};
+        poll(&pfd, 1, 10);
+        for(size_t i=0; i<delayed.size();) {
+          if(delayed[i].time <= NowMillis()) {
+            Send(delayed[i].packet, delayed[i].to);
+            delayed.erase(delayed.begin() + i);
+          } else {
+            ++i;
+          }
+        }
+        struct sockaddr_in from;
+        socklen_t fromLen = sizeof(from);
+        ssize_t size = recvfrom(fd, packet, sizeof(packet), MSG_DONTWAIT,
+          (struct sockaddr*)&from, &fromLen);
+        uint32_t address;
+        size_t questionEnd;
+        if(size <= 0 || !ParseQuery(packet, size, &address, &questionEnd)) {
+          continue;
+        }
+        unsigned int count;
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          count = ++queries[address];
+        }
+        std::map<uint32_t, Reply>::const_iterator it = replies.find(address);
+        Behavior behavior = (it == replies.end()) ? NXDOMAIN : it->second.behavior;
+        std::vector<unsigned char> response(packet, packet + questionEnd);
+        response[2] |= 0x80;
+        response[3] = 0x80;
+        if(behavior == SILENT || (count == 1 && behavior == DROP_FIRST)) {
+          continue;
+        }
+        if(behavior == NXDOMAIN) {
+          response[3] |= 3;
+        } else if(behavior == POINTER_LOOP) {
+          AppendAnswer(response, std::string(), true);
+        } else {
+          AppendAnswer(response, it->second.name, false);
+        }
+        if(count == 1 && behavior == MALFORMED_FIRST) {
+          response.resize(questionEnd - 3);
+        } else if(count == 1 && behavior == WRONG_ID_FIRST) {
+          response[0] ^= 0x80;
+        }
+        if(behavior == DELAY) {
+          delayed.push_back(Pending{NowMillis() + 1500, response, from});
+        } else {
+          Send(response, from);
+        }
+      }
+    }
+
+    // Read the address out of a d.c.b.a.in-addr.arpa PTR question
+    static bool ParseQuery(const unsigned char* packet, size_t size, uint32_t* address,
+      size_t* questionEnd) {
+      size_t pos = 12;
+      std::vector<std::string> labels;
+      while(pos < size && packet[pos] != 0) {
+        unsigned int len = packet[pos];
+        if(pos + 1 + len > size) {
+          return false;
+        }
+        labels.push_back(std::string((const char*)packet + pos + 1, len));
+        pos += 1 + len;
+      }
+      if(labels.size() != 6 || pos + 5 > size) {
+        return false;
+      }
+      *address = 0;
+      for(int i=3; i>=0; --i) {
+        *address = (*address << 8) | (uint32_t)atoi(labels[i].c_str());
+      }
+      *questionEnd = pos + 5;
+      return true;
+    }
+
+    // A PTR record for the question, its data a name or a pointer to itself
+    static void AppendAnswer(std::vector<unsigned char>& response, const std::string& name,
+      bool loop) {
+      response[7] = 1;
+      const unsigned char record[] = {0xC0, 12, 0, 12, 0, 1, 0, 0, 0x0E, 0x10};
+      response.insert(response.end(), record, record + sizeof(record));
+      std::vector<unsigned char> data;
+      if(loop) {
+        size_t offset = response.size() + 2;
+        data.push_back(0xC0 | (offset >> 8));
+        data.push_back(offset & 0xFF);
+      } else {
+        size_t start = 0;
+        while(start <= name.length()) {
+          size_t dot = name.find('.', start);
+          if(dot == std::string::npos) {
+            dot = name.length();
+          }
+          data.push_back((unsigned char)(dot - start));
+          data.insert(data.end(), name.begin() + start, name.begin() + dot);
+          start = dot + 1;
+        }
+        data.push_back(0);
+      }
+      response.push_back(data.size() >> 8);
+      response.push_back(data.size() & 0xFF);
+      response.insert(response.end(), data.begin(), data.end());
+    }
+
+    void Send(const std::vector<unsigned char>& packet, const struct sockaddr_in& to) {
+      sendto(fd, packet.data(), packet.size(), 0, (const struct sockaddr*)&to, sizeof(to));
+    }
+
+    int fd;
+    unsigned short port;
+    volatile bool stopped;
+    std::thread thread;
+    std::map<uint32_t, Reply> replies;
+    std::mutex mutex;
+    std::map<uint32_t, unsigned int> queries;
+};
+
+// Run the resolver until every lookup has finished, recording each name
+// and how long it took
+static void Resolve(DnsResolver& resolver, std::map<uint32_t, std::string>* names,
+  std::map<uint32_t, uint64_t>* times, uint64_t timeoutMs) {
+
+  uint64_t start = NowMillis();
+  DnsResolver::NameFunc nameFunc = [&](uint32_t address, const std::string& name) {
+    (*names)[address] = name;
+    (*times)[address] = NowMillis() - start;
+  };
+  resolver.Process(NowMillis(), nameFunc);
+  while(!resolver.Idle() && NowMillis() - start < timeoutMs) {
+    struct pollfd pfd = {resolver.Fd(), POLLIN, 0};
+    poll(&pfd, 1, resolver.Timeout(NowMillis()));
+    resolver.Process(NowMillis(), nameFunc);
+  }
+}
+
+static const uint32_t SUBNET = 0xC0A80100;  // 192.168.1.0
+
+TEST_CASE(ResolvesAndSurvivesBadReplies) {
+  StandInDns server;
+  REQUIRE(server.Port() != 0);
+  server.Set(SUBNET + 1, ANSWER, "printer.lan");
+  server.Set(SUBNET + 2, NXDOMAIN);
+  server.Set(SUBNET + 3, DROP_FIRST, "retried.lan");
+  server.Set(SUBNET + 4, DELAY, "slow.lan");
+  server.Set(SUBNET + 5, MALFORMED_FIRST, "malformed.lan");
+  server.Set(SUBNET + 6, WRONG_ID_FIRST, "spoofed.lan");
+  server.Set(SUBNET + 7, POINTER_LOOP);
+  server.Set(SUBNET + 8, SILENT);
+  server.Set(SUBNET + 9, ANSWER, std::string(63, 'a') + "." + std::string(63, 'b') + "." +
+    std::string(63, 'c') + "." + std::string(61, 'd'));
+  server.Start();
+
+  DnsResolver resolver;
+  REQUIRE(resolver.Open(INADDR_LOOPBACK, server.Port()));
+  for(uint32_t i=1; i<=9; ++i) {
+    resolver.Lookup(SUBNET + i);
+  }
+  resolver.Lookup(SUBNET + 1);
+  std::map<uint32_t, std::string> names;
+  std::map<uint32_t, uint64_t> times;
+  Resolve(resolver, &names, &times, 10000);
+  REQUIRE(resolver.Idle());
+  REQUIRE(names.size() == 9);
+
+  // Answers come back at once, and NXDOMAIN or a reply whose name can't
+  // be read means no name
+  CHECK(names[SUBNET + 1] == "printer.lan" && times[SUBNET + 1] < 500);
+  CHECK(names[SUBNET + 2] == "" && times[SUBNET + 2] < 500);
+  CHECK(names[SUBNET + 7] == "" && times[SUBNET + 7] < 500);
+  CHECK(names[SUBNET + 9].length() == 253);
+  CHECK(server.Queries(SUBNET + 1) == 1);
+
+  // A dropped query is sent again after a second, and a late answer to
+  // the first send is taken. Malformed and spoofed replies are ignored
+  // until the retry is answered.
+  CHECK(names[SUBNET + 3] == "retried.lan" && server.Queries(SUBNET + 3) == 2);
+  CHECK(times[SUBNET + 3] >= 900 && times[SUBNET + 3] < 1500);
+  CHECK(names[SUBNET + 4] == "slow.lan" && times[SUBNET + 4] >= 1400 && times[SUBNET + 4] < 2000);
+  CHECK(names[SUBNET + 5] == "malformed.lan" && server.Queries(SUBNET + 5) == 2);
+  CHECK(names[SUBNET + 6] == "spoofed.lan" && server.Queries(SUBNET + 6) == 2);
+
+  // A server that never answers is given up on after 1 + 2 + 4 seconds
+  CHECK(names[SUBNET + 8] == "" && server.Queries(SUBNET + 8) == 3);
+  CHECK(times[SUBNET + 8] >= 6900 && times[SUBNET + 8] < 7500);
+
+  // Answers are cached, the lack of a name included
+  std::string name;
+  CHECK(resolver.Cached(SUBNET + 1, NowMillis(), &name) && name == "printer.lan");
+  CHECK(resolver.Cached(SUBNET + 2, NowMillis(), &name) && name.empty());
+  CHECK(!resolver.Cached(SUBNET + 10, NowMillis(), &name));
+}
+
+TEST_CASE(ResolvesMoreThanFitInFlight) {
+
+  // Lookups beyond MAX_DNS_QUERIES wait for a free slot
+  StandInDns server;
+  REQUIRE(server.Port() != 0);
+  const unsigned int numHosts = 4*MAX_DNS_QUERIES + 3;
+  for(uint32_t i=1; i<=numHosts; ++i) {
+    server.Set(SUBNET + i, ANSWER, "host" + std::to_string(i) + ".lan");
+  }
+  server.Start();
+  DnsResolver resolver;
+  REQUIRE(resolver.Open(INADDR_LOOPBACK, server.Port()));
+  for(uint32_t i=1; i<=numHosts; ++i) {
+    resolver.Lookup(SUBNET + i);
+  }
+  std::map<uint32_t, std::string> names;
+  std::map<uint32_t, uint64_t> times;
+  Resolve(resolver, &names, &times, 5000);
+  REQUIRE(names.size() == numHosts);
+  for(uint32_t i=1; i<=numHosts; ++i) {
+    CHECK(names[SUBNET + i] == "host" + std::to_string(i) + ".lan");
+    CHECK(times[SUBNET + i] < 500);
+  }
+}
+
+TEST_MAIN()
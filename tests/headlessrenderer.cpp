@@ -0,0 +1,107 @@
+#include "headlessrenderer.h"
+
+#include <arpa/inet.h>
+
+#include <cstdio>
+
+#include "recordinggl.h"
+#include "stubandroid.h"
+#include "stubgvr.h"
+#include "wifidiscovery_renderer.h"
+
+// Path and hash of a network's host cache, named as StartScan names it
+static std::string HostCachePath(const std::string& dir, const std::string& address,
+  int prefixLength, const std::string& ssid, uint64_t* hash) {
+
+  struct in_addr addr;
+  if(inet_pton(AF_INET, address.c_str(), &addr) != 1) {
+    return std::string();
+  }
+  uint32_t mask = (prefixLength > 0) ? ~0u << (32 - std::min(prefixLength, 32)) : 0;
+  char subnet[32], fileName[40];
+  snprintf(subnet, sizeof(subnet), "/%08x/%d", ntohl(addr.s_addr) & mask, prefixLength);
+  *hash = ShaderUtils::Hash(ssid + "/" + subnet);
+  snprintf(fileName, sizeof(fileName), "/hosts_%016llx.bin", (unsigned long long)*hash);
+  return dir + fileName;
+}
+
+HeadlessRenderer::HeadlessRenderer(const char* extensions, const std::string& hostCacheDir,
+  bool bufferStorage, bool drawUntilReady) {
+
+  // The program cache isn't used, so runs don't depend on each other
+  ResetStubGl(extensions, bufferStorage);
+  gvr = CreateStubGvr();
+  assets = CreateStubAssetManager(ASSET_DIR);
+  renderer = new WiFiDiscoveryRenderer(gvr, assets, "", hostCacheDir);
+  renderer->OnSurfaceCreated();
+  if(!drawUntilReady) {
+    return;
+  }
+
+  // Programs finish one per frame without parallel compilation, so draw
+  // until every one is ready and start the counts afresh
+  renderer->SetState(NOT_CONNECTED);
+  for(unsigned int i=0; i<NUM_PROGRAMS; ++i) {
+    renderer->OnDrawFrame();
+  }
+  ResetGlCounters();
+}
+
+HeadlessRenderer::~HeadlessRenderer() {
+  delete renderer;
+  DestroyStubAssetManager(assets);
+  DestroyStubGvr(gvr);
+}
+
+unsigned int HeadlessRenderer::QueueSize() {
+  return HOST_QUEUE_SIZE;
+}
+
+bool HeadlessRenderer::WriteHostCache(const std::string& dir, const std::string& address,
+  int prefixLength, const std::string& ssid, unsigned int numHosts) {
+
+  uint64_t hash;
+  std::string path = HostCachePath(dir, address, prefixLength, ssid, &hash);
+  std::vector<CachedHost> hosts(numHosts);
+  for(unsigned int i=0; i<numHosts; ++i) {
+    char name[24];
+    snprintf(name, sizeof(name), "host%05u.lan", i);
+    hosts[i].address = 0x0A000001 + i;
+    hosts[i].name = name;
+  }
+  return !path.empty() && HostCache::Save(path, hash, hosts);
+}
+
+int HeadlessRenderer::ReadHostCache(const std::string& dir, const std::string& address,
+  int prefixLength, const std::string& ssid) {
+
+  uint64_t hash;
+  std::string path = HostCachePath(dir, address, prefixLength, ssid, &hash);
+  HostCache cache;
+  return cache.Open(path, hash) ? (int)cache.Size() : -1;
+}
+
+void HeadlessRenderer::StartScan(const std::string& address, int prefixLength,
+  const std::string& ssid) {
+  renderer->StartScan(address, prefixLength, ssid, "", "");
+}
+
+void HeadlessRenderer::SetState(int state) {
+  renderer->SetState(state);
+}
+
+void HeadlessRenderer::AddHost(const std::string& host) {
+  renderer->AddHost(host);
+}
+
+void HeadlessRenderer::LoseHost(uint32_t address) {
+  renderer->LoseHost(address);
+}
+
+void HeadlessRenderer::SetScanComplete() {
+  renderer->SetScanComplete();
+}
+
+void HeadlessRenderer::DrawFrame() {
+  renderer->OnDrawFrame();
+}
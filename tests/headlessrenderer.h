@@ -0,0 +1,59 @@
+#ifndef HEADLESS_RENDERER_H_
+#define HEADLESS_RENDERER_H_
+
+#include <cstdint>
+#include <string>
+
+class WiFiDiscoveryRenderer;
+struct gvr_context_;
+struct AAssetManager;
+
+// WiFiDiscoveryRenderer with its surface created against the recording GL
+// and GVR stubs, serving the app's asset bundle from the source tree. The
+// renderer is built as on the device, so its headers are only included by
+// headlessrenderer.cpp, away from code that must not see __ANDROID__.
+class HeadlessRenderer {
+
+  public:
+    // States as passed to SetState
+    enum { NOT_CONNECTED = 0, SCANNING = 1, SCAN_FINISHED = 2 };
+
+    // Reset the stubs to report these GL extensions, create the surface and
+    // draw until every program is ready, leaving the state NOT_CONNECTED.
+    // Host caches are only read and written given a directory. Without
+    // drawUntilReady nothing is drawn and the counts aren't reset.
+    explicit HeadlessRenderer(const char* extensions,
+      const std::string& hostCacheDir = std::string(), bool bufferStorage = true,
+      bool drawUntilReady = true);
+    ~HeadlessRenderer();
+
+    // Hosts the renderer can take between two frames without blocking
+    static unsigned int QueueSize();
+
+    // Write the host cache StartScan loads for this network, holding hosts
+    // named host00000.lan on from 10.0.0.1, or read back how many it holds,
+    // -1 if it can't be read
+    static bool WriteHostCache(const std::string& dir, const std::string& address,
+      int prefixLength, const std::string& ssid, unsigned int numHosts);
+    static int ReadHostCache(const std::string& dir, const std::string& address,
+      int prefixLength, const std::string& ssid);
+
+    // Scan and monitor the network with no DNS server
+    void StartScan(const std::string& address, int prefixLength, const std::string& ssid);
+
+    void SetState(int state);
+    void AddHost(const std::string& host);
+    void LoseHost(uint32_t address);
+    void SetScanComplete();
+    void DrawFrame();
+
+  private:
+    HeadlessRenderer(const HeadlessRenderer&);
+    HeadlessRenderer& operator=(const HeadlessRenderer&);
+
+    gvr_context_* gvr;
+    AAssetManager* assets;
+    WiFiDiscoveryRenderer* renderer;
+};
+
+#endif  // HEADLESS_RENDERER_H_
@@ -0,0 +1,131 @@
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "hostcache.h"
+#include "testutils.h"
+
+static const uint64_t NETWORK_HASH = 0x0123456789ABCDEFULL;
+
+// A cache file in a fresh directory, removed with it afterwards
+class TempCache {
+
+  public:
+    TempCache() {
+      char dirTemplate[] = "/tmp/hostcache_test.XXXXXX";
+      dir = mkdtemp(dirTemplate) ? dirTemplate : "/tmp";
+      path = dir + "/hosts.bin";
+    }
+    ~TempCache() {
+      remove(path.c_str());
+      rmdir(dir.c_str());
+    }
+
+    // Overwrite bytes of the file, or cut it short
+    void Patch(long offset, const void* data, size_t size) {
+      FILE* file = fopen(path.c_str(), "r+b");
+      fseek(file, offset, SEEK_SET);
+      fwrite(data, 1, size, file);
+      fclose(file);
+    }
+    void Truncate(long size) {
+      if(truncate(path.c_str(), size) != 0) {
+        remove(path.c_str());
+      }
+    }
+
+    std::string dir, path;
+};
+
+static std::vector<CachedHost> MakeHosts(unsigned int count) {
+
+  // Out of order, with empty and long names
+  std::vector<CachedHost> hosts(count);
+  for(unsigned int i=0; i<count; ++i) {
+    hosts[i].address = 0xC0A80000 + (i*7919) % 65536;
+    hosts[i].name = (i % 5 == 0) ? std::string() : "host" + std::to_string(i) + ".lan";
+  }
+  hosts[1].name.assign(250, 'x');
+  return hosts;
+}
+
+TEST_CASE(RoundTripsSortedByAddress) {
+  TempCache temp;
+  std::vector<CachedHost> hosts = MakeHosts(1000);
+  std::vector<CachedHost> saved = hosts;
+  REQUIRE(HostCache::Save(temp.path, NETWORK_HASH, saved));
+  CHECK(access((temp.path + ".tmp").c_str(), F_OK) != 0);
+
+  HostCache cache;
+  REQUIRE(cache.Open(temp.path, NETWORK_HASH));
+  REQUIRE(cache.Size() == hosts.size());
+  for(unsigned int i=0; i<cache.Size(); ++i) {
+    CHECK(i == 0 || cache.Address(i - 1) < cache.Address(i));
+    bool found = false;
+    for(const CachedHost& host : hosts) {
+      if(host.address == cache.Address(i)) {
+        found = (host.name == cache.Name(i));
+      }
+    }
+    CHECK(found);
+  }
+
+  // An empty scan saves an empty cache
+  std::vector<CachedHost> none;
+  REQUIRE(HostCache::Save(temp.path, NETWORK_HASH, none));
+  CHECK(cache.Open(temp.path, NETWORK_HASH) && cache.Size() == 0);
+}
+
+TEST_CASE(RejectsOtherNetworksAndMissingFiles) {
+  TempCache temp;
+  std::vector<CachedHost> hosts = MakeHosts(10);
+  REQUIRE(HostCache::Save(temp.path, NETWORK_HASH, hosts));
+  HostCache cache;
+  CHECK(!cache.Open(temp.path, NETWORK_HASH + 1));
+  CHECK(cache.Size() == 0);
+  CHECK(!cache.Open(temp.dir + "/missing.bin", NETWORK_HASH));
+  CHECK(!HostCache::Save(temp.dir + "/missing/hosts.bin", NETWORK_HASH, hosts));
+}
+
+TEST_CASE(RejectsCorruptFiles) {
+
+  // Bad headers, out of range entries and files cut short are refused
+  // rather than read past their end
+  const uint32_t badMagic = 0, badVersion = HOST_CACHE_VERSION + 1;
+  const uint32_t tooManyHosts = 0x7FFFFFFF, pastNames = 0xFFFFFF00;
+  struct {
+    long offset;
+    const uint32_t* value;
+  } patches[] = {
+    {offsetof(HostCacheHeader, magic), &badMagic},
+    {offsetof(HostCacheHeader, version), &badVersion},
+    {offsetof(HostCacheHeader, numHosts), &tooManyHosts},
+    {offsetof(HostCacheHeader, nameBytes), &pastNames},
+    {sizeof(HostCacheHeader) + 3*sizeof(HostCacheEntry) + offsetof(HostCacheEntry, nameOffset),
+     &pastNames},
+    {sizeof(HostCacheHeader) + 3*sizeof(HostCacheEntry) + offsetof(HostCacheEntry, nameLength),
+     &pastNames}};
+  for(const auto& patch : patches) {
+    TempCache temp;
+    std::vector<CachedHost> hosts = MakeHosts(10);
+    REQUIRE(HostCache::Save(temp.path, NETWORK_HASH, hosts));
+    temp.Patch(patch.offset, patch.value, sizeof(*patch.value));
+    HostCache cache;
+    CHECK(!cache.Open(temp.path, NETWORK_HASH));
+  }
+  const long sizes[] = {0, sizeof(HostCacheHeader) - 1, sizeof(HostCacheHeader) + 5, 200};
+  for(long size : sizes) {
+    TempCache temp;
+    std::vector<CachedHost> hosts = MakeHosts(10);
+    REQUIRE(HostCache::Save(temp.path, NETWORK_HASH, hosts));
+    temp.Truncate(size);
+    HostCache cache;
+    CHECK(!cache.Open(temp.path, NETWORK_HASH));
+  }
+}
+
+TEST_MAIN()
@@ -0,0 +1,95 @@
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "hostpicker.h"
+
+// Cost of a pick against a wall of buttons laid out as the renderer does,
+// with rays aimed anywhere on the wall, beside the scan it replaced
+static const unsigned int NUM_RAYS = 1024;
+
+static void WallBox(unsigned int i, float* boxMin, float* boxMax) {
+  unsigned int row = i / 15, col = i % 15;
+  float x = ((col % 2 == 1) ? -1.0f : 1.0f) * ((col + 1)/2) * 0.75f;
+  float y = -0.6f - row*1.05f;
+  boxMin[0] = x - 0.15f; boxMin[1] = y - 0.3f; boxMin[2] = -5.0f;
+  boxMax[0] = x + 0.15f; boxMax[1] = y;        boxMax[2] = -5.0f;
+}
+
+static std::vector<float> Rays(unsigned int numHosts) {
+  std::mt19937 random(18);
+  float rows = (numHosts + 14)/15*1.05f;
+  std::uniform_real_distribution<float> x(-5.5f, 5.5f), y(-0.6f - rows, -0.6f);
+  std::vector<float> rays(3*NUM_RAYS);
+  for(unsigned int i=0; i<NUM_RAYS; ++i) {
+    rays[3*i] = x(random);
+    rays[3*i+1] = y(random);
+    rays[3*i+2] = -5.0f;
+  }
+  return rays;
+}
+
+static void BM_Pick(benchmark::State& state) {
+  unsigned int numHosts = state.range(0);
+  HostPicker picker(0.75f);
+  float boxMin[3], boxMax[3];
+  for(unsigned int i=0; i<numHosts; ++i) {
+    WallBox(i, boxMin, boxMax);
+    picker.Set(i, boxMin, boxMax);
+  }
+  std::vector<float> rays = Rays(numHosts);
+  const float origin[3] = {0.0f, 0.0f, 0.0f};
+  unsigned int ray = 0;
+  for(auto _ : state) {
+    benchmark::DoNotOptimize(picker.Pick(origin, &rays[3*ray]));
+    ray = (ray + 1) % NUM_RAYS;
+  }
+}
+
+// Project the ray onto the wall and test every button, as picking worked
+// before the grid
+static void BM_PickLinearScan(benchmark::State& state) {
+  unsigned int numHosts = state.range(0);
+  std::vector<float> boxes(6*numHosts);
+  for(unsigned int i=0; i<numHosts; ++i) {
+    WallBox(i, &boxes[6*i], &boxes[6*i+3]);
+  }
+  std::vector<float> rays = Rays(numHosts);
+  unsigned int ray = 0;
+  for(auto _ : state) {
+    const float* direction = &rays[3*ray];
+    float x = direction[0]*(-5.0f/direction[2]), y = direction[1]*(-5.0f/direction[2]);
+    int selected = -1;
+    for(unsigned int i=0; i<numHosts; ++i) {
+      const float* box = &boxes[6*i];
+      if(x >= box[0] && x <= box[3] && y >= box[1] && y <= box[4]) {
+        selected = i;
+        break;
+      }
+    }
+    benchmark::DoNotOptimize(selected);
+    ray = (ray + 1) % NUM_RAYS;
+  }
+}
+
+// Building the grid for a whole scan
+static void BM_Build(benchmark::State& state) {
+  unsigned int numHosts = state.range(0);
+  HostPicker picker(0.75f);
+  float boxMin[3], boxMax[3];
+  for(auto _ : state) {
+    picker.Clear();
+    for(unsigned int i=0; i<numHosts; ++i) {
+      WallBox(i, boxMin, boxMax);
+      picker.Set(i, boxMin, boxMax);
+    }
+  }
+  state.SetItemsProcessed(state.iterations()*numHosts);
+}
+
+BENCHMARK(BM_Pick)->RangeMultiplier(10)->Range(100, 100000);
+BENCHMARK(BM_PickLinearScan)->RangeMultiplier(10)->Range(100, 100000);
+BENCHMARK(BM_Build)->RangeMultiplier(10)->Range(100, 100000)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
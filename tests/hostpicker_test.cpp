@@ -0,0 +1,141 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "hostpicker.h"
+#include "testutils.h"
+
+typedef struct {
+  float min[3], max[3];
+  bool removed;
+} TestBox;
+
+static const float INF = std::numeric_limits<float>::infinity();
+
+// Buttons laid out as the renderer places them: 15 to a row, filling
+// outward from the centre, on the wall 5 units ahead
+static std::vector<TestBox> WallBoxes(unsigned int count) {
+  std::vector<TestBox> boxes(count);
+  for(unsigned int i=0; i<count; ++i) {
+    unsigned int row = i / 15, col = i % 15;
+    float x = ((col % 2 == 1) ? -1.0f : 1.0f) * ((col + 1)/2) * 0.75f;
+    float y = -0.6f - row*1.05f;
+    TestBox box = {{x - 0.15f, y - 0.3f, -5.0f}, {x + 0.15f, y, -5.0f}, false};
+    boxes[i] = box;
+  }
+  return boxes;
+}
+
+// Nearest box hit, testing every box with the same slab test as the
+// picker. Ties go to the lowest index.
+static int BruteForcePick(const std::vector<TestBox>& boxes, const float* origin,
+  const float* direction) {
+
+  int best = -1;
+  float bestT = INF;
+  for(unsigned int index=0; index<boxes.size(); ++index) {
+    const TestBox& box = boxes[index];
+    float tMin = 0.0f, tMax = bestT;
+    bool hit = !box.removed;
+    for(int i=0; i<3 && hit; ++i) {
+      float invDir = 1.0f/direction[i];
+      if(invDir == INF || invDir == -INF) {
+        hit = (origin[i] >= box.min[i] && origin[i] <= box.max[i]);
+        continue;
+      }
+      float t0 = (box.min[i] - origin[i]) * invDir;
+      float t1 = (box.max[i] - origin[i]) * invDir;
+      tMin = std::max(tMin, std::min(t0, t1));
+      tMax = std::min(tMax, std::max(t0, t1));
+      hit = (tMin <= tMax);
+    }
+    if(hit && tMin < bestT) {
+      best = index;
+      bestT = tMin;
+    }
+  }
+  return best;
+}
+
+static void Load(HostPicker& picker, const std::vector<TestBox>& boxes) {
+  picker.Clear();
+  for(unsigned int i=0; i<boxes.size(); ++i) {
+    picker.Set(i, boxes[i].min, boxes[i].max);
+  }
+}
+
+TEST_CASE(MatchesBruteForceOnWall) {
+  std::vector<TestBox> boxes = WallBoxes(3000);
+  HostPicker picker(0.75f);
+  Load(picker, boxes);
+
+  // Rays from the player at points across the wall and past its edges,
+  // many of them through the gaps between buttons
+  std::mt19937 random(18);
+  std::uniform_real_distribution<float> x(-6.0f, 6.0f), y(-220.0f, 1.0f);
+  const float origin[3] = {0.0f, 0.0f, 0.0f};
+  unsigned int hits = 0;
+  for(int n=0; n<20000; ++n) {
+    float direction[3] = {x(random), y(random), -5.0f};
+    int expected = BruteForcePick(boxes, origin, direction);
+    CHECK(picker.Pick(origin, direction) == expected);
+    hits += (expected != -1);
+  }
+  CHECK(hits > 1000);
+}
+
+TEST_CASE(MatchesBruteForceInVolume) {
+
+  // Overlapping boxes of all sizes, some flat, scattered through space
+  // and hit from every direction, including along the axes
+  std::mt19937 random(81);
+  std::uniform_real_distribution<float> position(-20.0f, 20.0f), size(0.0f, 2.0f);
+  std::vector<TestBox> boxes(2000);
+  for(TestBox& box : boxes) {
+    for(int i=0; i<3; ++i) {
+      box.min[i] = position(random);
+      box.max[i] = box.min[i] + ((random() % 8 == 0) ? 0.0f : size(random));
+    }
+    box.removed = false;
+  }
+  HostPicker picker(1.0f);
+  Load(picker, boxes);
+  std::uniform_real_distribution<float> axis(-1.0f, 1.0f);
+  for(int n=0; n<20000; ++n) {
+    float origin[3] = {position(random), position(random), position(random)};
+    float direction[3] = {axis(random), axis(random), axis(random)};
+    if(n % 4 == 0) {
+      direction[random() % 3] = 0.0f;
+    }
+    CHECK(picker.Pick(origin, direction) == BruteForcePick(boxes, origin, direction));
+  }
+}
+
+TEST_CASE(PicksThroughRemovedBoxes) {
+
+  // Two buttons one behind the other: the near one wins until it goes,
+  // and setting it again brings it back
+  std::vector<TestBox> boxes = WallBoxes(2);
+  boxes[1] = boxes[0];
+  boxes[1].min[2] = boxes[1].max[2] = -6.0f;
+  HostPicker picker(0.75f);
+  Load(picker, boxes);
+  const float origin[3] = {0.0f, 0.0f, 0.0f}, direction[3] = {0.0f, -0.75f, -5.0f};
+  CHECK(picker.Pick(origin, direction) == 0);
+  picker.Remove(0);
+  CHECK(picker.Pick(origin, direction) == 1);
+  picker.Remove(1);
+  CHECK(picker.Pick(origin, direction) == -1);
+  picker.Set(0, boxes[0].min, boxes[0].max);
+  CHECK(picker.Pick(origin, direction) == 0);
+
+  // Nothing is hit behind the ray or in an empty picker
+  const float away[3] = {0.0f, 0.75f, 5.0f};
+  CHECK(picker.Pick(origin, away) == -1);
+  picker.Clear();
+  CHECK(picker.Pick(origin, direction) == -1);
+}
+
+TEST_MAIN()
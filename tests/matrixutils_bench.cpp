@@ -0,0 +1,64 @@
+#include <benchmark/benchmark.h>
+
+#include "matrixutils.h"
+
+// The per-eye matrix work of a frame. matrixutils_scalar_bench runs the
+// scalar paths for comparison.
+
+static gvr::Mat4f Pose() {
+  gvr::Mat4f pose = MatrixUtils::RotateM(0.3f, 0.2f, 1.0f, 0.1f);
+  pose.m[0][3] = 0.032f;
+  return pose;
+}
+
+static void BM_MultiplyMM(benchmark::State& state) {
+  gvr::Mat4f a = Pose(), b = MatrixUtils::RotateM(0.5f, 1.0f, 0.0f, 0.0f);
+  for(auto _ : state) {
+    benchmark::DoNotOptimize(&a);
+    a = MatrixUtils::MultiplyMM(a, b);
+  }
+}
+
+static void BM_MultiplyMMTranspose(benchmark::State& state) {
+  gvr::Mat4f a = Pose(), b = MatrixUtils::RotateM(0.5f, 1.0f, 0.0f, 0.0f);
+  for(auto _ : state) {
+    benchmark::DoNotOptimize(&a);
+    gvr::Mat4f product = MatrixUtils::MultiplyMMTranspose(a, b);
+    benchmark::DoNotOptimize(&product);
+  }
+}
+
+static void BM_Perspective(benchmark::State& state) {
+  gvr::Rectf fov = {50, 40, 45, 45};
+  for(auto _ : state) {
+    benchmark::DoNotOptimize(&fov);
+    gvr::Mat4f projection = MatrixUtils::Perspective(fov, 1.0f, 100.0f);
+    benchmark::DoNotOptimize(&projection);
+  }
+}
+
+// An eye's MVP with the projection recomputed every frame, as before it
+// was cached, and with the cached one
+static void BM_EyeMatrix(benchmark::State& state) {
+  bool cached = state.range(0);
+  gvr::Rectf fov = {50, 40, 45, 45};
+  gvr::Mat4f eyeFromHead = Pose(), head = MatrixUtils::RotateM(0.5f, 1.0f, 0.0f, 0.0f);
+  gvr::Mat4f projection = MatrixUtils::Perspective(fov, 1.0f, 100.0f);
+  for(auto _ : state) {
+    benchmark::DoNotOptimize(&fov);
+    benchmark::DoNotOptimize(&head);
+    if(!cached) {
+      projection = MatrixUtils::Perspective(fov, 1.0f, 100.0f);
+    }
+    gvr::Mat4f mvp = MatrixUtils::MultiplyMMTranspose(projection,
+      MatrixUtils::MultiplyMM(eyeFromHead, head));
+    benchmark::DoNotOptimize(&mvp);
+  }
+}
+
+BENCHMARK(BM_MultiplyMM);
+BENCHMARK(BM_MultiplyMMTranspose);
+BENCHMARK(BM_Perspective);
+BENCHMARK(BM_EyeMatrix)->ArgName("cached")->Arg(0)->Arg(1);
+
+BENCHMARK_MAIN();
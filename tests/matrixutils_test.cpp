@@ -0,0 +1,103 @@
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+#include "matrixutils.h"
+#include "testutils.h"
+
+// The scalar product loop, summed in the order the NEON and SSE2 paths
+// must follow to match it bit for bit
+static gvr::Mat4f ReferenceProduct(const gvr::Mat4f& matA, const gvr::Mat4f& matB) {
+  gvr::Mat4f product;
+  for(int i=0; i<4; ++i) {
+    for(int j=0; j<4; ++j) {
+      product.m[i][j] = matA.m[i][0] * matB.m[0][j];
+      for(int k=1; k<4; ++k) {
+        product.m[i][j] += matA.m[i][k] * matB.m[k][j];
+      }
+    }
+  }
+  return product;
+}
+
+static gvr::Mat4f Transposed(const gvr::Mat4f& mat) {
+  gvr::Mat4f transposed;
+  for(int i=0; i<4; ++i) {
+    for(int j=0; j<4; ++j) {
+      transposed.m[j][i] = mat.m[i][j];
+    }
+  }
+  return transposed;
+}
+
+static bool SameBits(const gvr::Mat4f& a, const gvr::Mat4f& b) {
+  return memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+// Random pairs of general matrices and rigid transforms like head poses
+static void MakeMatrices(std::mt19937& random, gvr::Mat4f* a, gvr::Mat4f* b) {
+  std::uniform_real_distribution<float> value(-10.0f, 10.0f);
+  for(int i=0; i<4; ++i) {
+    for(int j=0; j<4; ++j) {
+      a->m[i][j] = value(random);
+    }
+  }
+  *b = MatrixUtils::RotateM(value(random), value(random), value(random), value(random));
+  b->m[0][3] = value(random);
+  b->m[1][3] = value(random);
+  b->m[2][3] = value(random);
+}
+
+TEST_CASE(ProductsMatchScalarReference) {
+  std::mt19937 random(17);
+  for(int n=0; n<10000; ++n) {
+    gvr::Mat4f a, b;
+    MakeMatrices(random, &a, &b);
+    gvr::Mat4f reference = ReferenceProduct(a, b);
+    CHECK(SameBits(MatrixUtils::MultiplyMM(a, b), reference));
+    CHECK(SameBits(MatrixUtils::MultiplyMMTranspose(a, b), Transposed(reference)));
+    CHECK(SameBits(MatrixUtils::MultiplyMM(b, a), ReferenceProduct(b, a)));
+  }
+}
+
+TEST_CASE(ProductsAreAccurate) {
+
+  // Each element is within a few ulps of the double precision product,
+  // relative to the size of the terms summed
+  std::mt19937 random(23);
+  for(int n=0; n<10000; ++n) {
+    gvr::Mat4f a, b;
+    MakeMatrices(random, &a, &b);
+    gvr::Mat4f product = MatrixUtils::MultiplyMM(a, b);
+    for(int i=0; i<4; ++i) {
+      for(int j=0; j<4; ++j) {
+        double exact = 0.0, magnitude = 0.0;
+        for(int k=0; k<4; ++k) {
+          exact += (double)a.m[i][k] * b.m[k][j];
+          magnitude += fabs((double)a.m[i][k] * b.m[k][j]);
+        }
+        CHECK(fabs(product.m[i][j] - exact) <= 4*FLT_EPSILON*magnitude);
+      }
+    }
+  }
+}
+
+TEST_CASE(PerspectiveIsAccurate) {
+  const gvr::Rectf fovs[] = {{45, 45, 45, 45}, {50, 40, 45, 45}, {10, 80, 5, 60}};
+  const float near = 1.0f, far = 100.0f;
+  for(const gvr::Rectf& fov : fovs) {
+    gvr::Mat4f matrix = MatrixUtils::Perspective(fov, near, far);
+    double left = -tan(fov.left*M_PI/180)*near, right = tan(fov.right*M_PI/180)*near;
+    double bottom = -tan(fov.bottom*M_PI/180)*near, top = tan(fov.top*M_PI/180)*near;
+    CHECK_NEAR(matrix.m[0][0], 2*near/(right - left), 1e-5);
+    CHECK_NEAR(matrix.m[0][2], (right + left)/(right - left), 1e-5);
+    CHECK_NEAR(matrix.m[1][1], 2*near/(top - bottom), 1e-5);
+    CHECK_NEAR(matrix.m[1][2], (top + bottom)/(top - bottom), 1e-5);
+    CHECK_NEAR(matrix.m[2][2], (near + far)/(near - far), 1e-5);
+    CHECK_NEAR(matrix.m[2][3], 2*near*far/(near - far), 1e-4);
+    CHECK(matrix.m[3][2] == -1.0f && matrix.m[3][3] == 0.0f);
+  }
+}
+
+TEST_MAIN()
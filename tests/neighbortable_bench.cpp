@@ -0,0 +1,78 @@
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <linux/neighbour.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+
+#include <benchmark/benchmark.h>
+
+#include "neighbortable.h"
+
+// Parsing a 64k entry neighbor table from each source, with every eighth
+// entry incomplete
+static const unsigned int NUM_ENTRIES = 65536;
+
+static void BM_ParseArp(benchmark::State& state) {
+  std::string text =
+    "IP address       HW type     Flags       HW address            Mask     Device\n";
+  char line[128];
+  for(unsigned int i=0; i<NUM_ENTRIES; ++i) {
+    snprintf(line, sizeof(line),
+      "10.%u.%u.%-9u 0x1         %s         aa:bb:cc:%02x:%02x:%02x     *        wlan0\n",
+      (i >> 16) & 0xFF, (i >> 8) & 0xFF, i & 0xFF, (i % 8 == 7) ? "0x0" : "0x2",
+      (i >> 16) & 0xFF, (i >> 8) & 0xFF, i & 0xFF);
+    text += line;
+  }
+  std::vector<Neighbor> entries;
+  entries.reserve(NUM_ENTRIES);
+  for(auto _ : state) {
+    entries.clear();
+    NeighborTable::ParseArp(text.data(), text.size(), entries);
+    benchmark::DoNotOptimize(entries.data());
+  }
+  state.SetItemsProcessed(state.iterations()*NUM_ENTRIES);
+  state.SetBytesProcessed(state.iterations()*text.size());
+  state.counters["neighbors"] = entries.size();
+}
+
+static void BM_ParseMessages(benchmark::State& state) {
+  std::vector<char> data;
+  const size_t size = NLMSG_LENGTH(sizeof(struct ndmsg)) + RTA_SPACE(6) + RTA_SPACE(4);
+  for(unsigned int i=0; i<NUM_ENTRIES; ++i) {
+    size_t start = data.size();
+    data.resize(start + NLMSG_ALIGN(size));
+    struct nlmsghdr* header = (struct nlmsghdr*)&data[start];
+    header->nlmsg_len = size;
+    header->nlmsg_type = RTM_NEWNEIGH;
+    struct ndmsg* msg = (struct ndmsg*)NLMSG_DATA(header);
+    msg->ndm_family = AF_INET;
+    msg->ndm_state = (i % 8 == 7) ? NUD_INCOMPLETE : NUD_STALE;
+    struct rtattr* attr = (struct rtattr*)((char*)msg + NLMSG_ALIGN(sizeof(struct ndmsg)));
+    attr->rta_type = NDA_LLADDR;
+    attr->rta_len = RTA_LENGTH(6);
+    attr = (struct rtattr*)((char*)attr + RTA_SPACE(6));
+    attr->rta_type = NDA_DST;
+    attr->rta_len = RTA_LENGTH(4);
+    uint32_t address = htonl(0x0A000000 + i);
+    memcpy(RTA_DATA(attr), &address, sizeof(address));
+  }
+  std::vector<Neighbor> entries;
+  entries.reserve(NUM_ENTRIES);
+  for(auto _ : state) {
+    entries.clear();
+    NeighborTable::ParseMessages(data.data(), data.size(), entries);
+    benchmark::DoNotOptimize(entries.data());
+  }
+  state.SetItemsProcessed(state.iterations()*NUM_ENTRIES);
+  state.SetBytesProcessed(state.iterations()*data.size());
+  state.counters["neighbors"] = entries.size();
+}
+
+BENCHMARK(BM_ParseArp)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ParseMessages)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
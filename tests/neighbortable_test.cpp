@@ -0,0 +1,113 @@
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <linux/neighbour.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+
+#include "neighbortable.h"
+#include "testutils.h"
+
+static bool operator==(const Neighbor& a, const Neighbor& b) {
+  return a.address == b.address && a.reachable == b.reachable;
+}
+
+// Append a neighbor message with the link-layer address ahead of the
+// destination, as the kernel orders them, or no destination at all
+static void AppendMessage(std::vector<char>& data, uint16_t type, uint8_t family,
+  uint16_t state, const void* address, size_t addressSize) {
+
+  const unsigned char lladdr[6] = {0x02, 0, 0, 0, 0, 0x01};
+  size_t start = data.size();
+  size_t size = NLMSG_LENGTH(sizeof(struct ndmsg)) + RTA_SPACE(sizeof(lladdr)) +
+    (address ? RTA_SPACE(addressSize) : 0);
+  data.resize(start + NLMSG_ALIGN(size));
+  struct nlmsghdr* header = (struct nlmsghdr*)&data[start];
+  header->nlmsg_len = size;
+  header->nlmsg_type = type;
+  struct ndmsg* msg = (struct ndmsg*)NLMSG_DATA(header);
+  msg->ndm_family = family;
+  msg->ndm_state = state;
+  struct rtattr* attr = (struct rtattr*)((char*)msg + NLMSG_ALIGN(sizeof(struct ndmsg)));
+  attr->rta_type = NDA_LLADDR;
+  attr->rta_len = RTA_LENGTH(sizeof(lladdr));
+  memcpy(RTA_DATA(attr), lladdr, sizeof(lladdr));
+  if(address) {
+    attr = (struct rtattr*)((char*)attr + RTA_SPACE(sizeof(lladdr)));
+    attr->rta_type = NDA_DST;
+    attr->rta_len = RTA_LENGTH(addressSize);
+    memcpy(RTA_DATA(attr), address, addressSize);
+  }
+}
+
+static void AppendNeighbor(std::vector<char>& data, uint16_t type, uint16_t state,
+  uint32_t address) {
+  uint32_t networkAddress = htonl(address);
+  AppendMessage(data, type, AF_INET, state, &networkAddress, sizeof(networkAddress));
+}
+
+TEST_CASE(ParsesArpFile) {
+
+  // Complete entries are kept, permanent ones as reachable. Malformed
+  // lines are skipped and the last line needs no newline.
+  const std::string text =
+    "IP address       HW type     Flags       HW address            Mask     Device\n"
+    "192.168.1.1      0x1         0x2         aa:bb:cc:00:00:01     *        wlan0\n"
+    "192.168.1.7      0x1         0x0         00:00:00:00:00:00     *        wlan0\n"
+    "192.168.1.9      0x1         0x6         aa:bb:cc:00:00:09     *        wlan0\n"
+    "\n"
+    "not an address   0x1         0x2         aa:bb:cc:00:00:0a     *        wlan0\n"
+    "192.168.1.300    0x1         0x2         aa:bb:cc:00:00:0b     *        wlan0\n"
+    "192.168.1        0x1         0x2         aa:bb:cc:00:00:0c     *        wlan0\n"
+    "192.168.1.12\t0x1\t0xA\taa:bb:cc:00:00:0d\t*\twlan0\n"
+    "10.0.0.2         0x1         0x4         aa:bb:cc:00:00:0e     *        wlan0\n"
+    "10.0.0.3         0x1         0x2         aa:bb:cc:00:00:0f     *        wlan0";
+  std::vector<Neighbor> entries;
+  NeighborTable::ParseArp(text.data(), text.size(), entries);
+  const std::vector<Neighbor> expected = {
+    {0xC0A80101, false}, {0xC0A80109, true}, {0xC0A8010C, false}, {0x0A000003, false}};
+  CHECK(entries == expected);
+
+  // A header alone, or nothing at all, yields nothing
+  entries.clear();
+  NeighborTable::ParseArp(text.data(), text.find('\n'), entries);
+  NeighborTable::ParseArp(text.data(), 0, entries);
+  CHECK(entries.empty());
+}
+
+TEST_CASE(ParsesNeighborMessages) {
+  std::vector<char> data;
+  AppendNeighbor(data, RTM_NEWNEIGH, NUD_REACHABLE, 0xC0A80101);
+  AppendNeighbor(data, RTM_NEWNEIGH, NUD_STALE, 0xC0A80102);
+  AppendNeighbor(data, RTM_NEWNEIGH, NUD_PERMANENT, 0xC0A80103);
+  AppendNeighbor(data, RTM_NEWNEIGH, NUD_DELAY, 0xC0A80104);
+  AppendNeighbor(data, RTM_NEWNEIGH, NUD_INCOMPLETE, 0xC0A80105);
+  AppendNeighbor(data, RTM_NEWNEIGH, NUD_FAILED, 0xC0A80106);
+  AppendNeighbor(data, RTM_DELNEIGH, NUD_REACHABLE, 0xC0A80107);
+  const unsigned char ipv6[16] = {0xFE, 0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1};
+  AppendMessage(data, RTM_NEWNEIGH, AF_INET6, NUD_REACHABLE, ipv6, sizeof(ipv6));
+  AppendMessage(data, RTM_NEWNEIGH, AF_INET, NUD_REACHABLE, NULL, 0);
+  AppendNeighbor(data, RTM_NEWNEIGH, NUD_PROBE, 0xC0A80108);
+
+  // Incomplete, failed, removed, IPv6 and addressless neighbors are skipped
+  std::vector<Neighbor> entries;
+  NeighborTable::ParseMessages(data.data(), data.size(), entries);
+  const std::vector<Neighbor> expected = {
+    {0xC0A80101, true}, {0xC0A80102, false}, {0xC0A80103, true}, {0xC0A80104, false},
+    {0xC0A80108, false}};
+  CHECK(entries == expected);
+
+  // A message cut short ends the batch without reading past it
+  size_t whole = data.size();
+  AppendNeighbor(data, RTM_NEWNEIGH, NUD_REACHABLE, 0xC0A80109);
+  for(size_t size=whole + 1; size<data.size(); ++size) {
+    std::vector<char> cut(data.begin(), data.begin() + size);
+    entries.clear();
+    NeighborTable::ParseMessages(cut.data(), cut.size(), entries);
+    CHECK(entries == expected);
+  }
+}
+
+TEST_MAIN()
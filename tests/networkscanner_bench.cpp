@@ -0,0 +1,56 @@
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "networkscanner.h"
+#include "testnetwork.h"
+
+// Time to sweep a /24, /20 and /16 with one live host in 64, the rest
+// silent. Runs in a private network namespace, so it needs root.
+//   networkscanner_bench
+
+static const uint32_t SUBNET = 0x0A630000;  // 10.99.0.0
+static const uint32_t LIVE_SPACING = 64;
+
+static void BM_Sweep(benchmark::State& state) {
+  int prefixLength = (int)state.range(0);
+  uint32_t size = 1u << (32 - prefixLength);
+  std::vector<uint32_t> live;
+  for(uint32_t i=LIVE_SPACING; i<size - 1; i+=LIVE_SPACING) {
+    live.push_back(SUBNET + i);
+  }
+  if(!TestNetwork::Create(SUBNET + 1, prefixLength) || !TestNetwork::AddHosts(live)) {
+    state.SkipWithError("needs root to create a network namespace");
+    return;
+  }
+
+  std::mutex mutex;
+  std::condition_variable done;
+  unsigned int found = 0;
+  bool complete = false;
+  NetworkScanner scanner(
+    [&](const std::string&) { std::lock_guard<std::mutex> lock(mutex); ++found; },
+    [](uint32_t) {},
+    []() {},
+    [&]() { std::lock_guard<std::mutex> lock(mutex); complete = true; done.notify_all(); });
+  for(auto _ : state) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      found = 0;
+      complete = false;
+    }
+    scanner.Start(SUBNET + 1, prefixLength, 0, false);
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&]() { return complete; });
+  }
+  scanner.Stop();
+  state.counters["hosts_found"] = found;
+  state.counters["addresses"] = size - 2;
+}
+
+BENCHMARK(BM_Sweep)->Arg(24)->Arg(20)->Arg(16)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+BENCHMARK_MAIN();
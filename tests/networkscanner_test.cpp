@@ -0,0 +1,145 @@
+#include <arpa/inet.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <string>
+
+#include "networkscanner.h"
+#include "testnetwork.h"
+#include "testutils.h"
+
+// Records what a scanner reports, by address
+class ScanRecorder {
+
+  public:
+    ScanRecorder():
+      scanner(
+        [this](const std::string& host) { Found(host); },
+        [this](uint32_t address) { Lost(address); },
+        []() {},
+        [this]() { Complete(); }),
+      reports(0),
+      complete(false) {}
+
+    NetworkScanner scanner;
+
+    // Wait for the sweep to complete, false on timeout
+    bool WaitComplete(std::chrono::milliseconds timeout) {
+      std::unique_lock<std::mutex> lock(mutex);
+      return changed.wait_for(lock, timeout, [this]() { return complete; });
+    }
+
+    // Wait until a host has been found, false on timeout
+    bool WaitFound(uint32_t address, std::chrono::milliseconds timeout) {
+      std::unique_lock<std::mutex> lock(mutex);
+      return changed.wait_for(lock, timeout, [this, address]() { return found.count(address) > 0; });
+    }
+
+    // Wait until a host has been lost, false on timeout
+    bool WaitLost(uint32_t address, std::chrono::milliseconds timeout) {
+      std::unique_lock<std::mutex> lock(mutex);
+      return changed.wait_for(lock, timeout, [this, address]() { return lost.count(address) > 0; });
+    }
+
+    std::set<uint32_t> Found() {
+      std::lock_guard<std::mutex> lock(mutex);
+      return found;
+    }
+
+    unsigned int Reports() {
+      std::lock_guard<std::mutex> lock(mutex);
+      return reports;
+    }
+
+  private:
+    void Found(const std::string& host) {
+      struct in_addr addr;
+      std::string ip = host.substr(host.rfind(':') + 1);
+      std::lock_guard<std::mutex> lock(mutex);
+      ++reports;
+      if(inet_pton(AF_INET, ip.c_str(), &addr) == 1) {
+        found.insert(ntohl(addr.s_addr));
+        lost.erase(ntohl(addr.s_addr));
+      }
+      changed.notify_all();
+    }
+
+    void Lost(uint32_t address) {
+      std::lock_guard<std::mutex> lock(mutex);
+      found.erase(address);
+      lost.insert(address);
+      changed.notify_all();
+    }
+
+    void Complete() {
+      std::lock_guard<std::mutex> lock(mutex);
+      complete = true;
+      changed.notify_all();
+    }
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::set<uint32_t> found, lost;
+    unsigned int reports;
+    bool complete;
+};
+
+static const uint32_t SUBNET = 0x0A630000;  // 10.99.0.0
+
+TEST_CASE(SweepsLoopbackSubnet) {
+
+  // Every loopback address answers, so the whole /24 is found
+  ScanRecorder recorder;
+  recorder.scanner.Start(0x7F000001, 24, 0, false);
+  REQUIRE(recorder.WaitComplete(std::chrono::seconds(10)));
+  std::set<uint32_t> found = recorder.Found();
+  CHECK(found.size() == 254);
+  CHECK(found.count(0x7F000001) == 1 && found.count(0x7F0000FE) == 1);
+  CHECK(found.count(0x7F000000) == 0 && found.count(0x7F0000FF) == 0);
+}
+
+TEST_CASE(FindsOnlyLiveHosts) {
+  if(!TestNetwork::Create(SUBNET + 1, 24)) {
+    SKIP_TEST("needs root to create a network namespace");
+  }
+  std::set<uint32_t> live = {SUBNET + 1, SUBNET + 5, SUBNET + 77, SUBNET + 200};
+  REQUIRE(TestNetwork::AddHosts({SUBNET + 5, SUBNET + 77, SUBNET + 200}));
+
+  // The silent hosts hold the sweep for one probe timeout
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  ScanRecorder recorder;
+  recorder.scanner.Start(SUBNET + 1, 24, 0, false);
+  REQUIRE(recorder.WaitComplete(std::chrono::seconds(10)));
+  CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds(3));
+  CHECK(recorder.Found() == live);
+  CHECK(recorder.Reports() == live.size());
+}
+
+TEST_CASE(MonitorReportsOnlyChanges) {
+  if(!TestNetwork::Create(SUBNET + 1, 24)) {
+    SKIP_TEST("needs root to create a network namespace");
+  }
+  REQUIRE(TestNetwork::AddHosts({SUBNET + 5, SUBNET + 6}));
+  ScanRecorder recorder;
+  recorder.scanner.Start(SUBNET + 1, 24, 0, true);
+  REQUIRE(recorder.WaitComplete(std::chrono::seconds(10)));
+  REQUIRE(recorder.Reports() == 3);
+
+  // A host that leaves is lost after three silent rounds of known hosts,
+  // and one that joins early in the subnet is found by the first slice of
+  // the background pass
+  REQUIRE(TestNetwork::RemoveHosts({SUBNET + 5}));
+  REQUIRE(TestNetwork::AddHosts({SUBNET + 9}));
+  CHECK(recorder.WaitFound(SUBNET + 9, std::chrono::seconds(10)));
+  CHECK(recorder.WaitLost(SUBNET + 5, std::chrono::seconds(25)));
+  std::set<uint32_t> live = {SUBNET + 1, SUBNET + 6, SUBNET + 9};
+  CHECK(recorder.Found() == live);
+
+  // Hosts that stay are never reported again
+  CHECK(recorder.Reports() == 4);
+  recorder.scanner.Stop();
+}
+
+TEST_MAIN()
@@ -0,0 +1,162 @@
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "headlessrenderer.h"
+#include "recordinggl.h"
+#include "stubgvr.h"
+
+// CPU time per frame and GL traffic of the renderer against the recording
+// stubs, for synthetic scans of 10 to 50,000 hosts. Counters are per frame:
+// upload_bytes counts buffer and texture data, buffer copies and bound
+// uniform ranges.
+//   renderer_bench --benchmark_counters_tabular=true
+
+static std::vector<std::string> MakeHosts(unsigned int count) {
+  std::vector<std::string> hosts;
+  char host[64];
+  for(unsigned int i=0; i<count; ++i) {
+    snprintf(host, sizeof(host), "host%05u.lan:10.%u.%u.%u", i, i >> 16, (i >> 8) & 0xFF,
+      i & 0xFF);
+    hosts.push_back(host);
+  }
+  return hosts;
+}
+
+// Feed a whole scan, a queue's worth of hosts per frame as when the
+// scanner outpaces the display, returning the frames it took
+static unsigned int Scan(HeadlessRenderer& renderer, const std::vector<std::string>& hosts) {
+  unsigned int frames = 0;
+  for(size_t i=0; i<hosts.size(); ++i) {
+    renderer.AddHost(hosts[i]);
+    if((i + 1) % HeadlessRenderer::QueueSize() == 0 || i + 1 == hosts.size()) {
+      renderer.DrawFrame();
+      ++frames;
+    }
+  }
+  return frames;
+}
+
+static void SetCounters(benchmark::State& state, const GlCounters& counters,
+  uint64_t frames) {
+  double perFrame = 1.0/frames;
+  state.counters["frames"] = benchmark::Counter((double)frames,
+    benchmark::Counter::kAvgIterations);
+  state.counters["frame_time"] = benchmark::Counter((double)frames,
+    benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+  state.counters["gl_calls"] = counters.calls*perFrame;
+  state.counters["draws"] = counters.draws*perFrame;
+  state.counters["upload_bytes"] = counters.uploadBytes*perFrame;
+  state.counters["maps"] = counters.maps*perFrame;
+  state.counters["unmaps"] = counters.unmaps*perFrame;
+}
+
+// Frames of a scan in progress, from the first host to the last
+static void BM_ScanFrames(benchmark::State& state) {
+  std::vector<std::string> hosts = MakeHosts(state.range(0));
+  const char* extensions = state.range(1) ? "GL_OVR_multiview" : "";
+  uint64_t frames = 0;
+  GlCounters totals = {};
+  for(auto _ : state) {
+    state.PauseTiming();
+    std::unique_ptr<HeadlessRenderer> renderer(new HeadlessRenderer(extensions));
+    renderer->SetState(HeadlessRenderer::SCANNING);
+    state.ResumeTiming();
+    frames += Scan(*renderer, hosts);
+    state.PauseTiming();
+    const GlCounters& counters = GetGlCounters();
+    totals.calls += counters.calls;
+    totals.draws += counters.draws;
+    totals.uploadBytes += counters.uploadBytes;
+    totals.maps += counters.maps;
+    totals.unmaps += counters.unmaps;
+    renderer.reset();
+    state.ResumeTiming();
+  }
+  SetCounters(state, totals, frames);
+}
+
+// Frames once the scan has finished, with the controller on the first
+// host so the detail box is drawn too
+static void BM_SteadyFrame(benchmark::State& state) {
+  std::vector<std::string> hosts = MakeHosts(state.range(0));
+  HeadlessRenderer renderer(state.range(1) ? "GL_OVR_multiview" : "");
+  renderer.SetState(HeadlessRenderer::SCANNING);
+  Scan(renderer, hosts);
+  renderer.SetScanComplete();
+  AimStubController(0.0f, -0.75f, -5.0f);
+  renderer.DrawFrame();
+  renderer.DrawFrame();
+  ResetGlCounters();
+  uint64_t frames = 0;
+  for(auto _ : state) {
+    renderer.DrawFrame();
+    ++frames;
+  }
+  SetCounters(state, GetGlCounters(), frames);
+}
+
+// From starting the scan to the end of the first frame, which shows the
+// previous scan's hosts from the cache. The renderer shows at most
+// MAX_HOSTS (65536) of them.
+static void BM_CachedFirstFrame(benchmark::State& state) {
+  char dirTemplate[] = "/tmp/renderer_bench.XXXXXX";
+  if(!mkdtemp(dirTemplate)) {
+    state.SkipWithError("can't create a cache directory");
+    return;
+  }
+  const std::string dir = dirTemplate;
+  for(auto _ : state) {
+
+    // The cache is written afresh in case the last scan replaced it
+    state.PauseTiming();
+    HeadlessRenderer::WriteHostCache(dir, "127.0.0.1", 30, "bench", state.range(0));
+    std::unique_ptr<HeadlessRenderer> renderer(new HeadlessRenderer("", dir));
+    renderer->SetState(HeadlessRenderer::SCANNING);
+    state.ResumeTiming();
+    renderer->StartScan("127.0.0.1", 30, "bench");
+    renderer->DrawFrame();
+    state.PauseTiming();
+    renderer.reset();
+    state.ResumeTiming();
+  }
+  if(system(("rm -rf " + dir).c_str()) != 0) {
+    state.SkipWithError("can't remove the cache directory");
+  }
+}
+
+// From creating the renderer and its surface to the end of the first
+// frame, which shows the not connected message, with programs compiled in
+// turn (0) or in parallel (1)
+static void BM_Startup(benchmark::State& state) {
+  const char* extensions = state.range(0) ? "GL_KHR_parallel_shader_compile" : "";
+  for(auto _ : state) {
+    std::unique_ptr<HeadlessRenderer> renderer(
+      new HeadlessRenderer(extensions, std::string(), true, false));
+    renderer->DrawFrame();
+    state.PauseTiming();
+    renderer.reset();
+    state.ResumeTiming();
+  }
+}
+
+// Host counts, then two-pass (0) or multiview (1) stereo
+static void HostCounts(benchmark::internal::Benchmark* b) {
+  for(int multiview=0; multiview<2; ++multiview) {
+    for(int hosts : {10, 100, 1000, 10000, 50000}) {
+      b->Args({hosts, multiview});
+    }
+  }
+}
+
+BENCHMARK(BM_ScanFrames)->Apply(HostCounts)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_SteadyFrame)->Apply(HostCounts)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Startup)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_CachedFirstFrame)->Arg(100)->Arg(10000)->Arg(100000)
+  ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,319 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "headlessrenderer.h"
+#include "matrixutils.h"
+#include "recordinggl.h"
+#include "stubandroid.h"
+#include "stubgvr.h"
+#include "textutils.h"
+#include "testutils.h"
+
+// Name and address of the nth host of a synthetic scan
+static std::string HostString(unsigned int n) {
+  char host[64];
+  snprintf(host, sizeof(host), "host%05u.lan:10.0.%u.%u", n, n >> 8, n & 0xFF);
+  return host;
+}
+
+// Draws of one frame with this many instances, or a number in a range
+static unsigned int CountDraws(unsigned int minInstances, unsigned int maxInstances) {
+  unsigned int count = 0;
+  for(const GlDraw& draw : GetGlDraws()) {
+    count += (draw.instances >= (GLsizei)minInstances && draw.instances <= (GLsizei)maxInstances);
+  }
+  return count;
+}
+
+static unsigned int CountDraws(unsigned int instances) {
+  return CountDraws(instances, instances);
+}
+
+TEST_CASE(DrawsEveryScannedHost) {
+  HeadlessRenderer renderer("");
+  renderer.SetState(HeadlessRenderer::SCANNING);
+  const unsigned int numHosts = 1000;
+  for(unsigned int i=0; i<numHosts; ++i) {
+    renderer.AddHost(HostString(i));
+    if((i + 1) % HeadlessRenderer::QueueSize() == 0) {
+      renderer.DrawFrame();
+    }
+  }
+  renderer.SetScanComplete();
+  renderer.DrawFrame();
+
+  // Each eye draws the buttons and their labels, every host at once
+  RecordGlDraws(true);
+  renderer.DrawFrame();
+  CHECK(CountDraws(numHosts) == 2);
+  CHECK(CountDraws(10*numHosts) == 2);
+  RecordGlDraws(false);
+  CHECK(StubLogErrors() == 0);
+}
+
+TEST_CASE(ShowsCachedHostsOnFirstFrame) {
+  char dirTemplate[] = "/tmp/renderer_test.XXXXXX";
+  REQUIRE(mkdtemp(dirTemplate) != NULL);
+  const std::string dir = dirTemplate;
+  const unsigned int numCached = 500;
+  REQUIRE(HeadlessRenderer::WriteHostCache(dir, "127.0.0.1", 30, "test", numCached));
+
+  // The first frame after the scan starts draws the whole cached wall,
+  // and the live hosts if the sweep has found them already
+  HeadlessRenderer* renderer = new HeadlessRenderer("", dir);
+  renderer->SetState(HeadlessRenderer::SCANNING);
+  renderer->StartScan("127.0.0.1", 30, "test");
+  RecordGlDraws(true);
+  renderer->DrawFrame();
+  CHECK(CountDraws(numCached, numCached + 2) == 2);
+  CHECK(CountDraws(10*numCached, 10*(numCached + 2)) == 2);
+  RecordGlDraws(false);
+
+  // None of them answer on loopback, where the sweep finds the two
+  // addresses of the /30, so the cache is rewritten with just those
+  std::chrono::steady_clock::time_point deadline =
+    std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while(HeadlessRenderer::ReadHostCache(dir, "127.0.0.1", 30, "test") != 2 &&
+        std::chrono::steady_clock::now() < deadline) {
+    renderer->DrawFrame();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  delete renderer;
+  CHECK(HeadlessRenderer::ReadHostCache(dir, "127.0.0.1", 30, "test") == 2);
+  CHECK(StubLogErrors() == 0);
+  CHECK(system(("rm -rf " + dir).c_str()) == 0);
+}
+
+// Per-eye MVP matrices of the recorded frame, read from the uniform blocks
+// its draws use, and the number of distinct blocks
+static unsigned int ReadEyeMatrices(float matrices[2][16], std::string* vertexSource) {
+
+  // Blocks in the order the eyes are drawn
+  std::set<std::pair<GLuint, GLintptr> > seen;
+  unsigned int blocks = 0;
+  for(const GlDraw& draw : GetGlDraws()) {
+    if(draw.uniformSize == 0 || !seen.insert(std::make_pair(draw.uniformBuffer, draw.uniformOffset)).second) {
+      continue;
+    }
+    const std::vector<uint8_t>* buffer = GetGlBuffer(draw.uniformBuffer);
+    if(buffer && blocks < 2 && draw.uniformOffset + 2*sizeof(matrices[0]) <= buffer->size()) {
+      memcpy(matrices[blocks], buffer->data() + draw.uniformOffset,
+        (seen.size() == 1 ? 2 : 1)*sizeof(matrices[0]));
+    }
+    const std::string* source = GetGlVertexSource(draw.program);
+    if(++blocks == 1 && source && vertexSource) {
+      *vertexSource = *source;
+    }
+  }
+  return blocks;
+}
+
+// Eye matrices of a frame with the head turned, so neither is trivial
+static unsigned int DrawEyeMatrices(const char* extensions, float matrices[2][16],
+  std::string* vertexSource, bool bufferStorage = true) {
+
+  HeadlessRenderer renderer(extensions, std::string(), bufferStorage);
+  renderer.SetState(HeadlessRenderer::SCANNING);
+  renderer.AddHost(HostString(0));
+  renderer.DrawFrame();
+  const float yaw = 0.5f, pitch = 0.2f;
+  gvr_mat4f& head = GetStubHeadset().headRotation;
+  memset(&head, 0, sizeof(head));
+  head.m[0][0] = cosf(yaw);               head.m[0][2] = sinf(yaw);
+  head.m[1][0] = sinf(pitch)*sinf(yaw);   head.m[1][1] = cosf(pitch);
+  head.m[1][2] = -sinf(pitch)*cosf(yaw);
+  head.m[2][0] = -cosf(pitch)*sinf(yaw);  head.m[2][1] = sinf(pitch);
+  head.m[2][2] = cosf(pitch)*cosf(yaw);
+  head.m[3][3] = 1.0f;
+
+  RecordGlDraws(true);
+  renderer.DrawFrame();
+  unsigned int blocks = ReadEyeMatrices(matrices, vertexSource);
+  RecordGlDraws(false);
+  return blocks;
+}
+
+TEST_CASE(MultiviewMatchesTwoPassMatrices) {
+
+  // Two passes bind one block per eye; multiview binds one holding both
+  float twoPass[2][16], multiview[2][16];
+  std::string twoPassSource, multiviewSource;
+  REQUIRE(DrawEyeMatrices("", twoPass, &twoPassSource) == 2);
+  REQUIRE(DrawEyeMatrices("GL_OVR_multiview", multiview, &multiviewSource) == 1);
+  CHECK(twoPassSource.find("GL_OVR_multiview") == std::string::npos);
+  CHECK(multiviewSource.find("GL_OVR_multiview") != std::string::npos);
+
+  // Both paths compute the same matrices, which differ between the eyes
+  CHECK(memcmp(twoPass, multiview, sizeof(twoPass)) == 0);
+  CHECK(memcmp(twoPass[0], twoPass[1], sizeof(twoPass[0])) != 0);
+  CHECK(StubLogErrors() == 0);
+}
+
+TEST_CASE(ProjectionFollowsFieldOfView) {
+  HeadlessRenderer renderer("");
+  renderer.SetState(HeadlessRenderer::SCANNING);
+  renderer.AddHost(HostString(0));
+  renderer.DrawFrame();
+  float before[2][16], after[2][16];
+  RecordGlDraws(true);
+  renderer.DrawFrame();
+  REQUIRE(ReadEyeMatrices(before, NULL) == 2);
+  RecordGlDraws(false);
+
+  // Widening the left eye's view rebuilds only its cached projection,
+  // which then matches one computed from scratch. The renderer clips at
+  // 1 and 100 and the head is level.
+  StubHeadset& headset = GetStubHeadset();
+  headset.fov[GVR_LEFT_EYE].left = 60.0f;
+  RecordGlDraws(true);
+  renderer.DrawFrame();
+  REQUIRE(ReadEyeMatrices(after, NULL) == 2);
+  RecordGlDraws(false);
+  CHECK(memcmp(before[0], after[0], sizeof(before[0])) != 0);
+  CHECK(memcmp(before[1], after[1], sizeof(before[1])) == 0);
+  gvr::Rectf fov = headset.fov[GVR_LEFT_EYE];
+  gvr::Mat4f expected = MatrixUtils::MultiplyMMTranspose(MatrixUtils::Perspective(fov, 1.0f, 100.0f),
+    MatrixUtils::MultiplyMM(headset.eyeFromHead[GVR_LEFT_EYE], headset.headRotation));
+  CHECK(memcmp(&expected, after[0], sizeof(expected)) == 0);
+}
+
+// Glyph instances the detail box draws and their (x, y, s, t) corners,
+// 8 floats each, read back from the buffer its draw sources them from
+static unsigned int StreamedBoxText(std::vector<float>* instances) {
+  const unsigned int ATTRIB_LOWER = 4;
+  for(const GlDraw& draw : GetGlDraws()) {
+    if(!(draw.enabledAttribs & (1u << ATTRIB_LOWER))) {
+      continue;
+    }
+    const std::vector<uint8_t>* buffer = GetGlBuffer(draw.attribBuffers[ATTRIB_LOWER]);
+    size_t offset = draw.attribOffsets[ATTRIB_LOWER];
+    size_t size = 8*sizeof(float)*draw.instances;
+    if(draw.mode != GL_TRIANGLE_STRIP || draw.count != 4 || !buffer ||
+       offset + size > buffer->size()) {
+      return 0;
+    }
+    instances->resize(8*draw.instances);
+    memcpy(instances->data(), buffer->data() + offset, size);
+    return draw.instances;
+  }
+  return 0;
+}
+
+TEST_CASE(StreamsLongHostNameInstances) {
+
+  // A 250 character name of 48 character labels, far past what 8-bit
+  // quad indices could address
+  std::string name;
+  for(unsigned int i=0; i<250; ++i) {
+    name.push_back((i % 49 == 48) ? '.' : (char)('a' + i % 26));
+  }
+  const std::string ip = "10.0.0.1";
+  HeadlessRenderer renderer("");
+  renderer.SetState(HeadlessRenderer::SCAN_FINISHED);
+  renderer.AddHost(name + ":" + ip);
+  AimStubController(0.0f, -0.75f, -5.0f);
+  renderer.DrawFrame();
+  RecordGlDraws(true);
+  renderer.DrawFrame();
+
+  // One instance per character of both lines
+  const std::string lines[2] = {"Host: " + name, "IP Address: " + ip};
+  std::vector<float> instances;
+  unsigned int count = StreamedBoxText(&instances);
+  RecordGlDraws(false);
+  REQUIRE(count == lines[0].length() + lines[1].length());
+
+  // Texture corners come straight from the atlas. Quads follow the pen
+  // along each line, and both lines start at the box's left edge, which
+  // the longer one mirrors at its end.
+  const TextureAtlas& atlas = TextUtils::GetAtlas();
+  const float* quad = instances.data();
+  float scale = 0.0f, lineStart[2] = {0.0f, 0.0f}, lineEnd = 0.0f;
+  for(unsigned int line=0; line<2; ++line) {
+    float pen = 0.0f;
+    for(unsigned int i=0; i<lines[line].length(); ++i, quad += 8) {
+      const TextureChar& ch = TextUtils::Glyph(atlas, (unsigned char)lines[line][i]);
+      CHECK(quad[2] == ch.x && quad[3] == ch.y - ch.height);
+      CHECK(quad[6] == ch.x + ch.width && quad[7] == ch.y);
+      if(scale == 0.0f) {
+        scale = (quad[5] - quad[1])/(ch.height*atlas.textureHeight);
+        REQUIRE(scale > 0.0f);
+      }
+      if(i == 0) {
+        lineStart[line] = quad[0] - ch.xOffset*scale;
+        pen = lineStart[line];
+      }
+      CHECK_NEAR(quad[0], pen + ch.xOffset*scale, 1e-4f);
+      CHECK_NEAR(quad[4] - quad[0], ch.width*scale*atlas.textureWidth, 1e-4f);
+      pen += ch.xAdvance*scale;
+    }
+    if(line == 0) {
+      lineEnd = pen;
+    }
+  }
+  CHECK_NEAR(lineStart[0], lineStart[1], 1e-4f);
+  CHECK_NEAR(lineEnd, -lineStart[0], 1e-3f);
+  CHECK(StubLogErrors() == 0);
+}
+
+// Contents of the buffers a frame's host label draw sources its instances
+// from, and the detail box glyphs, with a scan's hosts on the wall
+static void DrawStreamedData(bool bufferStorage, unsigned int numHosts,
+  std::vector<uint8_t>* labels, std::vector<float>* boxText) {
+
+  HeadlessRenderer renderer("", std::string(), bufferStorage);
+  renderer.SetState(HeadlessRenderer::SCAN_FINISHED);
+  for(unsigned int i=0; i<numHosts; ++i) {
+    renderer.AddHost(HostString(i));
+    if((i + 1) % HeadlessRenderer::QueueSize() == 0) {
+      renderer.DrawFrame();
+    }
+  }
+  AimStubController(0.0f, -0.75f, -5.0f);
+  renderer.DrawFrame();
+  RecordGlDraws(true);
+  renderer.DrawFrame();
+  labels->clear();
+  for(const GlDraw& draw : GetGlDraws()) {
+    if(draw.instances != (GLsizei)(10*numHosts)) {
+      continue;
+    }
+    for(unsigned int i=0; i<STUB_MAX_ATTRIBS; ++i) {
+      const std::vector<uint8_t>* buffer = GetGlBuffer(draw.attribBuffers[i]);
+      if((draw.enabledAttribs & (1u << i)) && buffer) {
+        labels->insert(labels->end(), buffer->begin(), buffer->end());
+      }
+    }
+    break;
+  }
+  StreamedBoxText(boxText);
+  RecordGlDraws(false);
+}
+
+TEST_CASE(StagesStreamWithoutBufferStorage) {
+
+  // Without persistent mapping the uniforms, host labels and detail box
+  // are staged and uploaded, and the draws read the same data
+  float mapped[2][16], staged[2][16];
+  REQUIRE(DrawEyeMatrices("", mapped, NULL) == 2);
+  REQUIRE(DrawEyeMatrices("", staged, NULL, false) == 2);
+  CHECK(memcmp(mapped, staged, sizeof(mapped)) == 0);
+
+  const unsigned int numHosts = 1000;
+  std::vector<uint8_t> mappedLabels, stagedLabels;
+  std::vector<float> mappedBox, stagedBox;
+  DrawStreamedData(true, numHosts, &mappedLabels, &mappedBox);
+  DrawStreamedData(false, numHosts, &stagedLabels, &stagedBox);
+  CHECK(!mappedLabels.empty() && stagedLabels == mappedLabels);
+  CHECK(!mappedBox.empty() && stagedBox == mappedBox);
+  CHECK(StubLogErrors() == 0);
+}
+
+TEST_MAIN()
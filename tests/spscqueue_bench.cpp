@@ -0,0 +1,67 @@
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include <benchmark/benchmark.h>
+
+#include "spscqueue.h"
+
+// Latency of handing a host from the scanner thread to the GL thread
+// through the renderer's queue. The producer fills slots in place as
+// AddHost does; the consumer copies each one out as DrainHosts does and
+// notes how long it waited in the queue.
+//   spscqueue_bench
+
+typedef struct {
+  std::chrono::steady_clock::time_point pushed;
+  std::string hostName, ipAddr;
+} Item;
+
+static void BM_HostHandoff(benchmark::State& state) {
+  static SpscQueue<Item, 256> queue;
+  std::atomic<bool> stop(false);
+  std::atomic<uint64_t> received(0), waitNanos(0);
+
+  // The consumer polls, standing in for a GL thread that drains often.
+  // Both sides yield while waiting so they also share a single core.
+  std::thread consumer([&]() {
+    Item copy;
+    uint64_t count = 0, nanos = 0;
+    while(!stop || queue.Front() != NULL) {
+      Item* slot = queue.Front();
+      if(slot == NULL) {
+        std::this_thread::yield();
+        continue;
+      }
+      copy = *slot;
+      queue.Pop();
+      nanos += std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - copy.pushed).count();
+      ++count;
+    }
+    received = count;
+    waitNanos = nanos;
+  });
+
+  std::string name = "printer-second-floor.example.lan";
+  std::string ip = "192.168.100.200";
+  for(auto _ : state) {
+    Item* slot;
+    while((slot = queue.Back()) == NULL) {
+      std::this_thread::yield();
+    }
+    slot->hostName.assign(name);
+    slot->ipAddr.assign(ip);
+    slot->pushed = std::chrono::steady_clock::now();
+    queue.Push();
+  }
+  stop = true;
+  consumer.join();
+  state.counters["latency_ns"] = (double)waitNanos/std::max<uint64_t>(received, 1);
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_HostHandoff)->UseRealTime();
+
+BENCHMARK_MAIN();
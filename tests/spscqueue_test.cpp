@@ -0,0 +1,116 @@
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#include "headlessrenderer.h"
+#include "recordinggl.h"
+#include "spscqueue.h"
+#include "testutils.h"
+
+// Built with ThreadSanitizer, which reports any race between the producer
+// and consumer sides, and fails the run if it finds one
+
+// Slot shaped like the renderer's hosts: strings assigned in place
+typedef struct {
+  uint64_t sequence;
+  std::string name;
+} Item;
+
+static std::string ItemName(uint64_t sequence) {
+  return "host" + std::to_string(sequence) + ".lan";
+}
+
+TEST_CASE(FillsAndDrainsInOrder) {
+  SpscQueue<Item, 4> queue;
+  CHECK(queue.Front() == NULL);
+  for(uint64_t i=0; i<4; ++i) {
+    Item* slot = queue.Back();
+    REQUIRE(slot != NULL);
+    slot->sequence = i;
+    queue.Push();
+  }
+  CHECK(queue.Back() == NULL);
+  for(uint64_t i=0; i<4; ++i) {
+    Item* slot = queue.Front();
+    REQUIRE(slot != NULL);
+    CHECK(slot->sequence == i);
+    queue.Pop();
+  }
+  CHECK(queue.Front() == NULL);
+  CHECK(queue.Back() != NULL);
+}
+
+TEST_CASE(StressesProducerAndConsumer) {
+
+  // A small queue keeps both sides wrapping and meeting at full and empty
+  static SpscQueue<Item, 16> queue;
+  const uint64_t numItems = 200000;
+  std::thread producer([numItems]() {
+    for(uint64_t i=0; i<numItems; ++i) {
+      Item* slot;
+      while((slot = queue.Back()) == NULL) {
+        std::this_thread::yield();
+      }
+      slot->sequence = i;
+      slot->name = ItemName(i);
+      queue.Push();
+    }
+  });
+
+  uint64_t expected = 0;
+  bool ordered = true;
+  while(expected < numItems) {
+    Item* slot = queue.Front();
+    if(slot == NULL) {
+      std::this_thread::yield();
+      continue;
+    }
+    ordered = ordered && slot->sequence == expected && slot->name == ItemName(expected);
+    queue.Pop();
+    ++expected;
+  }
+  producer.join();
+  CHECK(ordered);
+  CHECK(queue.Front() == NULL);
+}
+
+TEST_CASE(RendererHandoffUnderLoad) {
+
+  // A scanner thread reports hosts and losses faster than frames drain
+  // them, so it sleeps on the full queue and is woken by each frame
+  HeadlessRenderer renderer("");
+  renderer.SetState(HeadlessRenderer::SCANNING);
+  const unsigned int numHosts = 20000, numLost = 1000;
+  std::atomic<bool> done(false);
+  std::thread scanner([&renderer, &done, numHosts, numLost]() {
+    char host[64];
+    for(unsigned int i=0; i<numHosts; ++i) {
+      snprintf(host, sizeof(host), ":10.1.%u.%u", i >> 8, i & 0xFF);
+      renderer.AddHost(host);
+      snprintf(host, sizeof(host), "host%u.lan:10.1.%u.%u", i, i >> 8, i & 0xFF);
+      renderer.AddHost(host);
+    }
+    for(unsigned int i=numHosts - numLost; i<numHosts; ++i) {
+      renderer.LoseHost(0x0A010000 | i);
+    }
+    done = true;
+  });
+  while(!done) {
+    renderer.DrawFrame();
+  }
+  scanner.join();
+  renderer.DrawFrame();
+
+  // Losing the last hosts trims them off the wall
+  RecordGlDraws(true);
+  renderer.DrawFrame();
+  unsigned int buttons = 0;
+  for(const GlDraw& draw : GetGlDraws()) {
+    buttons += (draw.instances == (GLsizei)(numHosts - numLost));
+  }
+  RecordGlDraws(false);
+  CHECK(buttons == 2);
+}
+
+TEST_MAIN()
@@ -0,0 +1,28 @@
+#ifndef STUB_ANDROID_ASSET_MANAGER_H_
+#define STUB_ANDROID_ASSET_MANAGER_H_
+
+#include <sys/types.h>
+
+// Assets are served from a directory on disk, see stubassets.h
+typedef struct AAssetManager AAssetManager;
+typedef struct AAsset AAsset;
+
+enum {
+  AASSET_MODE_UNKNOWN = 0, AASSET_MODE_RANDOM = 1, AASSET_MODE_STREAMING = 2,
+  AASSET_MODE_BUFFER = 3
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+AAsset* AAssetManager_open(AAssetManager* mgr, const char* filename, int mode);
+const void* AAsset_getBuffer(AAsset* asset);
+off64_t AAsset_getLength64(AAsset* asset);
+void AAsset_close(AAsset* asset);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // STUB_ANDROID_ASSET_MANAGER_H_
@@ -0,0 +1,7 @@
+#ifndef STUB_ANDROID_ASSET_MANAGER_JNI_H_
+#define STUB_ANDROID_ASSET_MANAGER_JNI_H_
+
+#include <jni.h>
+#include <android/asset_manager.h>
+
+#endif  // STUB_ANDROID_ASSET_MANAGER_JNI_H_
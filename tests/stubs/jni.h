@@ -0,0 +1,17 @@
+#ifndef STUB_JNI_H_
+#define STUB_JNI_H_
+
+#include <stdint.h>
+
+// The few JNI types the renderer's headers name. Nothing in the headless
+// build calls into Java.
+typedef int32_t jint;
+typedef int64_t jlong;
+typedef uint8_t jboolean;
+typedef void* jobject;
+typedef jobject jstring;
+
+struct _JNIEnv;
+typedef struct _JNIEnv JNIEnv;
+
+#endif  // STUB_JNI_H_
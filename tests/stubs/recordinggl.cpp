@@ -0,0 +1,599 @@
+#include "recordinggl.h"
+
+#include <cstring>
+#include <string>
+#include <unordered_map>
+
+static const char* BASE_EXTENSIONS = "GL_EXT_buffer_storage";
+static const GLint UNIFORM_ALIGNMENT = 256;
+
+typedef struct {
+  uint32_t enabled;
+  GLuint buffers[STUB_MAX_ATTRIBS];
+  GLintptr offsets[STUB_MAX_ATTRIBS];
+} VertexArray;
+
+// Everything a context holds that the counters and draw log need
+static struct {
+  std::string extensions;
+  GLuint nextName;
+  std::unordered_map<GLuint, std::vector<uint8_t>> buffers;
+  std::unordered_map<GLuint, VertexArray> vertexArrays;
+  std::unordered_map<GLuint, std::string> shaderSources;
+  std::unordered_map<GLuint, GLuint> vertexShaders;
+  GLuint arrayBuffer, copyReadBuffer, copyWriteBuffer, uniformBuffer;
+  GLuint vao, program;
+  GLuint uniformBinding;
+  GLintptr uniformOffset;
+  GLsizeiptr uniformSize;
+  GlCounters counters;
+  bool recordDraws;
+  std::vector<GlDraw> draws;
+} gl;
+
+void ResetStubGl(const char* extensions, bool bufferStorage) {
+  gl.extensions = bufferStorage ? std::string(BASE_EXTENSIONS) + " " + extensions : extensions;
+  gl.nextName = 1;
+  gl.buffers.clear();
+  gl.vertexArrays.clear();
+  gl.vertexArrays[0] = VertexArray();
+  gl.shaderSources.clear();
+  gl.vertexShaders.clear();
+  gl.arrayBuffer = gl.copyReadBuffer = gl.copyWriteBuffer = gl.uniformBuffer = 0;
+  gl.vao = gl.program = 0;
+  gl.uniformBinding = 0;
+  gl.uniformOffset = gl.uniformSize = 0;
+  ResetGlCounters();
+  gl.draws.clear();
+}
+
+const GlCounters& GetGlCounters() {
+  return gl.counters;
+}
+
+void ResetGlCounters() {
+  memset(&gl.counters, 0, sizeof(gl.counters));
+}
+
+void RecordGlDraws(bool record) {
+  gl.recordDraws = record;
+  gl.draws.clear();
+}
+
+const std::vector<GlDraw>& GetGlDraws() {
+  return gl.draws;
+}
+
+const std::vector<uint8_t>* GetGlBuffer(GLuint buffer) {
+  std::unordered_map<GLuint, std::vector<uint8_t>>::const_iterator it = gl.buffers.find(buffer);
+  return (it == gl.buffers.end()) ? NULL : &it->second;
+}
+
+const std::string* GetGlVertexSource(GLuint program) {
+  std::unordered_map<GLuint, GLuint>::const_iterator it = gl.vertexShaders.find(program);
+  if(it == gl.vertexShaders.end()) {
+    return NULL;
+  }
+  return &gl.shaderSources[it->second];
+}
+
+static GLuint* Binding(GLenum target) {
+  switch(target) {
+    case GL_ARRAY_BUFFER: return &gl.arrayBuffer;
+    case GL_COPY_READ_BUFFER: return &gl.copyReadBuffer;
+    case GL_COPY_WRITE_BUFFER: return &gl.copyWriteBuffer;
+    case GL_UNIFORM_BUFFER: return &gl.uniformBuffer;
+    default: return NULL;
+  }
+}
+
+static std::vector<uint8_t>* Bound(GLenum target) {
+  GLuint* binding = Binding(target);
+  return (binding && *binding) ? &gl.buffers[*binding] : NULL;
+}
+
+static void GenNames(GLsizei n, GLuint* names) {
+  ++gl.counters.calls;
+  for(GLsizei i=0; i<n; ++i) {
+    names[i] = gl.nextName++;
+  }
+}
+
+static void Draw(GLenum mode, GLint first, GLsizei count, GLsizei instances) {
+  ++gl.counters.calls;
+  ++gl.counters.draws;
+  gl.counters.instances += instances;
+  if(!gl.recordDraws) {
+    return;
+  }
+  const VertexArray& vao = gl.vertexArrays[gl.vao];
+  GlDraw draw;
+  draw.mode = mode;
+  draw.first = first;
+  draw.count = count;
+  draw.instances = instances;
+  draw.program = gl.program;
+  draw.vao = gl.vao;
+  draw.uniformBuffer = gl.uniformBinding;
+  draw.uniformOffset = gl.uniformOffset;
+  draw.uniformSize = gl.uniformSize;
+  draw.enabledAttribs = vao.enabled;
+  memcpy(draw.attribBuffers, vao.buffers, sizeof(vao.buffers));
+  memcpy(draw.attribOffsets, vao.offsets, sizeof(vao.offsets));
+  gl.draws.push_back(draw);
+}
+
+static void SetAttribPointer(GLuint index, const void* pointer) {
+  ++gl.counters.calls;
+  VertexArray& vao = gl.vertexArrays[gl.vao];
+  vao.buffers[index] = gl.arrayBuffer;
+  vao.offsets[index] = (GLintptr)pointer;
+}
+
+// Extension entry points handed out through eglGetProcAddress
+static void GL_APIENTRY StubFramebufferTextureMultiview(GLenum target, GLenum attachment,
+  GLuint texture, GLint level, GLint baseViewIndex, GLsizei numViews) {
+  (void)target; (void)attachment; (void)texture; (void)level; (void)baseViewIndex;
+  (void)numViews;
+  ++gl.counters.calls;
+}
+
+static void GL_APIENTRY StubFramebufferTextureMultisampleMultiview(GLenum target,
+  GLenum attachment, GLuint texture, GLint level, GLsizei samples, GLint baseViewIndex,
+  GLsizei numViews) {
+  (void)target; (void)attachment; (void)texture; (void)level; (void)samples;
+  (void)baseViewIndex; (void)numViews;
+  ++gl.counters.calls;
+}
+
+static void GL_APIENTRY StubMaxShaderCompilerThreads(GLuint count) {
+  (void)count;
+  ++gl.counters.calls;
+}
+
+static bool HasExtension(const char* name) {
+  size_t length = strlen(name);
+  for(size_t pos = gl.extensions.find(name); pos != std::string::npos;
+      pos = gl.extensions.find(name, pos + 1)) {
+    char next = gl.extensions.c_str()[pos + length];
+    if(next == ' ' || next == '\0') {
+      return true;
+    }
+  }
+  return false;
+}
+
+extern "C" {
+
+__eglMustCastToProperFunctionPointerType eglGetProcAddress(const char* procname) {
+  std::string name(procname);
+  if(name == "glBufferStorageEXT" && HasExtension("GL_EXT_buffer_storage")) {
+    return (__eglMustCastToProperFunctionPointerType)glBufferStorageEXT;
+  }
+  if(name == "glFramebufferTextureMultiviewOVR" && HasExtension("GL_OVR_multiview")) {
+    return (__eglMustCastToProperFunctionPointerType)StubFramebufferTextureMultiview;
+  }
+  if(name == "glFramebufferTextureMultisampleMultiviewOVR" &&
+     HasExtension("GL_OVR_multiview_multisampled_render_to_texture")) {
+    return (__eglMustCastToProperFunctionPointerType)StubFramebufferTextureMultisampleMultiview;
+  }
+  if(name == "glMaxShaderCompilerThreadsKHR" && HasExtension("GL_KHR_parallel_shader_compile")) {
+    return (__eglMustCastToProperFunctionPointerType)StubMaxShaderCompilerThreads;
+  }
+  return NULL;
+}
+
+const GLubyte* GL_APIENTRY glGetString(GLenum name) {
+  ++gl.counters.calls;
+  switch(name) {
+    case GL_RENDERER: return (const GLubyte*)"Recording stub";
+    case GL_VERSION: return (const GLubyte*)"OpenGL ES 3.2 stub";
+    case GL_EXTENSIONS: return (const GLubyte*)gl.extensions.c_str();
+    default: return (const GLubyte*)"";
+  }
+}
+
+void GL_APIENTRY glGetIntegerv(GLenum pname, GLint* data) {
+  ++gl.counters.calls;
+  *data = (pname == GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT) ? UNIFORM_ALIGNMENT : 0;
+}
+
+void GL_APIENTRY glDebugMessageCallbackKHR(GLDEBUGPROCKHR callback, const void* userParam) {
+  (void)callback; (void)userParam;
+  ++gl.counters.calls;
+}
+
+void GL_APIENTRY glEnable(GLenum cap) { (void)cap; ++gl.counters.calls; }
+void GL_APIENTRY glDisable(GLenum cap) { (void)cap; ++gl.counters.calls; }
+void GL_APIENTRY glDepthMask(GLboolean flag) { (void)flag; ++gl.counters.calls; }
+void GL_APIENTRY glLineWidth(GLfloat width) { (void)width; ++gl.counters.calls; }
+void GL_APIENTRY glBlendFunc(GLenum sfactor, GLenum dfactor) {
+  (void)sfactor; (void)dfactor;
+  ++gl.counters.calls;
+}
+void GL_APIENTRY glClear(GLbitfield mask) { (void)mask; ++gl.counters.calls; }
+void GL_APIENTRY glClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
+  (void)red; (void)green; (void)blue; (void)alpha;
+  ++gl.counters.calls;
+}
+void GL_APIENTRY glViewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+  (void)x; (void)y; (void)width; (void)height;
+  ++gl.counters.calls;
+}
+void GL_APIENTRY glScissor(GLint x, GLint y, GLsizei width, GLsizei height) {
+  (void)x; (void)y; (void)width; (void)height;
+  ++gl.counters.calls;
+}
+
+// Shaders and programs always compile and link
+GLuint GL_APIENTRY glCreateShader(GLenum type) {
+  (void)type;
+  ++gl.counters.calls;
+  return gl.nextName++;
+}
+
+void GL_APIENTRY glShaderSource(GLuint shader, GLsizei count, const GLchar* const* string,
+  const GLint* length) {
+  ++gl.counters.calls;
+  std::string& source = gl.shaderSources[shader];
+  source.clear();
+  for(GLsizei i=0; i<count; ++i) {
+    if(length && length[i] >= 0) {
+      source.append(string[i], length[i]);
+    } else {
+      source.append(string[i]);
+    }
+  }
+}
+
+void GL_APIENTRY glCompileShader(GLuint shader) { (void)shader; ++gl.counters.calls; }
+void GL_APIENTRY glDeleteShader(GLuint shader) { (void)shader; ++gl.counters.calls; }
+
+void GL_APIENTRY glGetShaderiv(GLuint shader, GLenum pname, GLint* params) {
+  (void)shader;
+  ++gl.counters.calls;
+  *params = (pname == GL_COMPILE_STATUS) ? GL_TRUE : 0;
+}
+
+void GL_APIENTRY glGetShaderInfoLog(GLuint shader, GLsizei bufSize, GLsizei* length,
+  GLchar* infoLog) {
+  (void)shader;
+  ++gl.counters.calls;
+  if(length) {
+    *length = 0;
+  }
+  if(bufSize > 0) {
+    infoLog[0] = '\0';
+  }
+}
+
+GLuint GL_APIENTRY glCreateProgram() {
+  ++gl.counters.calls;
+  return gl.nextName++;
+}
+
+// The first shader attached is the vertex shader, as in the renderer
+void GL_APIENTRY glAttachShader(GLuint program, GLuint shader) {
+  ++gl.counters.calls;
+  gl.vertexShaders.insert(std::make_pair(program, shader));
+}
+
+void GL_APIENTRY glBindAttribLocation(GLuint program, GLuint index, const GLchar* name) {
+  (void)program; (void)index; (void)name;
+  ++gl.counters.calls;
+}
+
+void GL_APIENTRY glProgramParameteri(GLuint program, GLenum pname, GLint value) {
+  (void)program; (void)pname; (void)value;
+  ++gl.counters.calls;
+}
+
+void GL_APIENTRY glLinkProgram(GLuint program) { (void)program; ++gl.counters.calls; }
+void GL_APIENTRY glDeleteProgram(GLuint program) { (void)program; ++gl.counters.calls; }
+void GL_APIENTRY glUseProgram(GLuint program) { gl.program = program; ++gl.counters.calls; }
+
+void GL_APIENTRY glGetProgramiv(GLuint program, GLenum pname, GLint* params) {
+  (void)program;
+  ++gl.counters.calls;
+  *params = (pname == GL_LINK_STATUS || pname == GL_COMPLETION_STATUS_KHR) ? GL_TRUE : 0;
+}
+
+void GL_APIENTRY glGetProgramInfoLog(GLuint program, GLsizei bufSize, GLsizei* length,
+  GLchar* infoLog) {
+  (void)program;
+  ++gl.counters.calls;
+  if(length) {
+    *length = 0;
+  }
+  if(bufSize > 0) {
+    infoLog[0] = '\0';
+  }
+}
+
+// No binaries are produced, so the program cache is never used
+void GL_APIENTRY glGetProgramBinary(GLuint program, GLsizei bufSize, GLsizei* length,
+  GLenum* binaryFormat, void* binary) {
+  (void)program; (void)bufSize; (void)binaryFormat; (void)binary;
+  ++gl.counters.calls;
+  if(length) {
+    *length = 0;
+  }
+}
+
+void GL_APIENTRY glProgramBinary(GLuint program, GLenum binaryFormat, const void* binary,
+  GLsizei length) {
+  (void)program; (void)binaryFormat; (void)binary; (void)length;
+  ++gl.counters.calls;
+}
+
+GLuint GL_APIENTRY glGetUniformBlockIndex(GLuint program, const GLchar* uniformBlockName) {
+  (void)program; (void)uniformBlockName;
+  ++gl.counters.calls;
+  return 0;
+}
+
+void GL_APIENTRY glUniformBlockBinding(GLuint program, GLuint uniformBlockIndex,
+  GLuint uniformBlockBinding) {
+  (void)program; (void)uniformBlockIndex; (void)uniformBlockBinding;
+  ++gl.counters.calls;
+}
+
+GLint GL_APIENTRY glGetUniformLocation(GLuint program, const GLchar* name) {
+  (void)program; (void)name;
+  ++gl.counters.calls;
+  return 0;
+}
+
+void GL_APIENTRY glUniform1i(GLint location, GLint v0) {
+  (void)location; (void)v0;
+  ++gl.counters.calls;
+}
+
+// Buffers keep their contents so mapped pointers are real memory
+void GL_APIENTRY glGenBuffers(GLsizei n, GLuint* buffers) {
+  GenNames(n, buffers);
+}
+
+void GL_APIENTRY glDeleteBuffers(GLsizei n, const GLuint* buffers) {
+  ++gl.counters.calls;
+  for(GLsizei i=0; i<n; ++i) {
+    gl.buffers.erase(buffers[i]);
+  }
+}
+
+void GL_APIENTRY glBindBuffer(GLenum target, GLuint buffer) {
+  ++gl.counters.calls;
+  GLuint* binding = Binding(target);
+  if(binding) {
+    *binding = buffer;
+  }
+}
+
+void GL_APIENTRY glBindBufferBase(GLenum target, GLuint index, GLuint buffer) {
+  (void)target; (void)index; (void)buffer;
+  ++gl.counters.calls;
+}
+
+void GL_APIENTRY glBindBufferRange(GLenum target, GLuint index, GLuint buffer,
+  GLintptr offset, GLsizeiptr size) {
+  ++gl.counters.calls;
+  if(target == GL_UNIFORM_BUFFER && index == 0) {
+    gl.uniformBinding = buffer;
+    gl.uniformOffset = offset;
+    gl.uniformSize = size;
+    gl.counters.uploadBytes += size;
+  }
+}
+
+void GL_APIENTRY glBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) {
+  (void)usage;
+  ++gl.counters.calls;
+  std::vector<uint8_t>* buffer = Bound(target);
+  if(buffer) {
+    buffer->assign(size, 0);
+    if(data) {
+      memcpy(buffer->data(), data, size);
+      gl.counters.uploadBytes += size;
+    }
+  }
+}
+
+void GL_APIENTRY glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size,
+  const void* data) {
+  ++gl.counters.calls;
+  std::vector<uint8_t>* buffer = Bound(target);
+  if(buffer && offset + size <= (GLintptr)buffer->size()) {
+    memcpy(buffer->data() + offset, data, size);
+    gl.counters.uploadBytes += size;
+  }
+}
+
+void GL_APIENTRY glBufferStorageEXT(GLenum target, GLsizeiptr size, const void* data,
+  GLbitfield flags) {
+  glBufferData(target, size, data, flags);
+}
+
+void GL_APIENTRY glCopyBufferSubData(GLenum readTarget, GLenum writeTarget,
+  GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size) {
+  ++gl.counters.calls;
+  gl.counters.uploadBytes += size;
+  std::vector<uint8_t>* source = Bound(readTarget);
+  std::vector<uint8_t>* dest = Bound(writeTarget);
+  if(source && dest && readOffset + size <= (GLintptr)source->size() &&
+     writeOffset + size <= (GLintptr)dest->size()) {
+    memmove(dest->data() + writeOffset, source->data() + readOffset, size);
+  }
+}
+
+void* GL_APIENTRY glMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length,
+  GLbitfield access) {
+  (void)length; (void)access;
+  ++gl.counters.calls;
+  ++gl.counters.maps;
+  std::vector<uint8_t>* buffer = Bound(target);
+  return buffer ? buffer->data() + offset : NULL;
+}
+
+GLboolean GL_APIENTRY glUnmapBuffer(GLenum target) {
+  (void)target;
+  ++gl.counters.calls;
+  ++gl.counters.unmaps;
+  return GL_TRUE;
+}
+
+GLsync GL_APIENTRY glFenceSync(GLenum condition, GLbitfield flags) {
+  (void)condition; (void)flags;
+  ++gl.counters.calls;
+  return (GLsync)(uintptr_t)gl.nextName++;
+}
+
+GLenum GL_APIENTRY glClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout) {
+  (void)sync; (void)flags; (void)timeout;
+  ++gl.counters.calls;
+  return GL_ALREADY_SIGNALED;
+}
+
+void GL_APIENTRY glDeleteSync(GLsync sync) { (void)sync; ++gl.counters.calls; }
+
+void GL_APIENTRY glGenVertexArrays(GLsizei n, GLuint* arrays) {
+  GenNames(n, arrays);
+  for(GLsizei i=0; i<n; ++i) {
+    gl.vertexArrays[arrays[i]] = VertexArray();
+  }
+}
+
+void GL_APIENTRY glDeleteVertexArrays(GLsizei n, const GLuint* arrays) {
+  ++gl.counters.calls;
+  for(GLsizei i=0; i<n; ++i) {
+    gl.vertexArrays.erase(arrays[i]);
+  }
+}
+
+void GL_APIENTRY glBindVertexArray(GLuint array) { gl.vao = array; ++gl.counters.calls; }
+
+void GL_APIENTRY glEnableVertexAttribArray(GLuint index) {
+  ++gl.counters.calls;
+  gl.vertexArrays[gl.vao].enabled |= 1u << index;
+}
+
+void GL_APIENTRY glVertexAttribPointer(GLuint index, GLint size, GLenum type,
+  GLboolean normalized, GLsizei stride, const void* pointer) {
+  (void)size; (void)type; (void)normalized; (void)stride;
+  SetAttribPointer(index, pointer);
+}
+
+void GL_APIENTRY glVertexAttribIPointer(GLuint index, GLint size, GLenum type, GLsizei stride,
+  const void* pointer) {
+  (void)size; (void)type; (void)stride;
+  SetAttribPointer(index, pointer);
+}
+
+void GL_APIENTRY glVertexAttribDivisor(GLuint index, GLuint divisor) {
+  (void)index; (void)divisor;
+  ++gl.counters.calls;
+}
+
+void GL_APIENTRY glDrawArrays(GLenum mode, GLint first, GLsizei count) {
+  Draw(mode, first, count, 1);
+}
+
+void GL_APIENTRY glDrawArraysInstanced(GLenum mode, GLint first, GLsizei count,
+  GLsizei instancecount) {
+  Draw(mode, first, count, instancecount);
+}
+
+void GL_APIENTRY glGenTextures(GLsizei n, GLuint* textures) {
+  GenNames(n, textures);
+}
+
+void GL_APIENTRY glDeleteTextures(GLsizei n, const GLuint* textures) {
+  (void)n; (void)textures;
+  ++gl.counters.calls;
+}
+
+void GL_APIENTRY glActiveTexture(GLenum texture) { (void)texture; ++gl.counters.calls; }
+
+void GL_APIENTRY glBindTexture(GLenum target, GLuint texture) {
+  (void)target; (void)texture;
+  ++gl.counters.calls;
+}
+
+// Only the single-channel byte textures the renderer uploads are sized
+void GL_APIENTRY glTexImage2D(GLenum target, GLint level, GLint internalformat,
+  GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type,
+  const void* pixels) {
+  (void)target; (void)level; (void)internalformat; (void)border; (void)format; (void)type;
+  ++gl.counters.calls;
+  if(pixels) {
+    gl.counters.uploadBytes += (uint64_t)width*height;
+  }
+}
+
+void GL_APIENTRY glTexStorage3D(GLenum target, GLsizei levels, GLenum internalformat,
+  GLsizei width, GLsizei height, GLsizei depth) {
+  (void)target; (void)levels; (void)internalformat; (void)width; (void)height; (void)depth;
+  ++gl.counters.calls;
+}
+
+void GL_APIENTRY glTexParameteri(GLenum target, GLenum pname, GLint param) {
+  (void)target; (void)pname; (void)param;
+  ++gl.counters.calls;
+}
+
+void GL_APIENTRY glGenFramebuffers(GLsizei n, GLuint* framebuffers) {
+  GenNames(n, framebuffers);
+}
+
+void GL_APIENTRY glDeleteFramebuffers(GLsizei n, const GLuint* framebuffers) {
+  (void)n; (void)framebuffers;
+  ++gl.counters.calls;
+}
+
+void GL_APIENTRY glBindFramebuffer(GLenum target, GLuint framebuffer) {
+  (void)target; (void)framebuffer;
+  ++gl.counters.calls;
+}
+
+GLenum GL_APIENTRY glCheckFramebufferStatus(GLenum target) {
+  (void)target;
+  ++gl.counters.calls;
+  return GL_FRAMEBUFFER_COMPLETE;
+}
+
+void GL_APIENTRY glFramebufferTextureLayer(GLenum target, GLenum attachment, GLuint texture,
+  GLint level, GLint layer) {
+  (void)target; (void)attachment; (void)texture; (void)level; (void)layer;
+  ++gl.counters.calls;
+}
+
+void GL_APIENTRY glBlitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1,
+  GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter) {
+  (void)srcX0; (void)srcY0; (void)srcX1; (void)srcY1;
+  (void)dstX0; (void)dstY0; (void)dstX1; (void)dstY1; (void)mask; (void)filter;
+  ++gl.counters.calls;
+}
+
+// Timer queries are never reported as supported, but are still linked
+void GL_APIENTRY glGenQueries(GLsizei n, GLuint* ids) {
+  GenNames(n, ids);
+}
+
+void GL_APIENTRY glDeleteQueries(GLsizei n, const GLuint* ids) {
+  (void)n; (void)ids;
+  ++gl.counters.calls;
+}
+
+void GL_APIENTRY glBeginQuery(GLenum target, GLuint id) {
+  (void)target; (void)id;
+  ++gl.counters.calls;
+}
+
+void GL_APIENTRY glEndQuery(GLenum target) { (void)target; ++gl.counters.calls; }
+
+void GL_APIENTRY glGetQueryObjectuiv(GLuint id, GLenum pname, GLuint* params) {
+  (void)id; (void)pname;
+  ++gl.counters.calls;
+  *params = 0;
+}
+
+}  // extern "C"
@@ -0,0 +1,56 @@
+#ifndef RECORDING_GL_H_
+#define RECORDING_GL_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <EGL/egl.h>
+#include <GLES3/gl3.h>
+#include <GLES2/gl2ext.h>
+
+// GLES 3 entry points for headless builds. Nothing is drawn: the stub
+// keeps buffer contents and the state the renderer's draws depend on, and
+// counts what a frame costs. Compiles and links always succeed.
+#define STUB_MAX_ATTRIBS 16
+
+typedef struct {
+  uint64_t calls;             // Every GL entry point
+  uint64_t draws, instances;
+  uint64_t uploadBytes;       // Data handed to buffers and textures, plus
+                              // buffer copies and bound uniform ranges
+  uint64_t maps, unmaps;
+} GlCounters;
+
+// State at a draw call
+typedef struct {
+  GLenum mode;
+  GLint first;
+  GLsizei count, instances;
+  GLuint program, vao;
+  GLuint uniformBuffer;
+  GLintptr uniformOffset;
+  GLsizeiptr uniformSize;
+  uint32_t enabledAttribs;
+  GLuint attribBuffers[STUB_MAX_ATTRIBS];
+  GLintptr attribOffsets[STUB_MAX_ATTRIBS];
+} GlDraw;
+
+// Start from an empty context reporting these extensions, along with the
+// persistent mapping extension unless bufferStorage is false
+void ResetStubGl(const char* extensions, bool bufferStorage = true);
+
+const GlCounters& GetGlCounters();
+void ResetGlCounters();
+
+// Keep a log of draw calls until the next reset, off by default
+void RecordGlDraws(bool record);
+const std::vector<GlDraw>& GetGlDraws();
+
+// Contents of a buffer object, NULL if there is none by that name
+const std::vector<uint8_t>* GetGlBuffer(GLuint buffer);
+
+// Source of the vertex shader attached to a program
+const std::string* GetGlVertexSource(GLuint program);
+
+#endif  // RECORDING_GL_H_
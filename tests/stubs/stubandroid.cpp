@@ -0,0 +1,81 @@
+#include "stubandroid.h"
+
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+#include <string>
+
+#include <android/log.h>
+
+#include "assetbuffer.h"
+
+struct AAssetManager {
+  std::string dir;
+};
+
+struct AAsset {
+  AssetBuffer buffer;
+};
+
+static std::atomic<unsigned int> logErrors(0);
+
+AAssetManager* CreateStubAssetManager(const char* dir) {
+  AAssetManager* mgr = new AAssetManager;
+  mgr->dir = dir;
+  return mgr;
+}
+
+void DestroyStubAssetManager(AAssetManager* mgr) {
+  delete mgr;
+}
+
+unsigned int StubLogErrors() {
+  return logErrors;
+}
+
+extern "C" {
+
+AAsset* AAssetManager_open(AAssetManager* mgr, const char* filename, int mode) {
+  (void)mode;
+  AAsset* asset = new AAsset;
+  if(!asset->buffer.Open((mgr->dir + "/" + filename).c_str())) {
+    delete asset;
+    return NULL;
+  }
+  return asset;
+}
+
+const void* AAsset_getBuffer(AAsset* asset) {
+  return asset->buffer.Data();
+}
+
+off64_t AAsset_getLength64(AAsset* asset) {
+  return (off64_t)asset->buffer.Size();
+}
+
+void AAsset_close(AAsset* asset) {
+  delete asset;
+}
+
+// Only warnings and errors are printed, so benchmarks stay readable
+int __android_log_write(int prio, const char* tag, const char* text) {
+  if(prio < ANDROID_LOG_WARN) {
+    return 0;
+  }
+  ++logErrors;
+  return fprintf(stderr, "%s: %s\n", tag, text);
+}
+
+int __android_log_print(int prio, const char* tag, const char* fmt, ...) {
+  if(prio < ANDROID_LOG_WARN) {
+    return 0;
+  }
+  char text[1024];
+  va_list args;
+  va_start(args, fmt);
+  vsnprintf(text, sizeof(text), fmt, args);
+  va_end(args);
+  return __android_log_write(prio, tag, text);
+}
+
+}  // extern "C"
@@ -0,0 +1,14 @@
+#ifndef STUB_ANDROID_H_
+#define STUB_ANDROID_H_
+
+#include <android/asset_manager.h>
+
+// Asset manager serving the files in a directory, such as the app's
+// assets directory. Assets are mapped whole, like uncompressed APK entries.
+AAssetManager* CreateStubAssetManager(const char* dir);
+void DestroyStubAssetManager(AAssetManager* mgr);
+
+// Number of warnings and errors logged since the process started
+unsigned int StubLogErrors();
+
+#endif  // STUB_ANDROID_H_
@@ -0,0 +1,270 @@
+#include "stubgvr.h"
+
+#include <chrono>
+#include <cmath>
+
+// Opaque GVR types. Viewports and lists carry what the renderer reads back.
+struct gvr_context_ {};
+struct gvr_buffer_spec_ {};
+struct gvr_swap_chain_ {};
+struct gvr_frame_ {};
+struct gvr_controller_context_ {};
+struct gvr_controller_state_ {
+  gvr_quatf orientation;
+  bool connected;
+};
+struct gvr_buffer_viewport_ {
+  gvr_rectf fov, uv;
+};
+struct gvr_buffer_viewport_list_ {
+  gvr_buffer_viewport_ items[2];
+};
+
+static StubHeadset headset;
+static gvr_context_ context;
+static gvr_frame_ frame;
+
+static gvr_mat4f Identity() {
+  gvr_mat4f m = {};
+  for(int i=0; i<4; ++i) {
+    m.m[i][i] = 1.0f;
+  }
+  return m;
+}
+
+gvr_context* CreateStubGvr() {
+
+  // Pixel 2 sized target, eyes 64 mm apart, fields of view wider towards
+  // the nose as on a real lens
+  headset.maxRenderSize.width = 2880;
+  headset.maxRenderSize.height = 1440;
+  headset.headRotation = Identity();
+  for(int eye=0; eye<2; ++eye) {
+    headset.eyeFromHead[eye] = Identity();
+    headset.eyeFromHead[eye].m[0][3] = (eye == GVR_LEFT_EYE) ? 0.032f : -0.032f;
+  }
+  headset.fov[GVR_LEFT_EYE] = gvr_rectf{50.0f, 40.0f, 45.0f, 45.0f};
+  headset.fov[GVR_RIGHT_EYE] = gvr_rectf{40.0f, 50.0f, 45.0f, 45.0f};
+  headset.uv[GVR_LEFT_EYE] = gvr_rectf{0.0f, 0.5f, 0.0f, 1.0f};
+  headset.uv[GVR_RIGHT_EYE] = gvr_rectf{0.5f, 1.0f, 0.0f, 1.0f};
+  headset.controllerOrientation = gvr_quatf{0.0f, 0.0f, 0.0f, 1.0f};
+  headset.controllerConnected = true;
+  headset.framesSubmitted = 0;
+  return &context;
+}
+
+void DestroyStubGvr(gvr_context* gvr) {
+  (void)gvr;
+}
+
+StubHeadset& GetStubHeadset() {
+  return headset;
+}
+
+void AimStubController(float x, float y, float z) {
+
+  // Shortest rotation taking the forward axis, -z, onto the direction
+  float length = std::sqrt(x*x + y*y + z*z);
+  gvr_quatf q = {y/length, -x/length, 0.0f, 1.0f - z/length};
+  float norm = std::sqrt(q.qx*q.qx + q.qy*q.qy + q.qw*q.qw);
+  headset.controllerOrientation = gvr_quatf{q.qx/norm, q.qy/norm, 0.0f, q.qw/norm};
+}
+
+extern "C" {
+
+void gvr_destroy(gvr_context** gvr) {
+  *gvr = NULL;
+}
+
+void gvr_initialize_gl(gvr_context* gvr) {
+  (void)gvr;
+}
+
+void gvr_pause_tracking(gvr_context* gvr) {
+  (void)gvr;
+}
+
+void gvr_resume_tracking(gvr_context* gvr) {
+  (void)gvr;
+}
+
+gvr_clock_time_point gvr_get_time_point_now() {
+  gvr_clock_time_point time;
+  time.monotonic_system_time_nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+  return time;
+}
+
+gvr_sizei gvr_get_maximum_effective_render_target_size(const gvr_context* gvr) {
+  (void)gvr;
+  return headset.maxRenderSize;
+}
+
+gvr_mat4f gvr_get_head_space_from_start_space_rotation(const gvr_context* gvr,
+  const gvr_clock_time_point time) {
+  (void)gvr; (void)time;
+  return headset.headRotation;
+}
+
+gvr_mat4f gvr_apply_neck_model(const gvr_context* gvr, gvr_mat4f head_space_from_start_space_rotation,
+  float factor) {
+  (void)gvr; (void)factor;
+  return head_space_from_start_space_rotation;
+}
+
+gvr_mat4f gvr_get_eye_from_head_matrix(const gvr_context* gvr, const int32_t eye) {
+  (void)gvr;
+  return headset.eyeFromHead[eye];
+}
+
+gvr_buffer_spec* gvr_buffer_spec_create(gvr_context* gvr) {
+  (void)gvr;
+  return new gvr_buffer_spec_;
+}
+
+void gvr_buffer_spec_destroy(gvr_buffer_spec** spec) {
+  delete *spec;
+  *spec = NULL;
+}
+
+void gvr_buffer_spec_set_size(gvr_buffer_spec* spec, gvr_sizei size) {
+  (void)spec; (void)size;
+}
+
+void gvr_buffer_spec_set_samples(gvr_buffer_spec* spec, int32_t num_samples) {
+  (void)spec; (void)num_samples;
+}
+
+void gvr_buffer_spec_set_color_format(gvr_buffer_spec* spec, int32_t color_format) {
+  (void)spec; (void)color_format;
+}
+
+void gvr_buffer_spec_set_depth_stencil_format(gvr_buffer_spec* spec,
+  int32_t depth_stencil_format) {
+  (void)spec; (void)depth_stencil_format;
+}
+
+gvr_swap_chain* gvr_swap_chain_create(gvr_context* gvr, const gvr_buffer_spec** buffers,
+  int32_t count) {
+  (void)gvr; (void)buffers; (void)count;
+  return new gvr_swap_chain_;
+}
+
+void gvr_swap_chain_destroy(gvr_swap_chain** swap_chain) {
+  delete *swap_chain;
+  *swap_chain = NULL;
+}
+
+void gvr_swap_chain_resize_buffer(gvr_swap_chain* swap_chain, int32_t index, gvr_sizei size) {
+  (void)swap_chain; (void)index; (void)size;
+}
+
+gvr_frame* gvr_swap_chain_acquire_frame(gvr_swap_chain* swap_chain) {
+  (void)swap_chain;
+  return &frame;
+}
+
+void gvr_frame_bind_buffer(gvr_frame* frame, int32_t index) {
+  (void)frame; (void)index;
+}
+
+void gvr_frame_unbind(gvr_frame* frame) {
+  (void)frame;
+}
+
+void gvr_frame_submit(gvr_frame** frame, const gvr_buffer_viewport_list* list,
+  gvr_mat4f head_space_from_start_space) {
+  (void)list; (void)head_space_from_start_space;
+  *frame = NULL;
+  ++headset.framesSubmitted;
+}
+
+gvr_buffer_viewport* gvr_buffer_viewport_create(gvr_context* gvr) {
+  (void)gvr;
+  return new gvr_buffer_viewport_();
+}
+
+void gvr_buffer_viewport_destroy(gvr_buffer_viewport** viewport) {
+  delete *viewport;
+  *viewport = NULL;
+}
+
+gvr_rectf gvr_buffer_viewport_get_source_fov(const gvr_buffer_viewport* viewport) {
+  return viewport->fov;
+}
+
+gvr_rectf gvr_buffer_viewport_get_source_uv(const gvr_buffer_viewport* viewport) {
+  return viewport->uv;
+}
+
+gvr_buffer_viewport_list* gvr_buffer_viewport_list_create(const gvr_context* gvr) {
+  (void)gvr;
+  return new gvr_buffer_viewport_list_();
+}
+
+void gvr_buffer_viewport_list_destroy(gvr_buffer_viewport_list** viewport_list) {
+  delete *viewport_list;
+  *viewport_list = NULL;
+}
+
+void gvr_get_recommended_buffer_viewports(const gvr_context* gvr,
+  gvr_buffer_viewport_list* viewport_list) {
+  (void)gvr;
+  for(int eye=0; eye<2; ++eye) {
+    viewport_list->items[eye].fov = headset.fov[eye];
+    viewport_list->items[eye].uv = headset.uv[eye];
+  }
+}
+
+void gvr_buffer_viewport_list_get_item(const gvr_buffer_viewport_list* viewport_list,
+  size_t index, gvr_buffer_viewport* viewport) {
+  *viewport = viewport_list->items[index];
+}
+
+gvr_controller_context* gvr_controller_create_and_init(int32_t options, gvr_context* context) {
+  (void)options; (void)context;
+  return new gvr_controller_context_;
+}
+
+void gvr_controller_destroy(gvr_controller_context** api) {
+  delete *api;
+  *api = NULL;
+}
+
+void gvr_controller_resume(gvr_controller_context* api) {
+  (void)api;
+}
+
+gvr_controller_state* gvr_controller_state_create() {
+  gvr_controller_state* state = new gvr_controller_state_;
+  state->orientation = gvr_quatf{0.0f, 0.0f, 0.0f, 1.0f};
+  state->connected = false;
+  return state;
+}
+
+void gvr_controller_state_destroy(gvr_controller_state** state) {
+  delete *state;
+  *state = NULL;
+}
+
+void gvr_controller_state_update(gvr_controller_context* api, int32_t flags,
+  gvr_controller_state* out_state) {
+  (void)api; (void)flags;
+  out_state->orientation = headset.controllerOrientation;
+  out_state->connected = headset.controllerConnected;
+}
+
+int32_t gvr_controller_state_get_connection_state(const gvr_controller_state* state) {
+  return state->connected ? GVR_CONTROLLER_CONNECTED : GVR_CONTROLLER_DISCONNECTED;
+}
+
+gvr_quatf gvr_controller_state_get_orientation(const gvr_controller_state* state) {
+  return state->orientation;
+}
+
+bool gvr_controller_state_get_recentered(const gvr_controller_state* state) {
+  (void)state;
+  return false;
+}
+
+}  // extern "C"
@@ -0,0 +1,32 @@
+#ifndef STUB_GVR_H_
+#define STUB_GVR_H_
+
+#include "vr/gvr/capi/include/gvr.h"
+#include "vr/gvr/capi/include/gvr_controller.h"
+
+// The headset and controller the GVR stub reports. There is one of each,
+// shared by every context, since the controller API is created without
+// one. Eyes split the render target side by side like a phone viewer.
+typedef struct {
+  gvr_sizei maxRenderSize;
+  gvr_mat4f headRotation;
+  gvr_mat4f eyeFromHead[2];
+  gvr_rectf fov[2];
+  gvr_rectf uv[2];
+  gvr_quatf controllerOrientation;
+  bool controllerConnected;
+  unsigned int framesSubmitted;
+} StubHeadset;
+
+// Context to hand the renderer. Creating one resets the headset to a
+// level head, a connected controller pointing straight ahead and
+// asymmetric per-eye fields of view.
+gvr_context* CreateStubGvr();
+void DestroyStubGvr(gvr_context* gvr);
+
+StubHeadset& GetStubHeadset();
+
+// Point the controller from the origin towards a point
+void AimStubController(float x, float y, float z);
+
+#endif  // STUB_GVR_H_
@@ -0,0 +1,51 @@
+#include "testnetwork.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include <arpa/inet.h>
+#include <sched.h>
+
+static std::string AddressString(uint32_t address) {
+  struct in_addr addr;
+  addr.s_addr = htonl(address);
+  char text[INET_ADDRSTRLEN];
+  inet_ntop(AF_INET, &addr, text, sizeof(text));
+  return text;
+}
+
+bool TestNetwork::Create(uint32_t address, int prefixLength) {
+  if(unshare(CLONE_NEWNET) != 0) {
+    return false;
+  }
+
+  // The far end of the pair has no address, so nobody answers there
+  std::string command = "ip link set lo up && "
+    "ip link add wdtest0 type veth peer name wdtest1 && "
+    "ip link set wdtest1 up && "
+    "ip addr add " + AddressString(address) + "/" + std::to_string(prefixLength) +
+    " dev wdtest0 && ip link set wdtest0 up";
+  return system(command.c_str()) == 0;
+}
+
+bool TestNetwork::AddHosts(const std::vector<uint32_t>& addresses) {
+  return Batch("add", addresses);
+}
+
+bool TestNetwork::RemoveHosts(const std::vector<uint32_t>& addresses) {
+  return Batch("del", addresses);
+}
+
+bool TestNetwork::Batch(const char* command, const std::vector<uint32_t>& addresses) {
+
+  // Hosts are added in one ip process, since a /16 may need thousands
+  FILE* ip = popen("ip -batch -", "w");
+  if(ip == NULL) {
+    return false;
+  }
+  for(uint32_t address : addresses) {
+    fprintf(ip, "addr %s %s/32 dev lo\n", command, AddressString(address).c_str());
+  }
+  return pclose(ip) == 0;
+}
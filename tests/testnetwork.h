@@ -0,0 +1,27 @@
+#ifndef TEST_NETWORK_H_
+#define TEST_NETWORK_H_
+
+#include <cstdint>
+#include <vector>
+
+// A private network for scanner tests: a fresh network namespace holding a
+// veth pair with the test subnet on one end. Hosts added are local
+// addresses, which answer probes at once. Nothing answers for the rest of
+// the subnet, so their probes time out as for a missing host. The
+// namespace belongs to the calling thread and the threads it starts after.
+// Creating one needs root. Addresses are in host byte order.
+class TestNetwork {
+
+  public:
+    // Enter a new namespace with the device at this address on the subnet,
+    // false if it can't be created
+    static bool Create(uint32_t address, int prefixLength);
+
+    static bool AddHosts(const std::vector<uint32_t>& addresses);
+    static bool RemoveHosts(const std::vector<uint32_t>& addresses);
+
+  private:
+    static bool Batch(const char* command, const std::vector<uint32_t>& addresses);
+};
+
+#endif  // TEST_NETWORK_H_
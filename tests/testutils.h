@@ -0,0 +1,94 @@
+#ifndef TEST_UTILS_H_
+#define TEST_UTILS_H_
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// Minimal runner for the host tests. Cases are defined with TEST_CASE and
+// run in order by TEST_MAIN, optionally only those whose names contain the
+// first argument. A failed check reports itself and fails its case without
+// stopping it. The exit status is 0 if nothing failed, or 77, which ctest
+// reports as skipped, if every case skipped itself.
+typedef struct {
+  const char* name;
+  void (*func)();
+} TestCase;
+
+class TestUtils {
+
+  public:
+    static std::vector<TestCase>& Cases() {
+      static std::vector<TestCase> cases;
+      return cases;
+    }
+
+    static void Fail(const char* file, int line, const char* check) {
+      fprintf(stderr, "%s:%d: check failed: %s\n", file, line, check);
+      Status() = FAILED;
+    }
+
+    static void Skip(const char* reason) {
+      printf("  skipped: %s\n", reason);
+      Status() = SKIPPED;
+    }
+
+    static int Run(int argc, char** argv) {
+      unsigned int run = 0, failed = 0, skipped = 0;
+      for(const TestCase& test : Cases()) {
+        if(argc > 1 && !strstr(test.name, argv[1])) {
+          continue;
+        }
+        printf("[ RUN  ] %s\n", test.name);
+        fflush(stdout);
+        Status() = PASSED;
+        test.func();
+        ++run;
+        failed += (Status() == FAILED);
+        skipped += (Status() == SKIPPED);
+        printf("[ %s ] %s\n", (Status() == FAILED) ? "FAIL" : (Status() == SKIPPED) ?
+          "SKIP" : " OK ", test.name);
+      }
+      printf("%u run, %u failed, %u skipped\n", run, failed, skipped);
+      if(failed > 0) {
+        return 1;
+      }
+      return (run > 0 && skipped == run) ? 77 : 0;
+    }
+
+  private:
+    enum TestStatus { PASSED, FAILED, SKIPPED };
+    static TestStatus& Status() {
+      static TestStatus status = PASSED;
+      return status;
+    }
+};
+
+struct TestRegistrar {
+  TestRegistrar(const char* name, void (*func)()) {
+    TestUtils::Cases().push_back(TestCase{name, func});
+  }
+};
+
+#define TEST_CASE(name) \
+  static void name(); \
+  static TestRegistrar name##Registrar(#name, name); \
+  static void name()
+
+#define TEST_MAIN() \
+  int main(int argc, char** argv) { return TestUtils::Run(argc, argv); }
+
+#define CHECK(cond) \
+  do { if(!(cond)) { TestUtils::Fail(__FILE__, __LINE__, #cond); } } while(0)
+
+#define CHECK_NEAR(a, b, tolerance) CHECK(std::fabs((a) - (b)) <= (tolerance))
+
+// Check, and end the case if the check failed
+#define REQUIRE(cond) \
+  do { if(!(cond)) { TestUtils::Fail(__FILE__, __LINE__, #cond); return; } } while(0)
+
+#define SKIP_TEST(reason) \
+  do { TestUtils::Skip(reason); return; } while(0)
+
+#endif  // TEST_UTILS_H_
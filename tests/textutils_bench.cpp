@@ -0,0 +1,192 @@
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "textutils.h"
+
+// Laying out host labels of ten glyphs, as the renderer does for each
+// scanned host. textutils_scalar_bench runs the scalar writer for
+// comparison.
+static void BM_GenerateInstances(benchmark::State& state) {
+  std::vector<std::string> labels(state.range(0));
+  std::vector<TextRun> runs(labels.size());
+  for(size_t i=0; i<labels.size(); ++i) {
+    char label[16];
+    snprintf(label, sizeof(label), "host%05u.", (unsigned int)i);
+    labels[i] = label;
+    runs[i].text = &labels[i];
+    runs[i].x = -0.5f;
+    runs[i].y = 0.1f*i;
+  }
+  const TextureAtlas& atlas = TextUtils::GetAtlas();
+  std::vector<GLfloat> instances;
+  for(auto _ : state) {
+    instances.clear();
+    TextUtils::GenerateInstances(runs.data(), runs.size(), instances, 0.3f/24, atlas);
+    benchmark::DoNotOptimize(instances.data());
+  }
+  state.SetItemsProcessed(state.iterations()*labels.size()*10);
+  state.SetBytesProcessed(state.iterations()*instances.size()*sizeof(GLfloat));
+}
+
+// Host names and addresses of a scan, as the renderer labels them
+static std::vector<std::string> MakeLabels(unsigned int count) {
+  std::vector<std::string> labels;
+  char label[32];
+  for(unsigned int i=0; i<count; ++i) {
+    snprintf(label, sizeof(label), "host%05u.lan", i);
+    labels.push_back(label);
+    snprintf(label, sizeof(label), "10.%u.%u.%u", i >> 16, (i >> 8) & 0xFF, i & 0xFF);
+    labels.push_back(label);
+  }
+  return labels;
+}
+
+// The label path of each host: measure the text, then lay out a quad per
+// glyph, looking glyphs up through lookup
+template<typename Lookup>
+static void LayoutLabels(benchmark::State& state, Lookup lookup) {
+  std::vector<std::string> labels = MakeLabels(state.range(0));
+  const TextureAtlas& atlas = TextUtils::GetAtlas();
+  const float scale = 0.3f/24;
+  std::vector<GLfloat> instances;
+  size_t numChars = 0;
+  for(auto _ : state) {
+    instances.clear();
+    numChars = 0;
+    for(const std::string& label : labels) {
+      float width = 0.0f;
+      for(size_t i=0; i<label.length(); ++i) {
+        width += lookup((unsigned char)label[i]).xAdvance * scale;
+      }
+      float x = -width/2, y = 0.0f;
+      for(size_t i=0; i<label.length(); ++i) {
+        const TextureChar& ch = lookup((unsigned char)label[i]);
+        float left = x + ch.xOffset*scale, top = y - ch.yOffset*scale;
+        const GLfloat quad[8] = {
+          left, top - ch.height*scale*atlas.textureHeight, ch.x, ch.y - ch.height,
+          left + ch.width*scale*atlas.textureWidth, top, ch.x + ch.width, ch.y};
+        instances.insert(instances.end(), quad, quad + 8);
+        x += ch.xAdvance * scale;
+      }
+      numChars += label.length();
+    }
+    benchmark::DoNotOptimize(instances.data());
+  }
+  state.SetItemsProcessed(state.iterations()*numChars);
+}
+
+// Glyphs looked up in a std::map of the font's characters, as the atlas
+// kept them before the flat table
+static void BM_LabelsMapLookup(benchmark::State& state) {
+  const TextureAtlas& atlas = TextUtils::GetAtlas();
+  std::map<unsigned int, TextureChar> charMap;
+  for(unsigned int code=0; code<NUM_DIRECT_GLYPHS; ++code) {
+    if(code == '?' || memcmp(&atlas.glyphs[code], atlas.missingGlyph, sizeof(TextureChar)) != 0) {
+      charMap.emplace(code, atlas.glyphs[code]);
+    }
+  }
+  LayoutLabels(state, [&](unsigned int code) -> const TextureChar& { return charMap[code]; });
+}
+
+static void BM_LabelsTableLookup(benchmark::State& state) {
+  const TextureAtlas& atlas = TextUtils::GetAtlas();
+  LayoutLabels(state, [&](unsigned int code) -> const TextureChar& {
+    return TextUtils::Glyph(atlas, code);
+  });
+}
+
+// Label data the renderer keeps and uploads for hosts with display names
+// of nine characters. Before instancing each character was a strip of four
+// (x, y, s, t) vertices and five primitive-restart indices; now each host
+// has MAX_LABEL_CHARS glyph records like WiFiDiscoveryRenderer::LabelGlyph.
+static const unsigned int MAX_LABEL_CHARS = 10;
+
+typedef struct {
+  GLfloat pen[2];
+  GLuint glyph;
+} LabelGlyph;
+
+static std::vector<std::string> MakeDisplayNames(unsigned int count) {
+  std::vector<std::string> names;
+  char name[16];
+  for(unsigned int i=0; i<count; ++i) {
+    snprintf(name, sizeof(name), "host%05u", i);
+    names.push_back(name);
+  }
+  return names;
+}
+
+static void SetLabelCounters(benchmark::State& state, size_t bytes) {
+  state.counters["bytes_per_host"] = (double)bytes/state.range(0);
+  state.counters["hosts"] = benchmark::Counter((double)state.range(0),
+    benchmark::Counter::kIsIterationInvariantRate);
+}
+
+static void BM_LabelStripVertices(benchmark::State& state) {
+  std::vector<std::string> names = MakeDisplayNames(state.range(0));
+  const TextureAtlas& atlas = TextUtils::GetAtlas();
+  const float scale = 0.3f/24;
+  std::vector<GLfloat> vertices;
+  std::vector<GLuint> indices;
+  for(auto _ : state) {
+    vertices.clear();
+    indices.clear();
+    for(size_t n=0; n<names.size(); ++n) {
+      float x = -0.5f, y = 0.1f*n;
+      for(size_t i=0; i<names[n].length(); ++i) {
+        const TextureChar& ch = TextUtils::Glyph(atlas, (unsigned char)names[n][i]);
+        float left = x + ch.xOffset*scale, top = y - ch.yOffset*scale;
+        float right = left + ch.width*scale*atlas.textureWidth;
+        float bottom = top - ch.height*scale*atlas.textureHeight;
+        const GLfloat quad[16] = {
+          left, top, ch.x, ch.y,  left, bottom, ch.x, ch.y - ch.height,
+          right, top, ch.x + ch.width, ch.y,  right, bottom, ch.x + ch.width, ch.y - ch.height};
+        GLuint first = vertices.size()/4;
+        vertices.insert(vertices.end(), quad, quad + 16);
+        const GLuint strip[5] = {first, first + 1, first + 2, first + 3, 0xffffffff};
+        indices.insert(indices.end(), strip, strip + 5);
+        x += ch.xAdvance * scale;
+      }
+    }
+    benchmark::DoNotOptimize(vertices.data());
+    benchmark::DoNotOptimize(indices.data());
+  }
+  SetLabelCounters(state, vertices.size()*sizeof(GLfloat) + indices.size()*sizeof(GLuint));
+}
+
+static void BM_LabelGlyphRecords(benchmark::State& state) {
+  std::vector<std::string> names = MakeDisplayNames(state.range(0));
+  const TextureAtlas& atlas = TextUtils::GetAtlas();
+  const float scale = 0.3f/24;
+  std::vector<LabelGlyph> glyphs;
+  for(auto _ : state) {
+    glyphs.clear();
+    glyphs.resize(MAX_LABEL_CHARS*names.size());
+    for(size_t n=0; n<names.size(); ++n) {
+      LabelGlyph* out = &glyphs[MAX_LABEL_CHARS*n];
+      float x = -0.5f, y = 0.1f*n;
+      for(unsigned int i=0; i<MAX_LABEL_CHARS; ++i) {
+        GLuint code = (i < names[n].length()) ? (unsigned char)names[n][i] : 0;
+        out[i].pen[0] = x;
+        out[i].pen[1] = y;
+        out[i].glyph = code;
+        x += TextUtils::Glyph(atlas, code).xAdvance * scale;
+      }
+    }
+    benchmark::DoNotOptimize(glyphs.data());
+  }
+  SetLabelCounters(state, glyphs.size()*sizeof(LabelGlyph));
+}
+
+BENCHMARK(BM_GenerateInstances)->Arg(100)->Arg(10000)->Arg(50000);
+BENCHMARK(BM_LabelStripVertices)->Arg(1000)->Arg(50000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_LabelGlyphRecords)->Arg(1000)->Arg(50000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_LabelsMapLookup)->Arg(50000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LabelsTableLookup)->Arg(50000)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
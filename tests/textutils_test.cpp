@@ -0,0 +1,64 @@
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "testutils.h"
+#include "textutils.h"
+
+// The scalar glyph writer, which the NEON and SSE2 paths must match bit
+// for bit. Built into textutils_scalar_test, the library runs it too.
+static void ReferenceInstances(const TextRun* runs, unsigned int numRuns,
+  std::vector<GLfloat>& instances, float scale, const TextureAtlas& atlas) {
+
+  for(unsigned int i=0; i<numRuns; ++i) {
+    float x = runs[i].x, y = runs[i].y;
+    for(unsigned char c : *runs[i].text) {
+      const TextureChar& ch = TextUtils::Glyph(atlas, c);
+      float texWidth = ch.width * scale * atlas.textureWidth;
+      float texHeight = ch.height * scale * atlas.textureHeight;
+      float texHorizOffset = ch.xOffset * scale;
+      float texVertOffset = ch.yOffset * scale;
+      const GLfloat quad[8] = {
+        x + texHorizOffset, y - texVertOffset - texHeight, ch.x, ch.y - ch.height,
+        x + texHorizOffset + texWidth, y - texVertOffset, ch.x + ch.width, ch.y};
+      instances.insert(instances.end(), quad, quad + 8);
+      x += ch.xAdvance * scale;
+    }
+  }
+}
+
+TEST_CASE(MatchesScalarReference) {
+
+  // Every byte, including the unmapped ones, at awkward pens and scales
+  std::string allBytes;
+  for(unsigned int c=0; c<NUM_DIRECT_GLYPHS; ++c) {
+    allBytes.push_back((char)c);
+  }
+  const std::string label = "host00042.lan", empty;
+  const TextRun runs[] = {
+    {&allBytes, -1.2345678f, 0.3f},
+    {&empty, 7.0f, 7.0f},
+    {&label, 1e-7f, -123.456f},
+    {&allBytes, 3.0e4f, -2.5e-3f}};
+  const float scales[] = {0.2f/24, 0.3f/24, 1.0f, 3.0e-5f, 17.75f};
+  const TextureAtlas& atlas = TextUtils::GetAtlas();
+  for(float scale : scales) {
+    std::vector<GLfloat> instances, reference;
+    TextUtils::GenerateInstances(runs, 4, instances, scale, atlas);
+    ReferenceInstances(runs, 4, reference, scale, atlas);
+    REQUIRE(instances.size() == reference.size());
+    CHECK(memcmp(instances.data(), reference.data(), instances.size()*sizeof(GLfloat)) == 0);
+  }
+}
+
+TEST_CASE(AppendsAfterExistingInstances) {
+  const std::string text = "10.0.0.1";
+  const TextRun run = {&text, 0.5f, -0.5f};
+  std::vector<GLfloat> instances(5, 42.0f), reference(5, 42.0f);
+  TextUtils::GenerateInstances(&run, 1, instances, 0.01f, TextUtils::GetAtlas());
+  ReferenceInstances(&run, 1, reference, 0.01f, TextUtils::GetAtlas());
+  CHECK(instances.size() == 5 + 8*text.length());
+  CHECK(instances == reference);
+}
+
+TEST_MAIN()
@@ -0,0 +1,95 @@
+// Packs the app's shaders and textures into a single bundle so startup
+// maps one asset instead of opening each file. Files are stored under
+// their base names, sorted, with their data aligned for direct upload.
+//
+// Usage: assetpack <output> <input>...
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "assetbundle.h"
+
+typedef struct {
+  std::string name;
+  std::vector<char> data;
+} PackedFile;
+
+static bool ReadFile(const char* path, std::vector<char>& data) {
+  FILE* file = fopen(path, "rb");
+  if(!file) {
+    return false;
+  }
+  fseek(file, 0, SEEK_END);
+  long length = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  data.resize(length > 0 ? length : 0);
+  bool ok = length >= 0 && fread(data.data(), 1, data.size(), file) == data.size();
+  fclose(file);
+  return ok;
+}
+
+int main(int argc, char** argv) {
+
+  if(argc < 3) {
+    fprintf(stderr, "Usage: %s <output> <input>...\n", argv[0]);
+    return 1;
+  }
+
+  // Read each input under its base name
+  std::vector<PackedFile> files(argc - 2);
+  for(int i=2; i<argc; ++i) {
+    PackedFile& file = files[i-2];
+    const char* slash = strrchr(argv[i], '/');
+    file.name = slash ? slash + 1 : argv[i];
+    if(file.name.empty() || file.name.length() >= BUNDLE_NAME_LENGTH) {
+      fprintf(stderr, "Invalid name for %s\n", argv[i]);
+      return 1;
+    }
+    if(!ReadFile(argv[i], file.data)) {
+      fprintf(stderr, "Can't read %s\n", argv[i]);
+      return 1;
+    }
+  }
+
+  // Sort by name so the output doesn't depend on argument order
+  std::sort(files.begin(), files.end(),
+    [](const PackedFile& a, const PackedFile& b) { return a.name < b.name; });
+  for(size_t i=1; i<files.size(); ++i) {
+    if(files[i].name == files[i-1].name) {
+      fprintf(stderr, "Duplicate name %s\n", files[i].name.c_str());
+      return 1;
+    }
+  }
+
+  // Lay out the header, the table and the aligned data
+  BundleHeader header = {BUNDLE_MAGIC, BUNDLE_VERSION, (uint32_t)files.size(), 0};
+  std::vector<BundleEntry> table(files.size());
+  size_t offset = sizeof(BundleHeader) + table.size()*sizeof(BundleEntry);
+  for(size_t i=0; i<files.size(); ++i) {
+    offset = (offset + BUNDLE_ALIGNMENT - 1) & ~(size_t)(BUNDLE_ALIGNMENT - 1);
+    memset(&table[i], 0, sizeof(BundleEntry));
+    strncpy(table[i].name, files[i].name.c_str(), BUNDLE_NAME_LENGTH - 1);
+    table[i].offset = (uint32_t)offset;
+    table[i].size = (uint32_t)files[i].data.size();
+    offset += files[i].data.size();
+  }
+  std::vector<char> bundle(offset, 0);
+  memcpy(bundle.data(), &header, sizeof(header));
+  memcpy(bundle.data() + sizeof(header), table.data(), table.size()*sizeof(BundleEntry));
+  for(size_t i=0; i<files.size(); ++i) {
+    std::copy(files[i].data.begin(), files[i].data.end(), bundle.begin() + table[i].offset);
+  }
+
+  // Write the bundle
+  FILE* out = fopen(argv[1], "wb");
+  if(!out || fwrite(bundle.data(), 1, bundle.size(), out) != bundle.size()) {
+    fprintf(stderr, "Can't write %s\n", argv[1]);
+    return 1;
+  }
+  fclose(out);
+  printf("Packed %u files into %u bytes\n", header.numEntries, (unsigned int)bundle.size());
+  return 0;
+}
@@ -0,0 +1,153 @@
+// Converts the raw 8-bit coverage atlas used by the app into a signed
+// distance field with the same size and layout. Texels on a shape's edge
+// map to 128, and the value changes by 128/spread per output texel, so
+// the fragment shaders can threshold at 0.5 for any magnification.
+//
+// Usage: sdfgen <input.bmp> <output.bmp> [size] [spread] [upscale]
+//
+// Both atlases live in app/src/main/assetsrc and reach the app through
+// the asset bundle, so rebuild the bundle after regenerating, from the
+// repository root:
+//   cmake -S tools/sdfgen -B build-sdfgen && cmake --build build-sdfgen
+//   build-sdfgen/sdfgen app/src/main/assetsrc/wifi_discovery.bmp app/src/main/assetsrc/wifi_discovery_sdf.bmp
+//   cmake -S tools/assetpack -B build-assetpack && cmake --build build-assetpack
+//   build-assetpack/assetpack app/src/main/assets/wifi_discovery.pack app/src/main/assetsrc/*
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+static const int DEFAULT_SIZE = 256;
+static const float DEFAULT_SPREAD = 4.0f;
+static const int DEFAULT_UPSCALE = 8;
+static const float INF = std::numeric_limits<float>::max();
+
+// One-dimensional squared distance transform (Felzenszwalb & Huttenlocher)
+static void Transform1D(const float* f, float* d, int n, int* v, float* z) {
+  int k = 0;
+  v[0] = 0;
+  z[0] = -INF;
+  z[1] = INF;
+  for(int q=1; q<n; ++q) {
+    float s;
+    while(true) {
+      s = ((f[q] + q*q) - (f[v[k]] + v[k]*v[k])) / (2.0f*(q - v[k]));
+      if(s > z[k] || k == 0) {
+        break;
+      }
+      --k;
+    }
+    if(s <= z[k]) {
+      s = z[k];
+    }
+    ++k;
+    v[k] = q;
+    z[k] = s;
+    z[k+1] = INF;
+  }
+  k = 0;
+  for(int q=0; q<n; ++q) {
+    while(z[k+1] < q) {
+      ++k;
+    }
+    d[q] = (q - v[k])*(q - v[k]) + f[v[k]];
+  }
+}
+
+// Squared distance from every cell to the nearest cell where seed is set
+static void Transform2D(const std::vector<unsigned char>& seed, int n, std::vector<float>& out) {
+  std::vector<float> f(n), d(n), z(n + 1);
+  std::vector<int> v(n);
+  out.resize(n*n);
+  for(int i=0; i<n*n; ++i) {
+    out[i] = seed[i] ? 0.0f : INF;
+  }
+
+  // Columns, then rows
+  for(int x=0; x<n; ++x) {
+    for(int y=0; y<n; ++y) {
+      f[y] = out[y*n + x];
+    }
+    Transform1D(f.data(), d.data(), n, v.data(), z.data());
+    for(int y=0; y<n; ++y) {
+      out[y*n + x] = d[y];
+    }
+  }
+  for(int y=0; y<n; ++y) {
+    Transform1D(&out[y*n], d.data(), n, v.data(), z.data());
+    std::copy(d.begin(), d.end(), out.begin() + y*n);
+  }
+}
+
+int main(int argc, char** argv) {
+
+  if(argc < 3) {
+    fprintf(stderr, "Usage: %s <input> <output> [size] [spread] [upscale]\n", argv[0]);
+    return 1;
+  }
+  int size = (argc > 3) ? atoi(argv[3]) : DEFAULT_SIZE;
+  float spread = (argc > 4) ? (float)atof(argv[4]) : DEFAULT_SPREAD;
+  int upscale = (argc > 5) ? atoi(argv[5]) : DEFAULT_UPSCALE;
+  if(size <= 0 || spread <= 0.0f || upscale <= 0) {
+    fprintf(stderr, "Invalid size, spread or upscale\n");
+    return 1;
+  }
+
+  // Read the coverage atlas
+  std::vector<unsigned char> coverage(size*size);
+  FILE* in = fopen(argv[1], "rb");
+  if(!in || fread(coverage.data(), 1, coverage.size(), in) != coverage.size()) {
+    fprintf(stderr, "Can't read %dx%d texels from %s\n", size, size, argv[1]);
+    return 1;
+  }
+  fclose(in);
+
+  // Threshold a bilinear upsampling of the coverage so edges land between
+  // source texels instead of on them
+  int n = size*upscale;
+  std::vector<unsigned char> inside(n*n), outside(n*n);
+  for(int y=0; y<n; ++y) {
+    float sy = std::min(std::max((y + 0.5f)/upscale - 0.5f, 0.0f), size - 1.0f);
+    int y0 = (int)sy, y1 = std::min(y0 + 1, size - 1);
+    float fy = sy - y0;
+    for(int x=0; x<n; ++x) {
+      float sx = std::min(std::max((x + 0.5f)/upscale - 0.5f, 0.0f), size - 1.0f);
+      int x0 = (int)sx, x1 = std::min(x0 + 1, size - 1);
+      float fx = sx - x0;
+      float top = coverage[y0*size + x0]*(1.0f - fx) + coverage[y0*size + x1]*fx;
+      float bottom = coverage[y1*size + x0]*(1.0f - fx) + coverage[y1*size + x1]*fx;
+      bool in = (top*(1.0f - fy) + bottom*fy) >= 127.5f;
+      inside[y*n + x] = in;
+      outside[y*n + x] = !in;
+    }
+  }
+
+  // Distances to the nearest inside and outside cells
+  std::vector<float> toInside, toOutside;
+  Transform2D(inside, n, toInside);
+  Transform2D(outside, n, toOutside);
+
+  // Resample at output texel centers, measured in output texels
+  std::vector<unsigned char> field(size*size);
+  for(int y=0; y<size; ++y) {
+    for(int x=0; x<size; ++x) {
+      int i = (y*upscale + upscale/2)*n + x*upscale + upscale/2;
+      float dist = inside[i] ? std::sqrt(toOutside[i]) - 0.5f
+                             : 0.5f - std::sqrt(toInside[i]);
+      float value = 0.5f + 0.5f*(dist/upscale)/spread;
+      field[y*size + x] = (unsigned char)(std::min(std::max(value, 0.0f), 1.0f)*255.0f + 0.5f);
+    }
+  }
+
+  // Write the field in the same raw layout
+  FILE* out = fopen(argv[2], "wb");
+  if(!out || fwrite(field.data(), 1, field.size(), out) != field.size()) {
+    fprintf(stderr, "Can't write %s\n", argv[2]);
+    return 1;
+  }
+  fclose(out);
+  return 0;
+}